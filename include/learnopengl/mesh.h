@@ -7,7 +7,11 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 #include <learnopengl/shader.h>
+#include <rg/MeshSimplifier.h>
+#include <rg/CpuProfiler.h>
+#include <rg/DebugView.h>
 
+#include <algorithm>
 #include <string>
 #include <vector>
 using namespace std;
@@ -33,28 +37,53 @@ struct Texture {
     string path;
 };
 
+// one level of detail, a range of the element buffer
+struct MeshLod {
+    unsigned int firstIndex;
+    unsigned int indexCount;
+    // largest distance from the full detail surface, in model units
+    float error;
+};
+
 class Mesh {
 public:
     // mesh Data
     vector<Vertex>       vertices;
     vector<unsigned int> indices;
     vector<Texture>      textures;
+    // lods[0] is the full mesh, the simplified levels follow it in the element buffer
+    vector<MeshLod>      lods;
+    vector<unsigned int> lodIndices;
+    // index of the node of the model the mesh hangs from
+    int node = 0;
+    // colours the mesh in the mesh index debug view, copies keep it
+    int index = rg::DebugView::NextMeshIndex();
 
     unsigned int VAO;
     std::string glslIdentifierPrefix;
-    // constructor
-    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures)
+    // constructor, lodLevels simplified levels are generated after the full mesh
+    Mesh(vector<Vertex> vertices, vector<unsigned int> indices, vector<Texture> textures, int lodLevels = 0)
     {
         this->vertices = vertices;
         this->indices = indices;
         this->textures = textures;
 
+        generateLods(lodLevels);
         // now that we have all the required data, set the vertex buffers and its attribute pointers.
         setupMesh();
     }
 
-    // render the mesh
-    void Draw(Shader &shader)
+    // the indices of a level of detail
+    vector<unsigned int> LodIndices(int lod) const
+    {
+        if (lod == 0)
+            return indices;
+        auto first = lodIndices.begin() + (lods[lod].firstIndex - indices.size());
+        return vector<unsigned int>(first, first + lods[lod].indexCount);
+    }
+
+    // render the mesh, instanceCount times with gl_InstanceID counting them
+    void Draw(Shader &shader, int lod = 0, int instanceCount = 1)
     {
         // bind appropriate textures
         unsigned int diffuseNr  = 1;
@@ -84,9 +113,16 @@ public:
 
 
 
+        if (rg::DebugView::Current == rg::DebugView::MESH_INDEX)
+            glUniform1i(glGetUniformLocation(shader.ID, "debugMeshIndex"), index);
+
         // draw mesh
         glBindVertexArray(VAO);
-        glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_INT, 0);
+        const MeshLod& level = lods[std::min(lod, (int) lods.size() - 1)];
+        if (instanceCount == 1)
+            glDrawElements(GL_TRIANGLES, level.indexCount, GL_UNSIGNED_INT, (void*) (level.firstIndex * sizeof(unsigned int)));
+        else
+            glDrawElementsInstanced(GL_TRIANGLES, level.indexCount, GL_UNSIGNED_INT, (void*) (level.firstIndex * sizeof(unsigned int)), instanceCount);
         glBindVertexArray(0);
 
         // always good practice to set everything back to defaults once configured.
@@ -97,6 +133,24 @@ private:
     // render data
     unsigned int VBO, EBO;
 
+    // every level halves the triangles of the one before, until simplification stalls
+    void generateLods(int lodLevels)
+    {
+        RG_ZONE("Mesh LODs");
+        lods.push_back(MeshLod{0, (unsigned int) indices.size(), 0.0f});
+        vector<unsigned int> level = indices;
+        float error = 0.0f;
+        for (int i = 0; i < lodLevels; i++)
+        {
+            vector<unsigned int> simplified = rg::simplifyMesh(vertices, level, level.size() / 2 / 3 * 3, error);
+            if (simplified.size() > level.size() * 9 / 10)
+                break;
+            lods.push_back(MeshLod{(unsigned int) (indices.size() + lodIndices.size()), (unsigned int) simplified.size(), error});
+            lodIndices.insert(lodIndices.end(), simplified.begin(), simplified.end());
+            level = simplified;
+        }
+    }
+
     // initializes all the buffer objects/arrays
     void setupMesh()
     {
@@ -114,7 +168,10 @@ private:
         glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), &vertices[0], GL_STATIC_DRAW);
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (indices.size() + lodIndices.size()) * sizeof(unsigned int), NULL, GL_STATIC_DRAW);
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, indices.size() * sizeof(unsigned int), &indices[0]);
+        if (!lodIndices.empty())
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), lodIndices.size() * sizeof(unsigned int), &lodIndices[0]);
 
         // set the vertex attribute pointers
         // vertex Positions
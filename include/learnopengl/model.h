@@ -12,6 +12,10 @@
 
 #include <learnopengl/mesh.h>
 #include <learnopengl/shader.h>
+#include <rg/NodeAnimation.h>
+#include <rg/CpuProfiler.h>
+#include <rg/DrawCounter.h>
+#include <rg/MemoryTracker.h>
 
 #include <string>
 #include <fstream>
@@ -31,20 +35,70 @@ public:
     // model data
     vector<Texture> textures_loaded;	// stores all the textures loaded so far, optimization to make sure textures aren't loaded more than once.
     vector<Mesh>    meshes;
+    // the node hierarchy, parents first, every mesh knows its node. The vertices stay in the
+    // space of their node, Draw() ignores the node transforms.
+    vector<rg::AnimationNode> nodes;
+    vector<rg::AnimationClip> animations;
     string directory;
+    // file name and the directory it is in, what the draw counters and the memory tracker
+    // list the model as
+    string name;
     bool gammaCorrection;
 
-    // constructor, expects a filepath to a 3D model.
-    Model(string const &path, bool gamma = false) : gammaCorrection(gamma)
+    // constructor, expects a filepath to a 3D model. Every mesh gets up to lodLevels simplified levels of detail.
+    Model(string const &path, bool gamma = false, int lodLevels = 0) : gammaCorrection(gamma), lodLevels(lodLevels)
     {
+        RG_ZONE_DYNAMIC("Model " + path);
+        size_t file = path.find_last_of('/');
+        size_t folder = file == string::npos || file == 0 ? string::npos : path.find_last_of('/', file - 1);
+        name = folder == string::npos ? path : path.substr(folder + 1);
+        rg::MemoryTracker::Scope memoryScope(name);
         loadModel(path);
+        rg::MemoryTracker::SetCpuBytes(name, CpuBytes());
+        if (lodLevels > 0 && !meshes.empty() && LodCount() == 1)
+            cout << "WARNING::MODEL:: No mesh of " << name << " could be simplified, it has no levels of detail" << endl;
     }
 
-    // draws the model, and thus all its meshes
-    void Draw(Shader &shader)
+    // draws the model, and thus all its meshes, meshes with fewer levels draw their coarsest
+    void Draw(Shader &shader, int lod = 0, int instanceCount = 1)
     {
+        rg::DrawCounter::ModelScope counterScope(name);
         for(unsigned int i = 0; i < meshes.size(); i++)
-            meshes[i].Draw(shader);
+            meshes[i].Draw(shader, lod, instanceCount);
+    }
+
+    // the vertices and indices kept on the CPU after the upload
+    size_t CpuBytes() const
+    {
+        size_t bytes = 0;
+        for (const Mesh& mesh : meshes)
+            bytes += mesh.vertices.capacity() * sizeof(Vertex) + (mesh.indices.capacity() + mesh.lodIndices.capacity()) * sizeof(unsigned int);
+        return bytes;
+    }
+
+    int LodCount() const
+    {
+        size_t count = 1;
+        for (const Mesh& mesh : meshes)
+            count = std::max(count, mesh.lods.size());
+        return (int) count;
+    }
+
+    // largest error of any mesh at a level of detail, in model units
+    float LodError(int lod) const
+    {
+        float error = 0.0f;
+        for (const Mesh& mesh : meshes)
+            error = std::max(error, mesh.lods[std::min(lod, (int) mesh.lods.size() - 1)].error);
+        return error;
+    }
+
+    unsigned int LodTriangleCount(int lod) const
+    {
+        unsigned int triangles = 0;
+        for (const Mesh& mesh : meshes)
+            triangles += mesh.lods[std::min(lod, (int) mesh.lods.size() - 1)].indexCount / 3;
+        return triangles;
     }
 
     void SetShaderTextureNamePrefix(std::string prefix) {
@@ -53,6 +107,8 @@ public:
         }
     }
 private:
+    int lodLevels;
+
     // loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
     void loadModel(string const &path)
     {
@@ -69,12 +125,15 @@ private:
         directory = path.substr(0, path.find_last_of('/'));
 
         // process ASSIMP's root node recursively
-        processNode(scene->mRootNode, scene);
+        processNode(scene->mRootNode, scene, -1);
+        loadAnimations(scene);
     }
 
     // processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
-    void processNode(aiNode *node, const aiScene *scene)
+    void processNode(aiNode *node, const aiScene *scene, int parent)
     {
+        int index = (int) nodes.size();
+        nodes.push_back(rg::AnimationNode{node->mName.C_Str(), parent, toGlm(node->mTransformation)});
         // process each mesh located at the current node
         for(unsigned int i = 0; i < node->mNumMeshes; i++)
         {
@@ -82,15 +141,84 @@ private:
             // the scene contains all the data, node is just to keep stuff organized (like relations between nodes).
             aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
             meshes.push_back(processMesh(mesh, scene));
+            meshes.back().node = index;
         }
         // after we've processed all of the meshes (if any) we then recursively process each of the children nodes
         for(unsigned int i = 0; i < node->mNumChildren; i++)
         {
-            processNode(node->mChildren[i], scene);
+            processNode(node->mChildren[i], scene, index);
         }
 
     }
 
+    static glm::mat4 toGlm(const aiMatrix4x4 &m)
+    {
+        // assimp matrices are row major
+        return glm::mat4(glm::vec4(m.a1, m.b1, m.c1, m.d1),
+                         glm::vec4(m.a2, m.b2, m.c2, m.d2),
+                         glm::vec4(m.a3, m.b3, m.c3, m.d3),
+                         glm::vec4(m.a4, m.b4, m.c4, m.d4));
+    }
+
+    // copies every animation into structure of arrays clips, key times in seconds
+    void loadAnimations(const aiScene *scene)
+    {
+        for(unsigned int i = 0; i < scene->mNumAnimations; i++)
+        {
+            const aiAnimation* animation = scene->mAnimations[i];
+            float ticksPerSecond = animation->mTicksPerSecond != 0.0 ? (float) animation->mTicksPerSecond : 25.0f;
+            rg::AnimationClip clip;
+            clip.Name = animation->mName.C_Str();
+            clip.Duration = (float) animation->mDuration / ticksPerSecond;
+            for(unsigned int c = 0; c < animation->mNumChannels; c++)
+            {
+                const aiNodeAnim* channel = animation->mChannels[c];
+                int node = -1;
+                for(unsigned int n = 0; n < nodes.size() && node < 0; n++)
+                    if(nodes[n].Name == channel->mNodeName.C_Str())
+                        node = (int) n;
+                if(node < 0)
+                    continue;
+
+                rg::AnimationClip::Channel keys;
+                keys.Node = node;
+                keys.FirstPosition = (unsigned int) clip.PositionTimes.size();
+                keys.PositionCount = channel->mNumPositionKeys;
+                for(unsigned int k = 0; k < channel->mNumPositionKeys; k++)
+                {
+                    const aiVectorKey& key = channel->mPositionKeys[k];
+                    clip.PositionTimes.push_back((float) key.mTime / ticksPerSecond);
+                    clip.PositionX.push_back(key.mValue.x);
+                    clip.PositionY.push_back(key.mValue.y);
+                    clip.PositionZ.push_back(key.mValue.z);
+                }
+                keys.FirstRotation = (unsigned int) clip.RotationTimes.size();
+                keys.RotationCount = channel->mNumRotationKeys;
+                for(unsigned int k = 0; k < channel->mNumRotationKeys; k++)
+                {
+                    const aiQuatKey& key = channel->mRotationKeys[k];
+                    clip.RotationTimes.push_back((float) key.mTime / ticksPerSecond);
+                    clip.RotationX.push_back(key.mValue.x);
+                    clip.RotationY.push_back(key.mValue.y);
+                    clip.RotationZ.push_back(key.mValue.z);
+                    clip.RotationW.push_back(key.mValue.w);
+                }
+                keys.FirstScale = (unsigned int) clip.ScaleTimes.size();
+                keys.ScaleCount = channel->mNumScalingKeys;
+                for(unsigned int k = 0; k < channel->mNumScalingKeys; k++)
+                {
+                    const aiVectorKey& key = channel->mScalingKeys[k];
+                    clip.ScaleTimes.push_back((float) key.mTime / ticksPerSecond);
+                    clip.ScaleX.push_back(key.mValue.x);
+                    clip.ScaleY.push_back(key.mValue.y);
+                    clip.ScaleZ.push_back(key.mValue.z);
+                }
+                clip.Channels.push_back(keys);
+            }
+            animations.push_back(clip);
+        }
+    }
+
     Mesh processMesh(aiMesh *mesh, const aiScene *scene)
     {
         // data to fill
@@ -179,7 +307,7 @@ private:
 
 
         // return a mesh object created from the extracted mesh data
-        return Mesh(vertices, indices, textures);
+        return Mesh(vertices, indices, textures, lodLevels);
     }
 
     // checks all material textures of a given type and loads the textures if they're not loaded yet.
@@ -221,6 +349,7 @@ unsigned int TextureFromFile(const char *path, const string &directory, bool gam
 {
     string filename = string(path);
     filename = directory + '/' + filename;
+    RG_ZONE_DYNAMIC("Texture " + filename);
 
     unsigned int textureID;
     glGenTextures(1, &textureID);
@@ -9,14 +9,20 @@
 #include <sstream>
 #include <iostream>
 #include <common.h>
+#include <rg/GLExt.h>
+#include <rg/CpuProfiler.h>
+#include <rg/DebugView.h>
 class Shader
 {
 public:
     unsigned int ID;
+    // estimated instructions per fragment, for the shader cost debug view (rg::DebugView)
+    float FragmentCost = 0.0f;
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath, const char* geometryPath = nullptr)
     {
+        RG_ZONE_DYNAMIC(std::string("Shader ") + vertexPath + " " + fragmentPath);
         std::string vertexPathString(vertexPath);
         std::string fragmentPathString(fragmentPath);
 
@@ -48,6 +54,9 @@ public:
             // convert stream into string
             vertexCode = vShaderStream.str();
             fragmentCode = fShaderStream.str();			
+            FragmentCost = rg::DebugView::EstimateCost(fragmentCode);
+            vertexCode = expandIncludes(vertexCode, vertexPathString);
+            fragmentCode = expandIncludes(fragmentCode, fragmentPathString);
             // if geometry shader path is present, also load a geometry shader
             if(geometryPath != nullptr)
             {
@@ -57,7 +66,7 @@ public:
                 std::stringstream gShaderStream;
                 gShaderStream << gShaderFile.rdbuf();
                 gShaderFile.close();
-                geometryCode = gShaderStream.str();
+                geometryCode = expandIncludes(gShaderStream.str(), geometryPathString);
             }
         }
         catch (std::ifstream::failure& e)
@@ -101,13 +110,52 @@ public:
         glDeleteShader(fragment);
         if(geometryPath != nullptr)
             glDeleteShader(geometry);
-
+        debugViewLocation = glGetUniformLocation(ID, "debugView");
+        debugShaderCostLocation = glGetUniformLocation(ID, "debugShaderCost");
+    }
+    // constructor for a compute program, only valid on a 4.3 context (rg::GLExt::Compute)
+    // ------------------------------------------------------------------------
+    explicit Shader(const char* computePath)
+    {
+        RG_ZONE_DYNAMIC(std::string("Shader ") + computePath);
+        std::string computeCode;
+        std::ifstream cShaderFile;
+        cShaderFile.exceptions (std::ifstream::failbit | std::ifstream::badbit);
+        try
+        {
+            cShaderFile.open(computePath);
+            std::stringstream cShaderStream;
+            cShaderStream << cShaderFile.rdbuf();
+            cShaderFile.close();
+            computeCode = expandIncludes(cShaderStream.str(), computePath);
+        }
+        catch (std::ifstream::failure& e)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        }
+        const char* cShaderCode = computeCode.c_str();
+        unsigned int compute = glCreateShader(GL_COMPUTE_SHADER);
+        glShaderSource(compute, 1, &cShaderCode, NULL);
+        glCompileShader(compute);
+        checkCompileErrors(compute, "COMPUTE");
+        ID = glCreateProgram();
+        glAttachShader(ID, compute);
+        glLinkProgram(ID);
+        checkCompileErrors(ID, "PROGRAM");
+        glDeleteShader(compute);
     }
     // activate the shader
     // ------------------------------------------------------------------------
     void use() 
     { 
         glUseProgram(ID); 
+        // programs keep their uniforms, only a changed view has to be set
+        if (debugViewLocation != -1 && debugViewMode != rg::DebugView::Current)
+        {
+            debugViewMode = rg::DebugView::Current;
+            glUniform1i(debugViewLocation, debugViewMode);
+            glUniform1f(debugShaderCostLocation, FragmentCost);
+        }
     }
     // utility uniform functions
     // ------------------------------------------------------------------------
@@ -169,6 +217,41 @@ public:
     }
 
 private:
+    // -1 unless the program uses debug_view.glsl
+    int debugViewLocation = -1;
+    int debugShaderCostLocation = -1;
+    int debugViewMode = -1;
+
+    // replaces every #include "file" line with the file, the path relative to the including file
+    // ------------------------------------------------------------------------
+    static std::string expandIncludes(const std::string& code, const std::string& path, int depth = 0)
+    {
+        std::string directory = path.substr(0, path.find_last_of("/\\") + 1);
+        std::stringstream in(code), out;
+        std::string line;
+        while (std::getline(in, line))
+        {
+            size_t directive = line.find_first_not_of(" \t");
+            if (directive == std::string::npos || line.compare(directive, 8, "#include") != 0)
+            {
+                out << line << '\n';
+                continue;
+            }
+            size_t begin = line.find('"', directive);
+            size_t end = begin == std::string::npos ? std::string::npos : line.find('"', begin + 1);
+            std::string includePath = end == std::string::npos ? line : directory + line.substr(begin + 1, end - begin - 1);
+            std::ifstream includeFile(includePath);
+            if (end == std::string::npos || !includeFile || depth >= 16)
+            {
+                std::cout << "ERROR::SHADER::INCLUDE_NOT_SUCCESFULLY_READ " << includePath << std::endl;
+                continue;
+            }
+            std::stringstream includeStream;
+            includeStream << includeFile.rdbuf();
+            out << expandIncludes(includeStream.str(), includePath, depth + 1);
+        }
+        return out.str();
+    }
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
     void checkCompileErrors(GLuint shader, std::string type)
@@ -0,0 +1,140 @@
+#ifndef PROJECT_BASE_AUTOEXPOSURE_H
+#define PROJECT_BASE_AUTOEXPOSURE_H
+
+#include <glad/glad.h>
+
+#include <cmath>
+#include <memory>
+
+#include <learnopengl/shader.h>
+#include <rg/FrameGraph.h>
+#include <rg/GLExt.h>
+#include <rg/GpuTimer.h>
+
+namespace rg {
+
+// Eye adaptation on the GPU (4.3 contexts). histogram.cs bins the log luminance of the HDR
+// scene, exposure.cs reduces the bins to an average, eases the stored luminance towards it and
+// writes the exposure into the same buffer. post.cs reads it from there, so the value never
+// makes a round trip through the CPU and no pass waits on another frame's result.
+class AutoExposure {
+public:
+    static const int BIN_COUNT = 256;
+    static const int TILE = 16;
+
+    bool Enabled = true;
+    // the average luminance is mapped to this middle grey
+    float KeyValue = 0.18f;
+    // log2 luminance range the histogram covers, the point light peaks around 2^9
+    float MinLogLuminance = -8.0f;
+    float MaxLogLuminance = 10.0f;
+    // how fast the exposure follows the scene, per second
+    float AdaptationSpeed = 1.5f;
+    float MinExposure = 0.01f;
+    float MaxExposure = 10.0f;
+
+    AutoExposure() {
+        if (!GLExt::Compute)
+            return;
+        m_HistogramShader.reset(new Shader("resources/shaders/histogram.cs"));
+        m_ExposureShader.reset(new Shader("resources/shaders/exposure.cs"));
+
+        // histogram bins, then the adapted luminance and exposure, starting from the old fixed 0.1
+        struct {
+            unsigned int Histogram[BIN_COUNT];
+            float AverageLuminance;
+            float AdaptedExposure;
+        } initial = {};
+        initial.AdaptedExposure = 0.1f;
+        initial.AverageLuminance = KeyValue / initial.AdaptedExposure;
+        glGenBuffers(1, &m_Buffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(initial), &initial, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    ~AutoExposure() {
+        if (m_Buffer)
+            glDeleteBuffers(1, &m_Buffer);
+    }
+
+    AutoExposure(const AutoExposure&) = delete;
+    AutoExposure& operator=(const AutoExposure&) = delete;
+
+    bool IsAvailable() const {
+        return m_Buffer != 0;
+    }
+
+    // Adds the histogram and adaptation passes over the rendered region of color and returns
+    // the exposure buffer for rg::PostProcessing.
+    FrameGraphResource AddPasses(FrameGraph& graph, FrameGraphResource color,
+                                 unsigned int renderWidth, unsigned int renderHeight, float deltaTime) {
+        m_RenderWidth = renderWidth;
+        m_RenderHeight = renderHeight;
+        m_DeltaTime = deltaTime;
+
+        FrameGraphResource exposure = graph.ImportBuffer("exposure", m_Buffer);
+        graph.AddPass("histogram",
+            [&](FrameGraph::Builder& builder) {
+                builder.Read(color);
+                builder.WriteImage(exposure);
+            },
+            [this, color](const FrameGraph& g) {
+                m_Timer.Begin();
+                buildHistogram(g.GetTexture(color));
+            });
+        graph.AddPass("exposure",
+            [&](FrameGraph::Builder& builder) {
+                builder.WriteImage(exposure);
+            },
+            [this](const FrameGraph&) {
+                adapt();
+                m_Timer.End();
+            });
+        return exposure;
+    }
+
+    // both passes together
+    float LastMs() const {
+        return m_Timer.LastMs();
+    }
+
+private:
+    std::unique_ptr<Shader> m_HistogramShader;
+    std::unique_ptr<Shader> m_ExposureShader;
+    unsigned int m_Buffer = 0;
+    unsigned int m_RenderWidth = 0;
+    unsigned int m_RenderHeight = 0;
+    float m_DeltaTime = 0.0f;
+    GpuTimer m_Timer;
+
+    void buildHistogram(unsigned int source) {
+        m_HistogramShader->use();
+        glUniform2i(glGetUniformLocation(m_HistogramShader->ID, "renderSize"), m_RenderWidth, m_RenderHeight);
+        m_HistogramShader->setFloat("minLogLuminance", MinLogLuminance);
+        m_HistogramShader->setFloat("inverseLogLuminanceRange", 1.0f / (MaxLogLuminance - MinLogLuminance));
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_Buffer);
+        glDispatchCompute((m_RenderWidth + TILE - 1) / TILE, (m_RenderHeight + TILE - 1) / TILE, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+
+    void adapt() {
+        m_ExposureShader->use();
+        glUniform1ui(glGetUniformLocation(m_ExposureShader->ID, "pixelCount"), m_RenderWidth * m_RenderHeight);
+        m_ExposureShader->setFloat("minLogLuminance", MinLogLuminance);
+        m_ExposureShader->setFloat("logLuminanceRange", MaxLogLuminance - MinLogLuminance);
+        m_ExposureShader->setFloat("adaptation", 1.0f - std::exp(-m_DeltaTime * AdaptationSpeed));
+        m_ExposureShader->setFloat("keyValue", KeyValue);
+        m_ExposureShader->setFloat("minExposure", MinExposure);
+        m_ExposureShader->setFloat("maxExposure", MaxExposure);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_Buffer);
+        glDispatchCompute(1, 1, 1);
+        // the tonemap reads the exposure, the next frame's histogram writes the cleared bins
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+};
+
+}
+#endif //PROJECT_BASE_AUTOEXPOSURE_H
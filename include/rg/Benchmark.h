@@ -0,0 +1,401 @@
+#ifndef PROJECT_BASE_BENCHMARK_H
+#define PROJECT_BASE_BENCHMARK_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include <learnopengl/camera.h>
+#include <rg/CameraTrack.h>
+#include <rg/DrawCounter.h>
+#include <rg/MemoryTracker.h>
+
+namespace rg {
+
+// Closed Catmull-Rom loop through the scene: around the car, into the villa and past the
+// clocks. Positions and look-at targets are splined separately, Sample() turns them into the
+// camera's yaw and pitch in degrees. t runs from 0 to 1 over the whole loop.
+class BenchmarkCameraPath {
+public:
+    struct Key {
+        glm::vec3 Position;
+        glm::vec3 Target;
+    };
+
+    BenchmarkCameraPath() {
+        m_Keys = {
+            {glm::vec3(60.0f, 25.0f, 90.0f), glm::vec3(0.0f, 0.0f, 45.0f)},
+            {glm::vec3(15.0f, 5.0f, 62.0f), glm::vec3(0.0f, 1.0f, 45.0f)},
+            {glm::vec3(-20.0f, 8.0f, 40.0f), glm::vec3(0.0f, 2.0f, 20.0f)},
+            {glm::vec3(19.0f, 6.0f, 47.0f), glm::vec3(0.0f, 4.0f, 0.0f)},
+            {glm::vec3(2.0f, 5.0f, 8.0f), glm::vec3(0.0f, 5.0f, -20.0f)},
+            {glm::vec3(-15.0f, 12.0f, -10.0f), glm::vec3(0.0f, 10.0f, -34.0f)},
+            {glm::vec3(10.0f, 14.0f, -60.0f), glm::vec3(0.0f, 10.0f, -34.0f)},
+            {glm::vec3(70.0f, 35.0f, -20.0f), glm::vec3(0.0f, 0.0f, 0.0f)},
+        };
+    }
+
+    void Sample(float t, glm::vec3& position, float& yaw, float& pitch) const {
+        int count = (int) m_Keys.size();
+        float segment = (t - std::floor(t)) * count;
+        int i = std::min((int) segment, count - 1);
+        float u = segment - i;
+        const Key& k0 = m_Keys[(i + count - 1) % count];
+        const Key& k1 = m_Keys[i];
+        const Key& k2 = m_Keys[(i + 1) % count];
+        const Key& k3 = m_Keys[(i + 2) % count];
+        position = catmullRom(k0.Position, k1.Position, k2.Position, k3.Position, u);
+        glm::vec3 direction = glm::normalize(catmullRom(k0.Target, k1.Target, k2.Target, k3.Target, u) - position);
+        yaw = glm::degrees(std::atan2(direction.z, direction.x));
+        pitch = glm::degrees(std::asin(glm::clamp(direction.y, -1.0f, 1.0f)));
+    }
+
+private:
+    std::vector<Key> m_Keys;
+
+    static glm::vec3 catmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float u) {
+        float u2 = u * u, u3 = u2 * u;
+        return 0.5f * (2.0f * p1 + (p2 - p0) * u + (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * u2
+                       + (3.0f * p1 - p0 - 3.0f * p2 + p3) * u3);
+    }
+};
+
+// The --benchmark run: a fixed number of frames at a fixed time step along
+// BenchmarkCameraPath, or along a recorded CameraTrack from its start time to its end, so
+// every run renders the same images. The first WarmupFrames (shader compiles, first uploads,
+// the GPU timer ring filling up) are rendered but not reported.
+// Per frame it records
+//  - frame time, wall clock from one BeginFrame() to the next,
+//  - CPU time, BeginFrame() to EndSubmit(), the work of building and submitting the frame
+//    without waiting for the GPU,
+//  - GPU time of the same frame, from the caller's rg::GpuTimer after GpuTimer::Collect(true),
+//  - the rg::DrawCounter counters of the frame, in total and per pass and model,
+// and WriteReport() writes percentiles, counter means and maxima, the frames over the counter
+// budgets, the rg::MemoryTracker accounting at the end of the run and the peak resident memory
+// of the process to <output>.json with every frame to <output>.csv.
+class Benchmark {
+public:
+    struct Frame {
+        float FrameMs;
+        float CpuMs;
+        float GpuMs;
+        DrawCounter::Counters Counters;
+    };
+
+    int WarmupFrames = 30;
+    float TimeStep = 1.0f / 60.0f;
+    // how far a counter mean may rise over the baseline before it is a regression
+    float BaselineTolerance = 0.05f;
+
+    Benchmark(int frames, std::string output)
+        : m_Frames(frames), m_Output(output) {
+    }
+
+    bool Done() const {
+        return m_Frame >= WarmupFrames + m_Frames;
+    }
+
+    // replaces the scripted path, the run then takes as many frames as the track lasts
+    void SetTrack(const CameraTrack* track) {
+        m_Track = track;
+        m_Frames = (int) (track->Duration() / TimeStep) + 1;
+    }
+
+    // simulation time of the current frame in seconds
+    float Time() const {
+        if (m_Track)
+            return m_Track->StartTime() + std::max(0, m_Frame - WarmupFrames) * TimeStep;
+        return m_Frame * TimeStep;
+    }
+
+    // camera of the current frame, the whole path takes the measured frames
+    void ApplyCamera(Camera& camera) const {
+        if (m_Track) {
+            m_Track->Apply(Time(), camera);
+            return;
+        }
+        float t = std::max(0, m_Frame - WarmupFrames) / (float) std::max(1, m_Frames);
+        float yaw, pitch;
+        m_Path.Sample(t, camera.Position, yaw, pitch);
+        camera.SetOrientation(yaw, pitch);
+    }
+
+    void BeginFrame() {
+        auto now = std::chrono::steady_clock::now();
+        if (m_Frame > WarmupFrames && !m_Records.empty())
+            m_Records.back().FrameMs = std::chrono::duration<float, std::milli>(now - m_FrameStart).count();
+        m_FrameStart = now;
+        m_SubmitEnd = now;
+        m_Submitted = false;
+    }
+
+    // the frame is submitted, call before waiting for the GPU
+    void EndSubmit() {
+        m_SubmitEnd = std::chrono::steady_clock::now();
+        m_Submitted = true;
+    }
+
+    // reads the counters of the frame from rg::DrawCounter, call before its next Reset();
+    // without EndSubmit() the CPU time runs until here
+    void EndFrame(float gpuMs) {
+        auto now = std::chrono::steady_clock::now();
+        float cpuMs = std::chrono::duration<float, std::milli>((m_Submitted ? m_SubmitEnd : now) - m_FrameStart).count();
+        float frameMs = std::chrono::duration<float, std::milli>(now - m_FrameStart).count();
+        if (m_Frame >= WarmupFrames) {
+            m_Records.push_back(Frame{frameMs, cpuMs, gpuMs, DrawCounter::Frame()});
+            addCounters(m_PassCounters, DrawCounter::Passes());
+            addCounters(m_ModelCounters, DrawCounter::Models());
+            if (DrawCounter::OverBudget(DrawCounter::Frame()))
+                m_OverBudgetFrames++;
+        }
+        m_Frame++;
+    }
+
+    // frames over an rg::DrawCounter budget, a run with any should fail
+    int OverBudgetFrames() const {
+        return m_OverBudgetFrames;
+    }
+
+    // the last frame has no next BeginFrame(), call once Done() to close it
+    void Finish() {
+        BeginFrame();
+    }
+
+    void WriteReport(const std::string& renderer, const std::string& version, unsigned int width, unsigned int height) const {
+        std::ofstream csv(m_Output + ".csv");
+        csv << "frame,frame_ms,cpu_ms,gpu_ms";
+        for (int counter = 0; counter < DrawCounter::COUNTER_COUNT; counter++)
+            csv << ',' << DrawCounter::Name(counter);
+        csv << '\n';
+        for (size_t i = 0; i < m_Records.size(); i++) {
+            csv << i << ',' << m_Records[i].FrameMs << ',' << m_Records[i].CpuMs << ',' << m_Records[i].GpuMs;
+            for (unsigned int value : m_Records[i].Counters.Values)
+                csv << ',' << value;
+            csv << '\n';
+        }
+
+        std::ofstream json(m_Output + ".json");
+        json << "{\n"
+             << "  \"renderer\": \"" << escape(renderer) << "\",\n"
+             << "  \"version\": \"" << escape(version) << "\",\n"
+             << "  \"width\": " << width << ",\n"
+             << "  \"height\": " << height << ",\n"
+             << "  \"frames\": " << m_Records.size() << ",\n"
+             << "  \"warmup_frames\": " << WarmupFrames << ",\n"
+             << "  \"time_step\": " << TimeStep << ",\n";
+        writeStats(json, "frame_ms", &Frame::FrameMs);
+        writeStats(json, "cpu_ms", &Frame::CpuMs);
+        writeStats(json, "gpu_ms", &Frame::GpuMs);
+        for (int counter = 0; counter < DrawCounter::COUNTER_COUNT; counter++) {
+            unsigned int max = 0;
+            for (const Frame& frame : m_Records)
+                max = std::max(max, frame.Counters.Values[counter]);
+            json << "  \"" << DrawCounter::Name(counter) << "\": {\"mean\": " << counterMean(counter)
+                 << ", \"max\": " << max << ", \"budget\": " << DrawCounter::Budget.Values[counter] << "},\n";
+        }
+        writeCounterMeans(json, "passes", m_PassCounters);
+        writeCounterMeans(json, "models", m_ModelCounters);
+        json << "  \"over_budget_frames\": " << m_OverBudgetFrames << ",\n";
+        writeMemory(json);
+        json << "  \"peak_rss_mb\": " << PeakResidentMB() << "\n"
+             << "}\n";
+
+        std::cout << "Benchmark: " << m_Records.size() << " frames on " << renderer << ", report in " << m_Output
+                  << ".json and " << m_Output << ".csv" << std::endl;
+    }
+
+    // Compares the counter means with the report of an earlier run over the same frames at the
+    // same size and returns how many rose more than BaselineTolerance (and by at least one), so
+    // a change that submits more per frame fails without anyone setting a budget. A missing or
+    // unreadable baseline is an error, -1; WriteBaseline() makes one.
+    int CompareBaseline(const std::string& path, unsigned int width, unsigned int height) const {
+        std::ifstream in(path);
+        if (!in) {
+            std::cout << "ERROR::BENCHMARK:: No baseline at " << path << ", write one from a trusted run with --write-baseline" << std::endl;
+            return -1;
+        }
+        std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        double frames = 0.0, baselineWidth = 0.0, baselineHeight = 0.0;
+        if (!readNumber(json, "\"frames\": ", frames) || !readNumber(json, "\"width\": ", baselineWidth)
+            || !readNumber(json, "\"height\": ", baselineHeight)) {
+            std::cout << "ERROR::BENCHMARK:: " << path << " is not a benchmark report" << std::endl;
+            return -1;
+        }
+        if ((size_t) frames != m_Records.size() || (unsigned int) baselineWidth != width || (unsigned int) baselineHeight != height) {
+            std::cout << "WARNING::BENCHMARK:: Baseline " << path << " is of " << frames << " frames at " << baselineWidth
+                      << "x" << baselineHeight << ", not compared" << std::endl;
+            return 0;
+        }
+        int regressions = 0;
+        for (int counter = 0; counter < DrawCounter::COUNTER_COUNT; counter++) {
+            double baseline = 0.0;
+            if (!readNumber(json, "\"" + std::string(DrawCounter::Name(counter)) + "\": {\"mean\": ", baseline))
+                continue;
+            double mean = counterMean(counter);
+            if (mean > baseline * (1.0 + BaselineTolerance) && mean - baseline >= 1.0) {
+                std::cout << "ERROR::BENCHMARK:: " << DrawCounter::Name(counter) << " " << mean << " per frame, "
+                          << baseline << " in the baseline" << std::endl;
+                regressions++;
+            }
+        }
+        return regressions;
+    }
+
+    // this run's report, written by WriteReport(), becomes the baseline at path; check it in to
+    // share it
+    bool WriteBaseline(const std::string& path) const {
+        std::ifstream report(m_Output + ".json");
+        std::ofstream baseline(path);
+        if (!report || !(baseline << report.rdbuf())) {
+            std::cout << "ERROR::BENCHMARK:: Could not write the baseline " << path << std::endl;
+            return false;
+        }
+        std::cout << "Benchmark: baseline written to " << path << std::endl;
+        return true;
+    }
+
+    // peak resident set size of the process, 0 where the platform does not tell
+    static float PeakResidentMB() {
+#if defined(__APPLE__)
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / (1024.0f * 1024.0f);
+#elif defined(__unix__)
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0f;
+#else
+        return 0.0f;
+#endif
+    }
+
+private:
+    int m_Frames;
+    std::string m_Output;
+    BenchmarkCameraPath m_Path;
+    const CameraTrack* m_Track = NULL;
+    int m_Frame = 0;
+    std::chrono::steady_clock::time_point m_FrameStart;
+    std::chrono::steady_clock::time_point m_SubmitEnd;
+    bool m_Submitted = false;
+    std::vector<Frame> m_Records;
+    // counter sums over the reported frames, doubles as triangles overflow 32 bits
+    std::map<std::string, std::vector<double>> m_PassCounters;
+    std::map<std::string, std::vector<double>> m_ModelCounters;
+    int m_OverBudgetFrames = 0;
+
+    double counterMean(int counter) const {
+        double sum = 0.0;
+        for (const Frame& frame : m_Records)
+            sum += frame.Counters.Values[counter];
+        return sum / std::max<size_t>(1, m_Records.size());
+    }
+
+    // the number after key, reports are only ever written by WriteReport()
+    static bool readNumber(const std::string& json, const std::string& key, double& value) {
+        size_t found = json.find(key);
+        if (found == std::string::npos)
+            return false;
+        value = std::atof(json.c_str() + found + key.size());
+        return true;
+    }
+
+    static void addCounters(std::map<std::string, std::vector<double>>& sums, const std::map<std::string, DrawCounter::Counters>& counters) {
+        for (const auto& entry : counters) {
+            std::vector<double>& sum = sums[entry.first];
+            sum.resize(DrawCounter::COUNTER_COUNT, 0.0);
+            for (int counter = 0; counter < DrawCounter::COUNTER_COUNT; counter++)
+                sum[counter] += entry.second.Values[counter];
+        }
+    }
+
+    // per frame means of every counter of every pass or model
+    void writeCounterMeans(std::ofstream& json, const char* name, const std::map<std::string, std::vector<double>>& sums) const {
+        json << "  \"" << name << "\": {";
+        bool first = true;
+        for (const auto& entry : sums) {
+            json << (first ? "\n" : ",\n") << "    \"" << escape(entry.first) << "\": {";
+            for (int counter = 0; counter < DrawCounter::COUNTER_COUNT; counter++)
+                json << (counter ? ", " : "") << "\"" << DrawCounter::Name(counter) << "\": "
+                     << entry.second[counter] / std::max<size_t>(1, m_Records.size());
+            json << "}";
+            first = false;
+        }
+        json << (first ? "},\n" : "\n  },\n");
+    }
+
+    // nearest rank percentiles over the reported frames
+    void writeStats(std::ofstream& json, const char* name, float Frame::*field) const {
+        std::vector<float> values;
+        for (const Frame& frame : m_Records)
+            values.push_back(frame.*field);
+        std::sort(values.begin(), values.end());
+        auto percentile = [&](float p) {
+            if (values.empty())
+                return 0.0f;
+            size_t rank = (size_t) std::ceil(p / 100.0f * values.size());
+            return values[std::min(values.size() - 1, rank > 0 ? rank - 1 : 0)];
+        };
+        float sum = 0.0f;
+        for (float value : values)
+            sum += value;
+        json << "  \"" << name << "\": {\"mean\": " << sum / std::max<size_t>(1, values.size())
+             << ", \"p50\": " << percentile(50.0f) << ", \"p90\": " << percentile(90.0f)
+             << ", \"p95\": " << percentile(95.0f) << ", \"p99\": " << percentile(99.0f)
+             << ", \"max\": " << (values.empty() ? 0.0f : values.back()) << "},\n";
+    }
+
+    // the totals, every owner and the LARGEST_RESOURCES largest resources, in MB
+    static void writeMemory(std::ofstream& json) {
+        const int LARGEST_RESOURCES = 10;
+        const float MB = 1024.0f * 1024.0f;
+        MemoryTracker::Usage total = MemoryTracker::Total();
+        json << "  \"memory\": {\"gpu_mb\": " << total.GpuBytes() / MB
+             << ", \"peak_gpu_mb\": " << MemoryTracker::PeakGpuBytes() / MB;
+        for (int kind = 0; kind < MemoryTracker::KIND_COUNT; kind++)
+            json << ", \"" << MemoryTracker::Name((MemoryTracker::Kind) kind) << "s_mb\": " << total.Bytes[kind] / MB;
+        json << ", \"cpu_copies_mb\": " << total.CpuBytes / MB << ",\n    \"owners\": {";
+        bool first = true;
+        for (const auto& owner : MemoryTracker::ByTag()) {
+            json << (first ? "\n" : ",\n") << "      \"" << escape(owner.first) << "\": {\"gpu_mb\": "
+                 << owner.second.GpuBytes() / MB << ", \"cpu_mb\": " << owner.second.CpuBytes / MB << "}";
+            first = false;
+        }
+        json << "},\n    \"largest\": [";
+        first = true;
+        for (const MemoryTracker::Resource& resource : MemoryTracker::Largest(LARGEST_RESOURCES)) {
+            json << (first ? "\n" : ",\n") << "      {\"type\": \"" << MemoryTracker::Name(resource.Type)
+                 << "\", \"id\": " << resource.Id << ", \"owner\": \"" << escape(resource.Tag)
+                 << "\", \"width\": " << resource.Width << ", \"height\": " << resource.Height
+                 << ", \"mb\": " << resource.Bytes / MB << "}";
+            first = false;
+        }
+        json << "]},\n";
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string result;
+        for (char c : text) {
+            if (c == '"' || c == '\\')
+                result += '\\';
+            result += c;
+        }
+        return result;
+    }
+};
+
+}
+#endif //PROJECT_BASE_BENCHMARK_H
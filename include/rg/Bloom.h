@@ -0,0 +1,166 @@
+#ifndef PROJECT_BASE_BLOOM_H
+#define PROJECT_BASE_BLOOM_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <learnopengl/shader.h>
+#include <rg/FrameGraph.h>
+#include <rg/GpuTimer.h>
+
+namespace rg {
+
+// Physically based bloom: the HDR scene is downsampled through a chain of half-size levels
+// starting at quarter width and height, then the chain is upsampled back with a tent filter,
+// every level adding onto the next larger one. The composite mixes the top level into the
+// scene before tonemapping, so there is no brightness threshold. Going down and back up the
+// chain touches about a sixth of the pixels of one full-screen pass, whatever the radius.
+class Bloom {
+public:
+    static const int MAX_LEVELS = 8;
+
+    bool Enabled = true;
+    // weight of the bloom in the composite, mix(scene, bloom, Strength)
+    float Strength = 0.04f;
+    // upsample tent radius in texture coordinates
+    float FilterRadius = 0.005f;
+    int Levels = 6;
+
+    Bloom()
+            : m_DownsampleShader("resources/shaders/fullscreen.vs", "resources/shaders/bloom_downsample.fs"),
+              m_UpsampleShader("resources/shaders/fullscreen.vs", "resources/shaders/bloom_upsample.fs") {
+        // core profiles need a bound VAO even when the vertex shader makes up its own positions
+        glGenVertexArrays(1, &m_VAO);
+        m_DownsampleShader.use();
+        m_DownsampleShader.setInt("sourceTexture", 0);
+        m_UpsampleShader.use();
+        m_UpsampleShader.setInt("sourceTexture", 0);
+    }
+
+    ~Bloom() {
+        glDeleteVertexArrays(1, &m_VAO);
+    }
+
+    Bloom(const Bloom&) = delete;
+    Bloom& operator=(const Bloom&) = delete;
+
+    // Adds the downsample and upsample passes and returns the top level of the chain, which
+    // covers the rendered region (renderWidth x renderHeight) of color in [0, 1] coordinates.
+    FrameGraphResource AddPasses(FrameGraph& graph, FrameGraphResource color,
+                                 unsigned int renderWidth, unsigned int renderHeight) {
+        const FrameGraphTextureDesc& sceneDesc = graph.GetDesc(color);
+        m_RenderScale = glm::vec2((float) renderWidth / sceneDesc.Width, (float) renderHeight / sceneDesc.Height);
+
+        // the level sizes follow the full-size scene target, not the dynamic resolution, so the
+        // pooled textures are reused from frame to frame
+        m_Mips.clear();
+        unsigned int width = sceneDesc.Width, height = sceneDesc.Height;
+        int levels = std::max(1, std::min(Levels, MAX_LEVELS));
+        for (int i = 0; i < levels && width > 3 && height > 3; i++) {
+            width /= (i == 0 ? 4 : 2);
+            height /= (i == 0 ? 4 : 2);
+            m_Mips.push_back(Mip());
+            m_Mips.back().Width = width;
+            m_Mips.back().Height = height;
+        }
+        m_LevelCount = (int) m_Mips.size();
+
+        FrameGraphResource source = color;
+        for (int i = 0; i < m_LevelCount; i++) {
+            graph.AddPass("bloom down " + std::to_string(i),
+                [&](FrameGraph::Builder& builder) {
+                    builder.Read(source);
+                    FrameGraphTextureDesc desc(m_Mips[i].Width, m_Mips[i].Height, GL_R11F_G11F_B10F);
+                    m_Mips[i].Resource = builder.Write(builder.Create("bloom " + std::to_string(i), desc));
+                },
+                [this, i, source](const FrameGraph& g) {
+                    if (i == 0)
+                        m_Timer.Begin();
+                    downsample(g.GetTexture(source), g.GetDesc(source).Width, i);
+                    if (m_LevelCount == 1)
+                        m_Timer.End();
+                });
+            source = m_Mips[i].Resource;
+        }
+
+        for (int i = m_LevelCount - 1; i > 0; i--) {
+            graph.AddPass("bloom up " + std::to_string(i - 1),
+                [&](FrameGraph::Builder& builder) {
+                    builder.Read(m_Mips[i].Resource);
+                    builder.Write(m_Mips[i - 1].Resource);
+                },
+                [this, i](const FrameGraph& g) {
+                    upsample(g.GetTexture(m_Mips[i].Resource));
+                    if (i == 1)
+                        m_Timer.End();
+                });
+        }
+        return m_Mips[0].Resource;
+    }
+
+    float LastMs() const {
+        return m_Timer.LastMs();
+    }
+
+    // pixels the chain touches relative to one full-screen pass at the scene resolution
+    float PixelFraction(unsigned int fullWidth, unsigned int fullHeight) const {
+        double pixels = 0.0;
+        for (const Mip& mip : m_Mips)
+            pixels += (double) mip.Width * mip.Height;
+        // every level except the smallest is written twice, once going down and once going up
+        if (!m_Mips.empty())
+            pixels = 2.0 * pixels - (double) m_Mips.back().Width * m_Mips.back().Height;
+        return (float) (pixels / ((double) fullWidth * fullHeight));
+    }
+
+private:
+    struct Mip {
+        unsigned int Width = 0;
+        unsigned int Height = 0;
+        FrameGraphResource Resource = -1;
+    };
+
+    Shader m_DownsampleShader;
+    Shader m_UpsampleShader;
+    unsigned int m_VAO = 0;
+    std::vector<Mip> m_Mips;
+    int m_LevelCount = 0;
+    glm::vec2 m_RenderScale = glm::vec2(1.0f);
+    GpuTimer m_Timer;
+
+    void downsample(unsigned int source, unsigned int sourceWidth, int level) {
+        m_DownsampleShader.use();
+        // the taps are laid out for a 2:1 reduction, the quarter-size first level spreads them wider
+        m_DownsampleShader.setFloat("sampleSpacing", (float) sourceWidth / m_Mips[level].Width / 2.0f);
+        m_DownsampleShader.setVec2("renderScale", level == 0 ? m_RenderScale : glm::vec2(1.0f));
+        m_DownsampleShader.setBool("karisAverage", level == 0);
+        draw(source);
+    }
+
+    void upsample(unsigned int source) {
+        m_UpsampleShader.use();
+        m_UpsampleShader.setFloat("filterRadius", FilterRadius);
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_ONE, GL_ONE);
+        draw(source);
+        // back to the blend function the scene passes expect
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+        glDisable(GL_BLEND);
+    }
+
+    void draw(unsigned int source) {
+        glDisable(GL_DEPTH_TEST);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, source);
+        glBindVertexArray(m_VAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glEnable(GL_DEPTH_TEST);
+    }
+};
+
+}
+#endif //PROJECT_BASE_BLOOM_H
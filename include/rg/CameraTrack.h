@@ -0,0 +1,225 @@
+#ifndef PROJECT_BASE_CAMERATRACK_H
+#define PROJECT_BASE_CAMERATRACK_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <learnopengl/camera.h>
+
+namespace rg {
+
+// A recorded camera flight for reproducible performance captures. Recording stores the
+// camera (position, yaw, pitch, zoom) once per frame together with the simulation time the
+// frame was rendered at. Playback is frame locked: frame n shows simulation time
+// start + n * TimeStep with the camera interpolated to that time, whatever frame rate the
+// track was recorded at, so the light animation and clock motion match between runs.
+// The file is a 12 byte header ("RGCT", version, sample count) followed by seven
+// little-endian floats per sample.
+class CameraTrack {
+public:
+    struct Sample {
+        float Time;
+        glm::vec3 Position;
+        float Yaw;
+        float Pitch;
+        float Zoom;
+    };
+
+    float TimeStep = 1.0f / 60.0f;
+
+    void StartRecording() {
+        m_Samples.clear();
+        m_Playing = false;
+        m_Recording = true;
+    }
+
+    void StopRecording() {
+        m_Recording = false;
+    }
+
+    bool IsRecording() const {
+        return m_Recording;
+    }
+
+    // call once per frame while recording, time must not go back
+    void Record(float time, const Camera& camera) {
+        if (!m_Recording || (!m_Samples.empty() && time < m_Samples.back().Time))
+            return;
+        m_Samples.push_back(Sample{time, camera.Position, camera.Yaw, camera.Pitch, camera.Zoom});
+    }
+
+    void StartPlayback() {
+        m_Recording = false;
+        m_Playing = !m_Samples.empty();
+        m_Frame = 0;
+    }
+
+    void StopPlayback() {
+        m_Playing = false;
+    }
+
+    bool IsPlaying() const {
+        return m_Playing;
+    }
+
+    // the simulation time of the current playback frame
+    float PlaybackTime() const {
+        return StartTime() + m_Frame * TimeStep;
+    }
+
+    // puts the camera where it was at the current playback frame
+    void Apply(Camera& camera) const {
+        Apply(PlaybackTime(), camera);
+    }
+
+    void Apply(float time, Camera& camera) const {
+        if (m_Samples.empty())
+            return;
+        Sample sample = SampleAt(time);
+        camera.Position = sample.Position;
+        camera.Zoom = sample.Zoom;
+        camera.SetOrientation(sample.Yaw, sample.Pitch);
+    }
+
+    // moves playback to the next frame, it stops after the last recorded time
+    void Advance() {
+        if (!m_Playing)
+            return;
+        m_Frame++;
+        if (m_Frame >= FrameCount())
+            m_Playing = false;
+    }
+
+    int PlaybackFrame() const {
+        return m_Frame;
+    }
+
+    // frames a playback at TimeStep takes
+    int FrameCount() const {
+        return m_Samples.empty() ? 0 : (int) (Duration() / TimeStep) + 1;
+    }
+
+    int SampleCount() const {
+        return (int) m_Samples.size();
+    }
+
+    float StartTime() const {
+        return m_Samples.empty() ? 0.0f : m_Samples.front().Time;
+    }
+
+    float Duration() const {
+        return m_Samples.empty() ? 0.0f : m_Samples.back().Time - m_Samples.front().Time;
+    }
+
+    // linear between the recorded samples around time, clamped to the ends
+    Sample SampleAt(float time) const {
+        auto next = std::lower_bound(m_Samples.begin(), m_Samples.end(), time,
+                                     [](const Sample& sample, float t) { return sample.Time < t; });
+        if (next == m_Samples.begin())
+            return m_Samples.front();
+        if (next == m_Samples.end())
+            return m_Samples.back();
+        const Sample& a = *(next - 1);
+        const Sample& b = *next;
+        float u = b.Time > a.Time ? (time - a.Time) / (b.Time - a.Time) : 1.0f;
+        return Sample{time, glm::mix(a.Position, b.Position, u), a.Yaw + (b.Yaw - a.Yaw) * u,
+                      a.Pitch + (b.Pitch - a.Pitch) * u, a.Zoom + (b.Zoom - a.Zoom) * u};
+    }
+
+    bool Save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            std::cout << "ERROR::CAMERA_TRACK:: Could not write " << path << std::endl;
+            return false;
+        }
+        out.write("RGCT", 4);
+        writeUint(out, VERSION);
+        writeUint(out, (uint32_t) m_Samples.size());
+        for (const Sample& sample : m_Samples)
+            for (float value : {sample.Time, sample.Position.x, sample.Position.y, sample.Position.z, sample.Yaw, sample.Pitch, sample.Zoom})
+                writeFloat(out, value);
+        return (bool) out;
+    }
+
+    bool Load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        char magic[4] = {};
+        uint32_t version = 0, count = 0;
+        in.read(magic, 4);
+        if (!in || std::memcmp(magic, "RGCT", 4) != 0 || !readUint(in, version) || version != VERSION || !readUint(in, count)) {
+            std::cout << "ERROR::CAMERA_TRACK:: " << path << " is not a camera track" << std::endl;
+            return false;
+        }
+        // a damaged count must not allocate more than the file can hold
+        std::streampos samplesStart = in.tellg();
+        in.seekg(0, std::ios::end);
+        std::streamoff sampleBytes = in.tellg() - samplesStart;
+        in.seekg(samplesStart);
+        if (sampleBytes < 0 || (uint64_t) count * SAMPLE_SIZE > (uint64_t) sampleBytes) {
+            std::cout << "ERROR::CAMERA_TRACK:: " << path << " is truncated" << std::endl;
+            return false;
+        }
+        std::vector<Sample> samples(count);
+        for (Sample& sample : samples) {
+            float* values[] = {&sample.Time, &sample.Position.x, &sample.Position.y, &sample.Position.z, &sample.Yaw, &sample.Pitch, &sample.Zoom};
+            for (float* value : values)
+                if (!readFloat(in, *value)) {
+                    std::cout << "ERROR::CAMERA_TRACK:: " << path << " is truncated" << std::endl;
+                    return false;
+                }
+        }
+        m_Samples.swap(samples);
+        m_Recording = false;
+        m_Playing = false;
+        m_Frame = 0;
+        return true;
+    }
+
+private:
+    static const uint32_t VERSION = 1;
+    // seven floats
+    static const uint32_t SAMPLE_SIZE = 7 * 4;
+
+    std::vector<Sample> m_Samples;
+    bool m_Recording = false;
+    bool m_Playing = false;
+    int m_Frame = 0;
+
+    // byte by byte, the file reads the same on any host
+    static void writeUint(std::ofstream& out, uint32_t value) {
+        unsigned char bytes[4] = {(unsigned char) value, (unsigned char) (value >> 8), (unsigned char) (value >> 16), (unsigned char) (value >> 24)};
+        out.write((const char*) bytes, 4);
+    }
+
+    static bool readUint(std::ifstream& in, uint32_t& value) {
+        unsigned char bytes[4];
+        if (!in.read((char*) bytes, 4))
+            return false;
+        value = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t) bytes[3] << 24);
+        return true;
+    }
+
+    static void writeFloat(std::ofstream& out, float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, 4);
+        writeUint(out, bits);
+    }
+
+    static bool readFloat(std::ifstream& in, float& value) {
+        uint32_t bits;
+        if (!readUint(in, bits))
+            return false;
+        std::memcpy(&value, &bits, 4);
+        return true;
+    }
+};
+
+}
+#endif //PROJECT_BASE_CAMERATRACK_H
@@ -0,0 +1,225 @@
+#ifndef PROJECT_BASE_CPUPROFILER_H
+#define PROJECT_BASE_CPUPROFILER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define RG_CPU_PROFILER_TSC 1
+#endif
+
+// RG_ZONE("name") times the rest of the enclosing scope, name must outlive the program (a
+// literal). RG_ZONE_DYNAMIC(text) takes any std::string, interning it under a lock, so it is
+// for startup work like model loading, not for the frame loop. Both compile to nothing
+// without RG_CPU_PROFILER.
+#define RG_ZONE_CONCAT2(a, b) a##b
+#define RG_ZONE_CONCAT(a, b) RG_ZONE_CONCAT2(a, b)
+#ifdef RG_CPU_PROFILER
+#define RG_ZONE(name) rg::CpuZone RG_ZONE_CONCAT(rgZone, __LINE__)(name)
+#define RG_ZONE_DYNAMIC(text) rg::CpuZone RG_ZONE_CONCAT(rgZone, __LINE__)(rg::CpuProfiler::Intern(text))
+#else
+#define RG_ZONE(name)
+#define RG_ZONE_DYNAMIC(text)
+#endif
+
+#ifdef RG_CPU_PROFILER
+namespace rg {
+
+// Scoped CPU zones, written by every thread into its own ring of RING_SIZE events with no
+// locks: a zone is two time stamp counter reads and one event store, inlined into the scope.
+// Zones recorded before EndStartup() are kept in full instead, so a trace always covers model
+// loading and shader compilation as well as the last RING_SIZE zones of every thread.
+// WriteChromeTrace() exports both as Chrome trace_event JSON (ui.perfetto.dev, chrome://tracing).
+// Run it on the recording thread or while the others are idle; events a thread overwrites
+// during the export are skipped.
+class CpuProfiler {
+public:
+    static const uint64_t RING_SIZE = 1 << 16;
+
+    struct Event {
+        const char* Name;
+        uint64_t Begin;
+        uint64_t End;
+    };
+
+    // off skips recording, the zones still cost the two counter reads
+    static bool Enabled;
+
+    static uint64_t Now() {
+#ifdef RG_CPU_PROFILER_TSC
+        return __rdtsc();
+#else
+        return (uint64_t) std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    // the ring store inline, the first zone of a thread and startup zones out of line
+    static void Record(const char* name, uint64_t begin, uint64_t end) {
+        ThreadBuffer* buffer = t_Buffer;
+        if (s_Startup || !buffer) {
+            recordSlow(name, begin, end);
+            return;
+        }
+        if (!Enabled)
+            return;
+        uint64_t count = buffer->Count.load(std::memory_order_relaxed);
+        buffer->Ring[count & (RING_SIZE - 1)] = Event{name, begin, end};
+        buffer->Count.store(count + 1, std::memory_order_release);
+    }
+
+    // from here on zones go into the rings; a plain store, not an atomic every zone has to
+    // load, so call it on the main thread before other threads record
+    static void EndStartup() {
+        s_Startup = false;
+    }
+
+    static const char* Intern(const std::string& text) {
+        std::lock_guard<std::mutex> lock(s_Registry.Mutex);
+        return s_Registry.Names.insert(text).first->c_str();
+    }
+
+    static bool WriteChromeTrace(const std::string& path) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cout << "ERROR::CPU_PROFILER:: Could not write " << path << std::endl;
+            return false;
+        }
+        double nsPerTick = calibrate();
+        Registry& r = s_Registry;
+        std::vector<ThreadBuffer*> threads;
+        {
+            std::lock_guard<std::mutex> lock(r.Mutex);
+            threads = r.Threads;
+        }
+        out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        bool first = true;
+        for (size_t thread = 0; thread < threads.size(); thread++) {
+            ThreadBuffer& buffer = *threads[thread];
+            out << (first ? "" : ",\n") << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread
+                << ", \"args\": {\"name\": \"" << (thread == 0 ? "main" : "worker " + std::to_string(thread)) << "\"}}";
+            first = false;
+            std::vector<Event> events = buffer.Startup;
+            uint64_t end = buffer.Count.load(std::memory_order_acquire);
+            uint64_t begin = end > RING_SIZE ? end - RING_SIZE : 0;
+            size_t startupCount = events.size();
+            for (uint64_t i = begin; i < end; i++)
+                events.push_back(buffer.Ring[i & (RING_SIZE - 1)]);
+            // whatever the thread wrote meanwhile may have replaced the oldest events, and at
+            // written == begin + RING_SIZE it may be storing over event begin right now
+            std::atomic_thread_fence(std::memory_order_acquire);
+            uint64_t written = buffer.Count.load(std::memory_order_relaxed);
+            size_t overwritten = written >= RING_SIZE + begin ? (size_t) std::min<uint64_t>(end - begin, written - RING_SIZE - begin + 1) : 0;
+            events.erase(events.begin() + startupCount, events.begin() + startupCount + overwritten);
+            for (const Event& event : events)
+                out << ",\n{\"name\": \"" << escape(event.Name) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread
+                    << ", \"ts\": " << (uint64_t) ((event.Begin - r.Origin) * nsPerTick) / 1000.0
+                    << ", \"dur\": " << (uint64_t) ((event.End - event.Begin) * nsPerTick) / 1000.0 << "}";
+        }
+        out << "\n]}\n";
+        std::cout << "CPU trace written to " << path << std::endl;
+        return (bool) out;
+    }
+
+private:
+    struct ThreadBuffer {
+        std::vector<Event> Startup;
+        Event Ring[RING_SIZE];
+        std::atomic<uint64_t> Count{0};
+    };
+
+    struct Registry {
+        std::mutex Mutex;
+        std::vector<ThreadBuffer*> Threads;
+        std::set<std::string> Names;
+        // counter and clock at startup, WriteChromeTrace measures the counter rate against them
+        uint64_t Origin = Now();
+        std::chrono::steady_clock::time_point OriginTime = std::chrono::steady_clock::now();
+    };
+
+    static bool s_Startup;
+    // constructed before main, so the origin precedes every zone
+    static Registry s_Registry;
+    // constant initialised, reading it needs no thread_local guard
+    static thread_local ThreadBuffer* t_Buffer;
+
+    // buffers are never freed, a trace still shows threads that have finished
+    static void recordSlow(const char* name, uint64_t begin, uint64_t end) {
+        if (!t_Buffer) {
+            t_Buffer = new ThreadBuffer();
+            std::lock_guard<std::mutex> lock(s_Registry.Mutex);
+            s_Registry.Threads.push_back(t_Buffer);
+        }
+        if (!Enabled)
+            return;
+        if (s_Startup) {
+            t_Buffer->Startup.push_back(Event{name, begin, end});
+            return;
+        }
+        uint64_t count = t_Buffer->Count.load(std::memory_order_relaxed);
+        t_Buffer->Ring[count & (RING_SIZE - 1)] = Event{name, begin, end};
+        t_Buffer->Count.store(count + 1, std::memory_order_release);
+    }
+
+    static std::string escape(const char* text) {
+        std::string result;
+        for (; *text; text++) {
+            if (*text == '"' || *text == '\\')
+                result += '\\';
+            result += *text;
+        }
+        return result;
+    }
+
+    static double calibrate() {
+#ifdef RG_CPU_PROFILER_TSC
+        Registry& r = s_Registry;
+        uint64_t ticks = Now() - r.Origin;
+        double ns = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - r.OriginTime).count();
+        return ticks > 0 ? ns / (double) ticks : 1.0;
+#else
+        return 1.0;
+#endif
+    }
+};
+
+bool CpuProfiler::Enabled = true;
+bool CpuProfiler::s_Startup = true;
+CpuProfiler::Registry CpuProfiler::s_Registry;
+thread_local CpuProfiler::ThreadBuffer* CpuProfiler::t_Buffer = nullptr;
+
+class CpuZone {
+public:
+    explicit CpuZone(const char* name)
+        : m_Name(name), m_Begin(CpuProfiler::Now()) {
+    }
+
+    ~CpuZone() {
+        CpuProfiler::Record(m_Name, m_Begin, CpuProfiler::Now());
+    }
+
+    CpuZone(const CpuZone&) = delete;
+    CpuZone& operator=(const CpuZone&) = delete;
+
+private:
+    const char* m_Name;
+    uint64_t m_Begin;
+};
+
+}
+#endif
+#endif //PROJECT_BASE_CPUPROFILER_H
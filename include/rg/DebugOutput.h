@@ -0,0 +1,269 @@
+#ifndef PROJECT_BASE_DEBUGOUTPUT_H
+#define PROJECT_BASE_DEBUGOUTPUT_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <rg/Error.h>
+#include <rg/GLExt.h>
+
+namespace rg {
+
+// GL errors and driver warnings through glDebugMessageCallback instead of glGetError polling.
+// Asynchronous (the default) the driver reports whenever it likes, from whatever thread, and
+// nothing in the frame waits for it; synchronous it reports inside the failing call, so a
+// breakpoint in callback() (or BreakOnError) stops at the culprit, at the cost of the driver
+// serialising. GLCALL does not poll glGetError unless built with RG_GL_ERROR_POLL, see
+// rg/Error.h; built with RG_GL_CALL_SITES synchronous messages name the GLCALL.
+// Messages below MinSeverity are not generated, ignored ids are dropped. A message seen
+// before is not printed again, only its count goes up. The last RING_SIZE distinct messages
+// are kept for the ImGui log.
+// Drivers only have to report on a debug context, ask for one when creating the context;
+// most report errors without one too.
+class DebugOutput {
+public:
+    static const int RING_SIZE = 256;
+
+    struct Message {
+        GLenum Source;
+        GLenum Type;
+        GLuint Id;
+        GLenum Severity;
+        std::string Text;
+        // where GLCALL was in synchronous mode, empty otherwise
+        std::string CallSite;
+        int Count;
+    };
+
+    // GL_DEBUG_SEVERITY_HIGH, MEDIUM, LOW or NOTIFICATION
+    static GLenum MinSeverity;
+    // traps on GL_DEBUG_TYPE_ERROR, only useful synchronous under a debugger
+    static bool BreakOnError;
+
+    static bool IsAvailable() {
+        return GLExt::Debug;
+    }
+
+    static bool IsDebugContext() {
+        GLint flags = 0;
+        glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+        return (flags & GL_CONTEXT_FLAG_DEBUG_BIT) != 0;
+    }
+
+    static bool Enable(bool synchronous) {
+        if (!IsAvailable()) {
+            std::cout << "ERROR::DEBUG_OUTPUT:: Needs OpenGL 4.3, GL_KHR_debug or GL_ARB_debug_output" << std::endl;
+            return false;
+        }
+        if (synchronous && !IsDebugContext())
+            std::cout << "WARNING::DEBUG_OUTPUT:: Not a debug context, the driver may report nothing" << std::endl;
+        glEnable(GL_DEBUG_OUTPUT);
+        glDebugMessageCallback(callback, nullptr);
+        s_Enabled = true;
+        SetSynchronous(synchronous);
+        SetMinSeverity(MinSeverity);
+        return true;
+    }
+
+    static void Disable() {
+        if (!s_Enabled)
+            return;
+        glDisable(GL_DEBUG_OUTPUT);
+        glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        glDebugMessageCallback(nullptr, nullptr);
+        s_Enabled = false;
+        s_Synchronous = false;
+        WarnUnchecked();
+    }
+
+    // GLCALL only reports errors through debug output unless built with RG_GL_ERROR_POLL,
+    // without it nothing does; call when debug output is off
+    static void WarnUnchecked() {
+#ifndef RG_GL_ERROR_POLL
+        std::cout << "WARNING::DEBUG_OUTPUT:: " << (IsAvailable() ? "Debug output is off" : "The driver has no debug output")
+                  << ", GL errors go unreported; build with RG_GL_ERROR_POLL to check every GLCALL" << std::endl;
+#endif
+    }
+
+    static bool IsEnabled() {
+        return s_Enabled;
+    }
+
+    static void SetSynchronous(bool synchronous) {
+        if (!s_Enabled)
+            return;
+        if (synchronous)
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        else
+            glDisable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+        s_Synchronous = synchronous;
+    }
+
+    static bool IsSynchronous() {
+        return s_Synchronous;
+    }
+
+    // filtered in the driver, messages below severity are not even generated
+    static void SetMinSeverity(GLenum severity) {
+        MinSeverity = severity;
+        if (!s_Enabled)
+            return;
+        for (GLenum level : {GL_DEBUG_SEVERITY_NOTIFICATION, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_HIGH})
+            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, level, 0, nullptr, rank(level) >= rank(severity) ? GL_TRUE : GL_FALSE);
+    }
+
+    // drops every message with the id, whatever its source
+    static void Ignore(GLuint id, bool ignore = true) {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        if (ignore)
+            s_Ignored.insert(id);
+        else
+            s_Ignored.erase(id);
+    }
+
+    static std::set<GLuint> IgnoredIds() {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_Ignored;
+    }
+
+    // distinct messages, oldest first
+    static std::vector<Message> Messages() {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        std::vector<Message> messages;
+        for (int i = 0; i < std::min(s_Written, RING_SIZE); i++)
+            messages.push_back(s_Ring[(s_Written - std::min(s_Written, RING_SIZE) + i) % RING_SIZE]);
+        return messages;
+    }
+
+    // every message received, repeats included
+    static int TotalCount() {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        return s_Total;
+    }
+
+    // forgets the log and which messages were seen, they print again
+    static void Clear() {
+        std::lock_guard<std::mutex> lock(s_Mutex);
+        s_Seen.clear();
+        s_Written = 0;
+        s_Total = 0;
+    }
+
+    static const char* SourceName(GLenum source) {
+        switch (source) {
+            case GL_DEBUG_SOURCE_API: return "API";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "WINDOW_SYSTEM";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER: return "SHADER_COMPILER";
+            case GL_DEBUG_SOURCE_THIRD_PARTY: return "THIRD_PARTY";
+            case GL_DEBUG_SOURCE_APPLICATION: return "APPLICATION";
+        }
+        return "OTHER";
+    }
+
+    static const char* TypeName(GLenum type) {
+        switch (type) {
+            case GL_DEBUG_TYPE_ERROR: return "ERROR";
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "DEPRECATED";
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "UNDEFINED_BEHAVIOR";
+            case GL_DEBUG_TYPE_PORTABILITY: return "PORTABILITY";
+            case GL_DEBUG_TYPE_PERFORMANCE: return "PERFORMANCE";
+            case GL_DEBUG_TYPE_MARKER: return "MARKER";
+            case GL_DEBUG_TYPE_PUSH_GROUP: return "PUSH_GROUP";
+            case GL_DEBUG_TYPE_POP_GROUP: return "POP_GROUP";
+        }
+        return "OTHER";
+    }
+
+    static const char* SeverityName(GLenum severity) {
+        switch (severity) {
+            case GL_DEBUG_SEVERITY_HIGH: return "HIGH";
+            case GL_DEBUG_SEVERITY_MEDIUM: return "MEDIUM";
+            case GL_DEBUG_SEVERITY_LOW: return "LOW";
+        }
+        return "NOTIFICATION";
+    }
+
+private:
+    static bool s_Enabled;
+    static bool s_Synchronous;
+    // the callback may come from a driver thread
+    static std::mutex s_Mutex;
+    static std::set<GLuint> s_Ignored;
+    // source, type, id and text of every message seen, and where it is in the ring
+    static std::map<std::tuple<GLenum, GLenum, GLuint, std::string>, int> s_Seen;
+    static Message s_Ring[RING_SIZE];
+    static int s_Written;
+    static int s_Total;
+
+    static int rank(GLenum severity) {
+        switch (severity) {
+            case GL_DEBUG_SEVERITY_HIGH: return 3;
+            case GL_DEBUG_SEVERITY_MEDIUM: return 2;
+            case GL_DEBUG_SEVERITY_LOW: return 1;
+        }
+        return 0;
+    }
+
+    static void APIENTRY callback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                  const GLchar* message, const void* userParam) {
+        std::string text = length >= 0 ? std::string(message, (size_t) length) : std::string(message);
+        while (!text.empty() && (text.back() == '\n' || text.back() == '\r'))
+            text.pop_back();
+        std::string callSite;
+        // asynchronous the callback may run while another GLCALL writes it
+        if (s_Synchronous && glCallSite.File)
+            callSite = std::string(glCallSite.File) + ":" + std::to_string(glCallSite.Line) + " " + glCallSite.Call;
+        {
+            std::lock_guard<std::mutex> lock(s_Mutex);
+            if (s_Ignored.count(id))
+                return;
+            s_Total++;
+            auto key = std::make_tuple(source, type, id, text);
+            auto seen = s_Seen.find(key);
+            if (seen != s_Seen.end()) {
+                // still in the ring unless RING_SIZE newer messages replaced it
+                if (s_Written - seen->second <= RING_SIZE)
+                    s_Ring[seen->second % RING_SIZE].Count++;
+                return;
+            }
+            // messages with addresses or sizes in them are all distinct, forget the ones that
+            // left the ring before the map grows without bound
+            if (s_Seen.size() >= 4 * RING_SIZE)
+                for (auto it = s_Seen.begin(); it != s_Seen.end();)
+                    it = s_Written - it->second > RING_SIZE ? s_Seen.erase(it) : std::next(it);
+            s_Seen[key] = s_Written;
+            s_Ring[s_Written % RING_SIZE] = Message{source, type, id, severity, text, callSite, 1};
+            s_Written++;
+        }
+        std::cout << (type == GL_DEBUG_TYPE_ERROR ? "ERROR" : "WARNING") << "::DEBUG_OUTPUT:: [" << SeverityName(severity)
+                  << " " << SourceName(source) << " " << TypeName(type) << " " << id << "] " << text;
+        if (!callSite.empty())
+            std::cout << "\n    at " << callSite;
+        std::cout << std::endl;
+        if (BreakOnError && type == GL_DEBUG_TYPE_ERROR)
+            BREAK_IF_FALSE(false);
+    }
+};
+
+GLenum DebugOutput::MinSeverity = GL_DEBUG_SEVERITY_LOW;
+bool DebugOutput::BreakOnError = false;
+bool DebugOutput::s_Enabled = false;
+bool DebugOutput::s_Synchronous = false;
+std::mutex DebugOutput::s_Mutex;
+std::set<GLuint> DebugOutput::s_Ignored;
+std::map<std::tuple<GLenum, GLenum, GLuint, std::string>, int> DebugOutput::s_Seen;
+DebugOutput::Message DebugOutput::s_Ring[DebugOutput::RING_SIZE];
+int DebugOutput::s_Written = 0;
+int DebugOutput::s_Total = 0;
+
+}
+#endif //PROJECT_BASE_DEBUGOUTPUT_H
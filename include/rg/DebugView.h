@@ -0,0 +1,122 @@
+#ifndef PROJECT_BASE_DEBUGVIEW_H
+#define PROJECT_BASE_DEBUGVIEW_H
+
+#include <cctype>
+#include <string>
+
+namespace rg {
+
+// Scene debug views, rendered into the offscreen framebuffer instead of the lit scene and
+// shown by framebuffer.fs. Scene fragment shaders include resources/shaders/debug_view.glsl
+// and end with FragColor = debugViewColor(FragColor); Shader::use() keeps their debugView and
+// debugShaderCost uniforms current, Mesh::Draw() sets debugMeshIndex.
+// OVERDRAW and SHADER_COST draw with additive blending onto black, every fragment adds 1 or
+// the cost of its shader to the red channel; framebuffer.fs maps red / Scale() to a heat ramp.
+// MESH_INDEX gives every mesh its own flat colour.
+class DebugView {
+public:
+    enum Mode {
+        NONE,
+        OVERDRAW,
+        SHADER_COST,
+        MESH_INDEX,
+        MODE_COUNT
+    };
+
+    static Mode Current;
+    // value shown at the top of the ramp, in layers and in estimated instructions
+    static float OverdrawScale;
+    static float ShaderCostScale;
+
+    static const char* Name(int mode) {
+        static const char* names[MODE_COUNT] = {"none", "overdraw", "shader cost", "mesh index"};
+        return names[mode];
+    }
+
+    static bool IsActive() {
+        return Current != NONE;
+    }
+
+    static bool IsAdditive() {
+        return Current == OVERDRAW || Current == SHADER_COST;
+    }
+
+    static float Scale() {
+        return Current == SHADER_COST ? ShaderCostScale : OverdrawScale;
+    }
+
+    static int NextMeshIndex() {
+        return s_MeshCount++;
+    }
+
+    // GL has no way to ask a driver for the compiled instruction count, so the cost is
+    // counted in the source: every operator and function call is one instruction, a texture
+    // sample TEXTURE_COST. Branches and loops count once, code in unused functions counts
+    // too; good enough to rank the materials against each other.
+    static float EstimateCost(const std::string& source) {
+        static const float TEXTURE_COST = 4.0f;
+        std::string code = stripComments(source);
+        // skip the declarations, the cost is in the functions
+        size_t body = code.find('{');
+        float cost = 0.0f;
+        for (size_t i = body == std::string::npos ? code.size() : body; i < code.size(); i++) {
+            char c = code[i];
+            if (std::isalpha((unsigned char) c) || c == '_') {
+                size_t end = i;
+                while (end < code.size() && (std::isalnum((unsigned char) code[end]) || code[end] == '_'))
+                    end++;
+                std::string word = code.substr(i, end - i);
+                size_t next = code.find_first_not_of(" \t\r\n", end);
+                if (next != std::string::npos && code[next] == '(' && !isKeyword(word))
+                    cost += word.compare(0, 7, "texture") == 0 ? TEXTURE_COST : 1.0f;
+                i = end - 1;
+            } else if (c == '+' || c == '-' || c == '*' || c == '/') {
+                cost += 1.0f;
+                // ++, +=, ...
+                if (i + 1 < code.size() && (code[i + 1] == c || code[i + 1] == '='))
+                    i++;
+            }
+        }
+        return cost;
+    }
+
+private:
+    static int s_MeshCount;
+
+    // control flow and constructors look like calls but are not
+    static bool isKeyword(const std::string& word) {
+        static const char* keywords[] = {"if", "for", "while", "return", "float", "int", "bool", "vec2", "vec3",
+                                         "vec4", "ivec2", "ivec3", "ivec4", "mat3", "mat4", "main"};
+        for (const char* keyword : keywords)
+            if (word == keyword)
+                return true;
+        return false;
+    }
+
+    static std::string stripComments(const std::string& source) {
+        std::string code;
+        for (size_t i = 0; i < source.size(); i++) {
+            if (source.compare(i, 2, "//") == 0) {
+                i = source.find('\n', i);
+                if (i == std::string::npos)
+                    break;
+            } else if (source.compare(i, 2, "/*") == 0) {
+                i = source.find("*/", i);
+                if (i == std::string::npos)
+                    break;
+                i++;
+                continue;
+            }
+            code += source[i];
+        }
+        return code;
+    }
+};
+
+DebugView::Mode DebugView::Current = DebugView::NONE;
+float DebugView::OverdrawScale = 8.0f;
+float DebugView::ShaderCostScale = 400.0f;
+int DebugView::s_MeshCount = 0;
+
+}
+#endif //PROJECT_BASE_DEBUGVIEW_H
@@ -0,0 +1,295 @@
+#ifndef PROJECT_BASE_DRAWCOUNTER_H
+#define PROJECT_BASE_DRAWCOUNTER_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+#include <map>
+#include <string>
+
+#include <rg/GLExt.h>
+
+namespace rg {
+
+// Counts what a frame submits without touching the code that submits it: Install() swaps the
+// glad and rg::GLExt entry points for wrappers that count and forward.
+//  - draw calls, a multi-draw counts once, it is one call for the driver,
+//  - triangles of direct draws (indirect draws are built on the GPU, their count is unknown here),
+//  - texture binds, program switches (glUseProgram of another program) and uniform updates.
+// Counts go to the frame, to the frame graph pass between BeginPass() and EndPass() and to the
+// model inside a ModelScope. Reset() at the start of every frame keeps the finished frame for
+// LastFrame() and checks it against Budget: a counter over a non-zero budget is logged and the
+// frame counted in OverBudgetFrames(). Benchmark::CompareBaseline() catches rises without a budget.
+// Install once, after loadGLExtensions.
+class DrawCounter {
+public:
+    enum Counter {
+        DRAW_CALLS,
+        TRIANGLES,
+        TEXTURE_BINDS,
+        PROGRAM_SWITCHES,
+        UNIFORM_UPDATES,
+        COUNTER_COUNT
+    };
+
+    struct Counters {
+        unsigned int Values[COUNTER_COUNT] = {};
+
+        void Add(const Counters& other) {
+            for (int i = 0; i < COUNTER_COUNT; i++)
+                Values[i] += other.Values[i];
+        }
+    };
+
+    static const char* Name(int counter) {
+        static const char* names[COUNTER_COUNT] = {"draw_calls", "triangles", "texture_binds", "program_switches", "uniform_updates"};
+        return names[counter];
+    }
+
+    // 0 is no budget
+    static Counters Budget;
+
+    // sets the model counts go to until the scope ends, scopes nest
+    class ModelScope {
+    public:
+        explicit ModelScope(const std::string& model)
+            : m_Previous(s_Model) {
+            s_Model = &s_Models[model];
+        }
+
+        ~ModelScope() {
+            s_Model = m_Previous;
+        }
+
+        ModelScope(const ModelScope&) = delete;
+        ModelScope& operator=(const ModelScope&) = delete;
+
+    private:
+        Counters* m_Previous;
+    };
+
+    static void Install() {
+        if (s_DrawArrays)
+            return;
+        s_DrawArrays = glad_glDrawArrays;
+        s_DrawElements = glad_glDrawElements;
+        s_DrawArraysInstanced = glad_glDrawArraysInstanced;
+        s_DrawElementsInstanced = glad_glDrawElementsInstanced;
+        s_UseProgram = glad_glUseProgram;
+        glad_glDrawArrays = drawArrays;
+        glad_glDrawElements = drawElements;
+        glad_glDrawArraysInstanced = drawArraysInstanced;
+        glad_glDrawElementsInstanced = drawElementsInstanced;
+        glad_glUseProgram = useProgram;
+        if (rg_glDrawArraysIndirect)
+            Counted<decltype(rg_glDrawArraysIndirect), &rg_glDrawArraysIndirect, DRAW_CALLS>::Install();
+        if (rg_glMultiDrawElementsIndirect)
+            Counted<decltype(rg_glMultiDrawElementsIndirect), &rg_glMultiDrawElementsIndirect, DRAW_CALLS>::Install();
+        if (rg_glMultiDrawElementsIndirectCount)
+            Counted<decltype(rg_glMultiDrawElementsIndirectCount), &rg_glMultiDrawElementsIndirectCount, DRAW_CALLS>::Install();
+        Counted<decltype(glad_glBindTexture), &glad_glBindTexture, TEXTURE_BINDS>::Install();
+        if (rg_glBindImageTexture)
+            Counted<decltype(rg_glBindImageTexture), &rg_glBindImageTexture, TEXTURE_BINDS>::Install();
+        Counted<decltype(glad_glUniform1i), &glad_glUniform1i, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform2i), &glad_glUniform2i, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform1ui), &glad_glUniform1ui, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform1f), &glad_glUniform1f, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform2f), &glad_glUniform2f, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform3f), &glad_glUniform3f, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform4f), &glad_glUniform4f, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform1fv), &glad_glUniform1fv, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform2fv), &glad_glUniform2fv, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform3fv), &glad_glUniform3fv, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniform4fv), &glad_glUniform4fv, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniformMatrix2fv), &glad_glUniformMatrix2fv, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniformMatrix3fv), &glad_glUniformMatrix3fv, UNIFORM_UPDATES>::Install();
+        Counted<decltype(glad_glUniformMatrix4fv), &glad_glUniformMatrix4fv, UNIFORM_UPDATES>::Install();
+    }
+
+    // call at the start of every frame
+    static void Reset() {
+        s_LastFrame = s_Frame;
+        s_LastPasses = s_Passes;
+        s_LastModels = s_Models;
+        checkBudget();
+
+        // the scope pointers point into the maps, only the values are cleared
+        s_Frame = Counters();
+        for (auto& pass : s_Passes)
+            pass.second = Counters();
+        for (auto& model : s_Models)
+            model.second = Counters();
+    }
+
+    // frame graph passes, see FrameGraph::Execute
+    static void BeginPass(const std::string& pass) {
+        s_Pass = &s_Passes[pass];
+    }
+
+    static void EndPass() {
+        s_Pass = nullptr;
+    }
+
+    // the frame so far, what the benchmark records at the end of a frame
+    static const Counters& Frame() {
+        return s_Frame;
+    }
+
+    static const std::map<std::string, Counters>& Passes() {
+        return s_Passes;
+    }
+
+    static const std::map<std::string, Counters>& Models() {
+        return s_Models;
+    }
+
+    // the frame before, complete, for display
+    static const Counters& LastFrame() {
+        return s_LastFrame;
+    }
+
+    static const std::map<std::string, Counters>& LastPasses() {
+        return s_LastPasses;
+    }
+
+    static const std::map<std::string, Counters>& LastModels() {
+        return s_LastModels;
+    }
+
+    // bit i set when counter i is over its budget
+    static unsigned int OverBudget(const Counters& counters) {
+        unsigned int over = 0;
+        for (int i = 0; i < COUNTER_COUNT; i++)
+            if (Budget.Values[i] > 0 && counters.Values[i] > Budget.Values[i])
+                over |= 1u << i;
+        return over;
+    }
+
+    static int OverBudgetFrames() {
+        return s_OverBudgetFrames;
+    }
+
+private:
+    static Counters s_Frame;
+    static Counters* s_Pass;
+    static Counters* s_Model;
+    static std::map<std::string, Counters> s_Passes;
+    static std::map<std::string, Counters> s_Models;
+    static Counters s_LastFrame;
+    static std::map<std::string, Counters> s_LastPasses;
+    static std::map<std::string, Counters> s_LastModels;
+    static int s_OverBudgetFrames;
+    // the program bound now, kept across frames so the first glUseProgram of a frame is only a
+    // switch if it binds another one
+    static unsigned int s_Program;
+
+    static PFNGLDRAWARRAYSPROC s_DrawArrays;
+    static PFNGLDRAWELEMENTSPROC s_DrawElements;
+    static PFNGLDRAWARRAYSINSTANCEDPROC s_DrawArraysInstanced;
+    static PFNGLDRAWELEMENTSINSTANCEDPROC s_DrawElementsInstanced;
+    static PFNGLUSEPROGRAMPROC s_UseProgram;
+
+    static void count(int counter, unsigned int amount = 1) {
+        s_Frame.Values[counter] += amount;
+        if (s_Pass)
+            s_Pass->Values[counter] += amount;
+        if (s_Model)
+            s_Model->Values[counter] += amount;
+    }
+
+    // Forwards to what was in Slot before Install() and counts one Kind per call. One
+    // instantiation per entry point, the signature comes from the pointer type.
+    template <typename Pointer, Pointer* Slot, int Kind>
+    struct Counted;
+
+    template <typename R, typename... Args, R (APIENTRYP* Slot)(Args...), int Kind>
+    struct Counted<R (APIENTRYP)(Args...), Slot, Kind> {
+        static R (APIENTRYP Original)(Args...);
+
+        static R APIENTRY Call(Args... args) {
+            count(Kind);
+            return Original(args...);
+        }
+
+        static void Install() {
+            Original = *Slot;
+            *Slot = Call;
+        }
+    };
+
+    static unsigned int triangles(GLenum mode, GLsizei count, GLsizei instances) {
+        if (mode == GL_TRIANGLES)
+            return (unsigned int) (count / 3 * instances);
+        if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count > 2)
+            return (unsigned int) ((count - 2) * instances);
+        return 0;
+    }
+
+    static void APIENTRY drawArrays(GLenum mode, GLint first, GLsizei count) {
+        DrawCounter::count(DRAW_CALLS);
+        DrawCounter::count(TRIANGLES, triangles(mode, count, 1));
+        s_DrawArrays(mode, first, count);
+    }
+
+    static void APIENTRY drawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+        DrawCounter::count(DRAW_CALLS);
+        DrawCounter::count(TRIANGLES, triangles(mode, count, 1));
+        s_DrawElements(mode, count, type, indices);
+    }
+
+    static void APIENTRY drawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances) {
+        DrawCounter::count(DRAW_CALLS);
+        DrawCounter::count(TRIANGLES, triangles(mode, count, instances));
+        s_DrawArraysInstanced(mode, first, count, instances);
+    }
+
+    static void APIENTRY drawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instances) {
+        DrawCounter::count(DRAW_CALLS);
+        DrawCounter::count(TRIANGLES, triangles(mode, count, instances));
+        s_DrawElementsInstanced(mode, count, type, indices, instances);
+    }
+
+    // the driver skips a redundant glUseProgram, so only a change is a switch
+    static void APIENTRY useProgram(GLuint program) {
+        if (program != s_Program)
+            count(PROGRAM_SWITCHES);
+        s_Program = program;
+        s_UseProgram(program);
+    }
+
+    static void checkBudget() {
+        unsigned int over = OverBudget(s_LastFrame);
+        if (!over)
+            return;
+        // the first frame over budget and then one in a hundred, not a line every frame
+        if (s_OverBudgetFrames % 100 == 0)
+            for (int i = 0; i < COUNTER_COUNT; i++)
+                if (over & (1u << i))
+                    std::cout << "WARNING::DRAW_COUNTER:: " << Name(i) << " " << s_LastFrame.Values[i]
+                              << " over the budget of " << Budget.Values[i] << std::endl;
+        s_OverBudgetFrames++;
+    }
+};
+
+template <typename R, typename... Args, R (APIENTRYP* Slot)(Args...), int Kind>
+R (APIENTRYP DrawCounter::Counted<R (APIENTRYP)(Args...), Slot, Kind>::Original)(Args...) = nullptr;
+
+DrawCounter::Counters DrawCounter::Budget;
+DrawCounter::Counters DrawCounter::s_Frame;
+DrawCounter::Counters* DrawCounter::s_Pass = nullptr;
+DrawCounter::Counters* DrawCounter::s_Model = nullptr;
+std::map<std::string, DrawCounter::Counters> DrawCounter::s_Passes;
+std::map<std::string, DrawCounter::Counters> DrawCounter::s_Models;
+DrawCounter::Counters DrawCounter::s_LastFrame;
+std::map<std::string, DrawCounter::Counters> DrawCounter::s_LastPasses;
+std::map<std::string, DrawCounter::Counters> DrawCounter::s_LastModels;
+int DrawCounter::s_OverBudgetFrames = 0;
+unsigned int DrawCounter::s_Program = 0;
+PFNGLDRAWARRAYSPROC DrawCounter::s_DrawArrays = NULL;
+PFNGLDRAWELEMENTSPROC DrawCounter::s_DrawElements = NULL;
+PFNGLDRAWARRAYSINSTANCEDPROC DrawCounter::s_DrawArraysInstanced = NULL;
+PFNGLDRAWELEMENTSINSTANCEDPROC DrawCounter::s_DrawElementsInstanced = NULL;
+PFNGLUSEPROGRAMPROC DrawCounter::s_UseProgram = NULL;
+
+}
+#endif //PROJECT_BASE_DRAWCOUNTER_H
@@ -0,0 +1,89 @@
+#ifndef PROJECT_BASE_DYNAMICRESOLUTION_H
+#define PROJECT_BASE_DYNAMICRESOLUTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace rg {
+
+// Picks the resolution scale of the offscreen scene target from the measured GPU frame time.
+// A PID controller drives the rendered pixel count (scale^2) so that the GPU time settles
+// on TargetMs. The integral term holds the operating point, the proportional term reacts
+// to spikes and the derivative term damps the overshoot caused by the query latency.
+class DynamicResolution {
+public:
+    bool Enabled = true;
+    float TargetMs = 1000.0f / 60.0f;
+    float MinScale = 0.5f;
+    float MaxScale = 1.0f;
+    float Kp = 0.3f;
+    float Ki = 0.5f;
+    float Kd = 0.002f;
+    // seconds between log lines, 0 disables logging
+    float LogInterval = 1.0f;
+
+    float Scale = 1.0f;
+
+    // gpuMs is the last measured GPU frame time, deltaTime the CPU frame time in seconds
+    void Update(float gpuMs, float deltaTime) {
+        if (!Enabled) {
+            Scale = MaxScale;
+            m_Integral = MaxScale * MaxScale;
+            m_PreviousError = 0.0f;
+            return;
+        }
+        if (gpuMs <= 0.0f || deltaTime <= 0.0f)
+            return;
+
+        // smooth the measurement a bit, single frame spikes should not change the resolution
+        m_FilteredMs = m_FilteredMs > 0.0f ? m_FilteredMs + 0.2f * (gpuMs - m_FilteredMs) : gpuMs;
+
+        // relative error, positive when there is headroom left in the budget
+        float error = (TargetMs - m_FilteredMs) / TargetMs;
+        error = std::max(-1.0f, std::min(1.0f, error));
+        float derivative = (error - m_PreviousError) / deltaTime;
+        m_PreviousError = error;
+
+        // GPU cost is roughly linear in the number of pixels, so the controller works on the area
+        float minArea = MinScale * MinScale;
+        float maxArea = MaxScale * MaxScale;
+        // the integral is kept in area units so retuning Ki does not make the scale jump
+        m_Integral += Ki * error * deltaTime;
+        // anti-windup, the integral alone never leaves the allowed range
+        m_Integral = std::max(minArea, std::min(maxArea, m_Integral));
+
+        float area = Kp * error + m_Integral + Kd * derivative;
+        area = std::max(minArea, std::min(maxArea, area));
+        Scale = std::sqrt(area);
+
+        m_LogTimer += deltaTime;
+    }
+
+    unsigned int ScaledSize(unsigned int fullSize) const {
+        return std::max(1u, (unsigned int) std::lround(fullSize * Scale));
+    }
+
+    void Log(unsigned int fullWidth, unsigned int fullHeight) {
+        if (!Enabled || LogInterval <= 0.0f || m_LogTimer < LogInterval)
+            return;
+        m_LogTimer = 0.0f;
+        std::cout << "[DynamicResolution] scale " << Scale
+                  << " (" << ScaledSize(fullWidth) << "x" << ScaledSize(fullHeight) << ")"
+                  << ", gpu " << m_FilteredMs << " ms / budget " << TargetMs << " ms" << std::endl;
+    }
+
+    float FilteredMs() const {
+        return m_FilteredMs;
+    }
+
+private:
+    // starts at the full resolution operating point
+    float m_Integral = 1.0f;
+    float m_PreviousError = 0.0f;
+    float m_FilteredMs = 0.0f;
+    float m_LogTimer = 0.0f;
+};
+
+}
+#endif //PROJECT_BASE_DYNAMICRESOLUTION_H
@@ -11,12 +11,39 @@
 #define LOG(stream) stream << "[" << __FILE__ << ", " << __func__ << ", " << __LINE__ << "] "
 #define BREAK_IF_FALSE(x) if (!(x)) __builtin_trap()
 #define ASSERT(x, msg) do { if (!(x)) { std::cerr << msg << '\n'; BREAK_IF_FALSE(false); } } while(0)
+// GLCALL is chosen at compile time, there is no branch per call. By default it is just the
+// call and errors come from rg::DebugOutput, which main enables wherever the driver has it.
+// RG_GL_ERROR_POLL polls glGetError before and after the call, which waits for the driver,
+// for drivers without debug output. RG_GL_CALL_SITES remembers the call so synchronous debug
+// output can name it.
+#if defined(RG_GL_ERROR_POLL)
 #define GLCALL(x) \
-do{ rg::clearAllOpenGlErrors(); x; BREAK_IF_FALSE(rg::wasPreviousOpenGLCallSuccessful(__FILE__, __LINE__, #x)); } while (0)
+do { \
+    rg::clearAllOpenGlErrors(); x; BREAK_IF_FALSE(rg::wasPreviousOpenGLCallSuccessful(__FILE__, __LINE__, #x)); \
+} while (0)
+#define RG_GLCALL_MODE "GLCALL polls glGetError"
+#elif defined(RG_GL_CALL_SITES)
+#define GLCALL(x) \
+do { \
+    rg::glCallSite = rg::GLCallSite{__FILE__, __LINE__, #x}; x; rg::glCallSite = rg::GLCallSite(); \
+} while (0)
+#define RG_GLCALL_MODE "GLCALL names its call site"
+#else
+#define GLCALL(x) do { x; } while (0)
+#define RG_GLCALL_MODE "GLCALL does not poll"
+#endif
 
 namespace rg {
 
-    
+struct GLCallSite {
+    const char* File = nullptr;
+    int Line = 0;
+    const char* Call = nullptr;
+};
+
+// the GLCALL running with RG_GL_CALL_SITES, File is null outside of one
+GLCallSite glCallSite;
+
 void clearAllOpenGlErrors();
 const char* openGLErrorToString(GLenum error);
 bool wasPreviousOpenGLCallSuccessful(const char* file, int line, const char* call);
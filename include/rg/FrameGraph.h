@@ -0,0 +1,559 @@
+#ifndef PROJECT_BASE_FRAMEGRAPH_H
+#define PROJECT_BASE_FRAMEGRAPH_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include <rg/Error.h>
+#include <rg/DrawCounter.h>
+#include <rg/GpuProfiler.h>
+#include <rg/MemoryTracker.h>
+#include <rg/PipelineStatistics.h>
+
+namespace rg {
+
+// handle of a texture (or an imported buffer) inside one frame of the graph, -1 is "no resource"
+typedef int FrameGraphResource;
+
+struct FrameGraphTextureDesc {
+    unsigned int Width = 0;
+    unsigned int Height = 0;
+    GLenum InternalFormat = GL_RGBA8;
+    GLenum Filter = GL_LINEAR;
+
+    FrameGraphTextureDesc() = default;
+    FrameGraphTextureDesc(unsigned int width, unsigned int height, GLenum internalFormat, GLenum filter = GL_LINEAR)
+            : Width(width), Height(height), InternalFormat(internalFormat), Filter(filter) {}
+
+    bool operator==(const FrameGraphTextureDesc& other) const {
+        return Width == other.Width && Height == other.Height
+               && InternalFormat == other.InternalFormat && Filter == other.Filter;
+    }
+
+    bool IsDepth() const {
+        return InternalFormat == GL_DEPTH24_STENCIL8 || InternalFormat == GL_DEPTH_COMPONENT24
+               || InternalFormat == GL_DEPTH_COMPONENT32F;
+    }
+
+    size_t Bytes() const {
+        return (size_t) Width * Height * BytesPerPixel(InternalFormat);
+    }
+
+    static size_t BytesPerPixel(GLenum internalFormat) {
+        switch (internalFormat) {
+            case GL_R8: return 1;
+            case GL_R16F: case GL_RG8: return 2;
+            case GL_RGB16F: return 6;
+            case GL_RGBA8: case GL_R32F: case GL_RG16F: case GL_R11F_G11F_B10F:
+            case GL_DEPTH24_STENCIL8: case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32F: return 4;
+            case GL_RGBA16F: case GL_RG32F: return 8;
+            case GL_RGBA32F: return 16;
+        }
+        ASSERT(false, "Unknown frame graph texture format");
+        return 0;
+    }
+};
+
+// Render passes declare which textures they create, read and write. Every frame the graph is
+// rebuilt, compiled and executed:
+//  - passes whose outputs never reach an imported texture (or the backbuffer) are culled,
+//  - the remaining passes are ordered topologically from their read/write dependencies,
+//  - transient textures are taken from a pool when first used and given back after their last
+//    use, so textures with non-overlapping lifetimes share the same GL texture,
+//  - before a pass runs its attachments are bound to a cached FBO and the viewport is set.
+class FrameGraph {
+public:
+    typedef std::function<void(const FrameGraph&)> ExecuteFunction;
+
+private:
+    struct Resource {
+        std::string Name;
+        FrameGraphTextureDesc Desc;
+        unsigned int Texture = 0;
+        bool Imported = false;
+        bool Buffer = false;
+        int FirstUse = -1;
+        int LastUse = -1;
+    };
+
+    struct Pass {
+        std::string Name;
+        ExecuteFunction Execute;
+        std::vector<FrameGraphResource> Reads;
+        std::vector<FrameGraphResource> Writes;
+        std::vector<FrameGraphResource> ColorAttachments;
+        FrameGraphResource DepthAttachment = -1;
+        unsigned int ViewportWidth = 0;
+        unsigned int ViewportHeight = 0;
+        bool HasSideEffect = false;
+        bool Culled = false;
+    };
+
+public:
+    class Builder {
+    public:
+        FrameGraphResource Create(const std::string& name, const FrameGraphTextureDesc& desc) {
+            return m_Graph.createResource(name, desc, 0, false);
+        }
+        // sampled by the pass
+        FrameGraphResource Read(FrameGraphResource resource) {
+            addUnique(pass().Reads, resource);
+            return resource;
+        }
+        // bound as the next color attachment, previous contents are kept
+        FrameGraphResource Write(FrameGraphResource resource) {
+            addUnique(pass().Writes, resource);
+            ASSERT(!m_Graph.m_Resources[resource].Buffer, "Buffers can not be attached");
+            pass().ColorAttachments.push_back(resource);
+            return resource;
+        }
+        // bound as the depth(-stencil) attachment and written
+        FrameGraphResource WriteDepth(FrameGraphResource resource) {
+            addUnique(pass().Writes, resource);
+            pass().DepthAttachment = resource;
+            return resource;
+        }
+        // bound as the depth(-stencil) attachment for testing only, depth writes have to be masked by the pass
+        FrameGraphResource ReadDepth(FrameGraphResource resource) {
+            addUnique(pass().Reads, resource);
+            pass().DepthAttachment = resource;
+            return resource;
+        }
+        // written through image stores or other means that need no framebuffer (compute passes)
+        FrameGraphResource WriteImage(FrameGraphResource resource) {
+            addUnique(pass().Writes, resource);
+            return resource;
+        }
+        // the pass changes state outside of the graph and must never be culled
+        void SideEffect() {
+            pass().HasSideEffect = true;
+        }
+        // overrides the viewport, by default it covers the first attachment
+        void SetViewport(unsigned int width, unsigned int height) {
+            pass().ViewportWidth = width;
+            pass().ViewportHeight = height;
+        }
+
+    private:
+        friend class FrameGraph;
+        FrameGraph& m_Graph;
+        int m_PassIndex;
+
+        Builder(FrameGraph& graph, int passIndex) : m_Graph(graph), m_PassIndex(passIndex) {}
+
+        Pass& pass() {
+            return m_Graph.m_Passes[m_PassIndex];
+        }
+
+        static void addUnique(std::vector<FrameGraphResource>& list, FrameGraphResource resource) {
+            ASSERT(resource >= 0, "Invalid frame graph resource");
+            if (std::find(list.begin(), list.end(), resource) == list.end())
+                list.push_back(resource);
+        }
+    };
+
+    FrameGraph() = default;
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    ~FrameGraph() {
+        releaseFramebuffers();
+        for (PooledTexture& texture : m_Pool)
+            glDeleteTextures(1, &texture.Id);
+    }
+
+    void AddPass(const std::string& name, const std::function<void(Builder&)>& setup, const ExecuteFunction& execute) {
+        m_Passes.push_back(Pass());
+        m_Passes.back().Name = name;
+        m_Passes.back().Execute = execute;
+        Builder builder(*this, (int) m_Passes.size() - 1);
+        setup(builder);
+    }
+
+    // a texture owned outside of the graph, e.g. history buffers that live across frames
+    FrameGraphResource Import(const std::string& name, unsigned int texture, const FrameGraphTextureDesc& desc) {
+        return createResource(name, desc, texture, true);
+    }
+
+    // A buffer owned outside of the graph. Passes order themselves on it with Read and
+    // WriteImage like on a texture, it is never attached to a framebuffer.
+    FrameGraphResource ImportBuffer(const std::string& name, unsigned int buffer) {
+        FrameGraphResource resource = createResource(name, FrameGraphTextureDesc(), buffer, true);
+        m_Resources[resource].Buffer = true;
+        return resource;
+    }
+
+    // the default framebuffer, passes writing to it bind FBO 0 (or framebuffer, an FBO that
+    // stands in for it when there is no window)
+    FrameGraphResource ImportBackbuffer(unsigned int width, unsigned int height, unsigned int framebuffer = 0) {
+        m_Backbuffer = createResource("backbuffer", FrameGraphTextureDesc(width, height, GL_RGBA8), 0, true);
+        m_BackbufferFramebuffer = framebuffer;
+        return m_Backbuffer;
+    }
+
+    void Compile() {
+        cullPasses();
+        sortPasses();
+        assignTextures();
+    }
+
+    // every executed pass becomes a profiler zone of its name, nullptr stops that. The draw
+    // counters always count per pass.
+    void SetProfiler(GpuProfiler* profiler) {
+        m_Profiler = profiler;
+    }
+
+    // pipeline statistics of every executed pass, nullptr stops that
+    void SetPipelineStatistics(PipelineStatistics* statistics) {
+        m_Statistics = statistics;
+    }
+
+    void Execute() {
+        for (int passIndex : m_Order) {
+            Pass& pass = m_Passes[passIndex];
+            int zone = m_Profiler ? m_Profiler->Push(pass.Name) : -1;
+            DrawCounter::BeginPass(pass.Name);
+            MemoryTracker::Scope memoryScope(pass.Name);
+            bindAttachments(pass);
+            if (m_Statistics)
+                m_Statistics->Begin(pass.Name, zone);
+            if (pass.Execute)
+                pass.Execute(*this);
+            if (m_Statistics)
+                m_Statistics->End();
+            DrawCounter::EndPass();
+            if (m_Profiler)
+                m_Profiler->Pop();
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, m_BackbufferFramebuffer);
+    }
+
+    // forgets the passes and resources of the frame, pooled textures and FBOs are kept
+    void Reset() {
+        m_Passes.clear();
+        m_Resources.clear();
+        m_Order.clear();
+        m_Backbuffer = -1;
+        m_Frame++;
+        collectGarbage();
+    }
+
+    unsigned int GetTexture(FrameGraphResource resource) const {
+        ASSERT(resource >= 0 && resource < (int) m_Resources.size(), "Invalid frame graph resource");
+        return m_Resources[resource].Texture;
+    }
+
+    unsigned int GetBuffer(FrameGraphResource resource) const {
+        ASSERT(resource >= 0 && resource < (int) m_Resources.size() && m_Resources[resource].Buffer,
+               "Invalid frame graph buffer");
+        return m_Resources[resource].Texture;
+    }
+
+    const FrameGraphTextureDesc& GetDesc(FrameGraphResource resource) const {
+        ASSERT(resource >= 0 && resource < (int) m_Resources.size(), "Invalid frame graph resource");
+        return m_Resources[resource].Desc;
+    }
+
+    // statistics of the last compiled frame, for the debug window
+    struct Stats {
+        std::vector<std::string> ExecutedPasses;
+        std::vector<std::string> CulledPasses;
+        size_t TransientBytes = 0; // what the transient textures would take without aliasing
+        size_t PooledBytes = 0;    // what the pool actually holds
+        int TransientTextures = 0;
+        int PooledTextures = 0;
+    };
+
+    const Stats& GetStats() const {
+        return m_Stats;
+    }
+
+private:
+    struct PooledTexture {
+        unsigned int Id = 0;
+        FrameGraphTextureDesc Desc;
+        bool InUse = false;
+        unsigned int LastFrame = 0;
+    };
+
+    // pooled textures unused for this many frames are deleted
+    static const unsigned int POOL_LIFETIME = 120;
+
+    std::vector<Pass> m_Passes;
+    std::vector<Resource> m_Resources;
+    std::vector<int> m_Order;
+    std::vector<PooledTexture> m_Pool;
+    std::map<std::vector<unsigned int>, unsigned int> m_Framebuffers;
+    FrameGraphResource m_Backbuffer = -1;
+    unsigned int m_BackbufferFramebuffer = 0;
+    GpuProfiler* m_Profiler = nullptr;
+    PipelineStatistics* m_Statistics = nullptr;
+    unsigned int m_Frame = 0;
+    Stats m_Stats;
+
+    FrameGraphResource createResource(const std::string& name, const FrameGraphTextureDesc& desc, unsigned int texture, bool imported) {
+        Resource resource;
+        resource.Name = name;
+        resource.Desc = desc;
+        resource.Texture = texture;
+        resource.Imported = imported;
+        m_Resources.push_back(resource);
+        return (FrameGraphResource) m_Resources.size() - 1;
+    }
+
+    // Walks the passes backwards. A pass survives if it has side effects, writes an imported
+    // texture or writes something a surviving pass uses; everything it touches then becomes needed.
+    void cullPasses() {
+        std::vector<bool> needed(m_Resources.size(), false);
+        for (size_t i = 0; i < m_Resources.size(); i++)
+            needed[i] = m_Resources[i].Imported;
+
+        m_Stats.CulledPasses.clear();
+        for (int i = (int) m_Passes.size() - 1; i >= 0; i--) {
+            Pass& pass = m_Passes[i];
+            bool keep = pass.HasSideEffect;
+            for (FrameGraphResource resource : pass.Writes)
+                keep = keep || needed[resource];
+            pass.Culled = !keep;
+            if (!keep) {
+                m_Stats.CulledPasses.push_back(pass.Name);
+                continue;
+            }
+            for (FrameGraphResource resource : pass.Reads)
+                needed[resource] = true;
+            for (FrameGraphResource resource : pass.Writes)
+                needed[resource] = true;
+        }
+    }
+
+    // Kahn's algorithm over the read-after-write, write-after-write and write-after-read edges.
+    // Ties are broken by declaration order, so independent passes run in the order they were added.
+    void sortPasses() {
+        size_t passCount = m_Passes.size();
+        std::vector<std::vector<int>> edges(passCount);
+        std::vector<int> incoming(passCount, 0);
+        std::vector<int> lastWriter(m_Resources.size(), -1);
+        std::vector<std::vector<int>> readersSinceWrite(m_Resources.size());
+
+        auto addEdge = [&](int from, int to) {
+            if (from < 0 || from == to)
+                return;
+            edges[from].push_back(to);
+            incoming[to]++;
+        };
+
+        for (size_t i = 0; i < passCount; i++) {
+            const Pass& pass = m_Passes[i];
+            if (pass.Culled)
+                continue;
+            for (FrameGraphResource resource : pass.Reads) {
+                addEdge(lastWriter[resource], (int) i);
+                readersSinceWrite[resource].push_back((int) i);
+            }
+            for (FrameGraphResource resource : pass.Writes) {
+                addEdge(lastWriter[resource], (int) i);
+                for (int reader : readersSinceWrite[resource])
+                    addEdge(reader, (int) i);
+                readersSinceWrite[resource].clear();
+                lastWriter[resource] = (int) i;
+            }
+        }
+
+        std::priority_queue<int, std::vector<int>, std::greater<int>> ready;
+        for (size_t i = 0; i < passCount; i++)
+            if (!m_Passes[i].Culled && incoming[i] == 0)
+                ready.push((int) i);
+
+        m_Order.clear();
+        while (!ready.empty()) {
+            int pass = ready.top();
+            ready.pop();
+            m_Order.push_back(pass);
+            for (int next : edges[pass])
+                if (--incoming[next] == 0)
+                    ready.push(next);
+        }
+
+        m_Stats.ExecutedPasses.clear();
+        for (int pass : m_Order)
+            m_Stats.ExecutedPasses.push_back(m_Passes[pass].Name);
+    }
+
+    // Simulates the frame in execution order, acquiring each transient texture right before its
+    // first use and releasing it after its last one. A released texture is handed to the next
+    // resource with the same description, that is where the memory saving comes from.
+    void assignTextures() {
+        for (size_t i = 0; i < m_Order.size(); i++) {
+            const Pass& pass = m_Passes[m_Order[i]];
+            for (const std::vector<FrameGraphResource>* list : {&pass.Reads, &pass.Writes}) {
+                for (FrameGraphResource resource : *list) {
+                    if (m_Resources[resource].FirstUse < 0)
+                        m_Resources[resource].FirstUse = (int) i;
+                    m_Resources[resource].LastUse = (int) i;
+                }
+            }
+        }
+
+        m_Stats.TransientBytes = 0;
+        m_Stats.TransientTextures = 0;
+        for (size_t i = 0; i < m_Order.size(); i++) {
+            for (Resource& resource : m_Resources) {
+                if (!resource.Imported && resource.FirstUse == (int) i) {
+                    // a new pooled texture is accounted to the pass that needed it first
+                    MemoryTracker::Scope memoryScope(m_Passes[m_Order[i]].Name);
+                    resource.Texture = acquireTexture(resource.Desc);
+                    m_Stats.TransientBytes += resource.Desc.Bytes();
+                    m_Stats.TransientTextures++;
+                }
+            }
+            for (Resource& resource : m_Resources) {
+                if (!resource.Imported && resource.LastUse == (int) i)
+                    releaseTexture(resource.Texture);
+            }
+        }
+
+        m_Stats.PooledBytes = 0;
+        m_Stats.PooledTextures = (int) m_Pool.size();
+        for (const PooledTexture& texture : m_Pool)
+            m_Stats.PooledBytes += texture.Desc.Bytes();
+    }
+
+    unsigned int acquireTexture(const FrameGraphTextureDesc& desc) {
+        for (PooledTexture& texture : m_Pool) {
+            if (!texture.InUse && texture.Desc == desc) {
+                texture.InUse = true;
+                texture.LastFrame = m_Frame;
+                return texture.Id;
+            }
+        }
+
+        PooledTexture texture;
+        texture.Desc = desc;
+        texture.InUse = true;
+        texture.LastFrame = m_Frame;
+        glGenTextures(1, &texture.Id);
+        glBindTexture(GL_TEXTURE_2D, texture.Id);
+        GLenum format = GL_RGBA, type = GL_UNSIGNED_BYTE;
+        uploadFormat(desc.InternalFormat, format, type);
+        glTexImage2D(GL_TEXTURE_2D, 0, desc.InternalFormat, desc.Width, desc.Height, 0, format, type, NULL);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, desc.Filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, desc.Filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        m_Pool.push_back(texture);
+        return texture.Id;
+    }
+
+    void releaseTexture(unsigned int id) {
+        for (PooledTexture& texture : m_Pool) {
+            if (texture.Id == id) {
+                texture.InUse = false;
+                return;
+            }
+        }
+    }
+
+    void collectGarbage() {
+        bool deleted = false;
+        for (size_t i = 0; i < m_Pool.size();) {
+            if (!m_Pool[i].InUse && m_Frame - m_Pool[i].LastFrame > POOL_LIFETIME) {
+                glDeleteTextures(1, &m_Pool[i].Id);
+                m_Pool.erase(m_Pool.begin() + i);
+                deleted = true;
+            } else {
+                i++;
+            }
+        }
+        // cached FBOs may reference deleted textures
+        if (deleted)
+            releaseFramebuffers();
+    }
+
+    void releaseFramebuffers() {
+        for (auto& entry : m_Framebuffers)
+            glDeleteFramebuffers(1, &entry.second);
+        m_Framebuffers.clear();
+    }
+
+    void bindAttachments(const Pass& pass) {
+        if (pass.ColorAttachments.empty() && pass.DepthAttachment < 0)
+            return;
+
+        unsigned int width = pass.ViewportWidth;
+        unsigned int height = pass.ViewportHeight;
+        FrameGraphResource first = pass.ColorAttachments.empty() ? pass.DepthAttachment : pass.ColorAttachments[0];
+        if (width == 0 || height == 0) {
+            width = m_Resources[first].Desc.Width;
+            height = m_Resources[first].Desc.Height;
+        }
+
+        if (first == m_Backbuffer) {
+            ASSERT(pass.ColorAttachments.size() == 1 && pass.DepthAttachment < 0,
+                   "The backbuffer can not be combined with other attachments");
+            glBindFramebuffer(GL_FRAMEBUFFER, m_BackbufferFramebuffer);
+            glViewport(0, 0, width, height);
+            return;
+        }
+
+        // attachments are cached by texture ids, the depth attachment goes last
+        std::vector<unsigned int> key;
+        for (FrameGraphResource resource : pass.ColorAttachments)
+            key.push_back(m_Resources[resource].Texture);
+        key.push_back(pass.DepthAttachment >= 0 ? m_Resources[pass.DepthAttachment].Texture : 0);
+
+        auto it = m_Framebuffers.find(key);
+        if (it != m_Framebuffers.end()) {
+            glBindFramebuffer(GL_FRAMEBUFFER, it->second);
+        } else {
+            unsigned int fbo;
+            glGenFramebuffers(1, &fbo);
+            glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+            std::vector<GLenum> drawBuffers;
+            for (size_t i = 0; i < pass.ColorAttachments.size(); i++) {
+                glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, key[i], 0);
+                drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+            }
+            if (pass.DepthAttachment >= 0) {
+                GLenum attachment = m_Resources[pass.DepthAttachment].Desc.InternalFormat == GL_DEPTH24_STENCIL8
+                                    ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+                glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, key.back(), 0);
+            }
+            if (drawBuffers.empty()) {
+                glDrawBuffer(GL_NONE);
+            } else {
+                glDrawBuffers((GLsizei) drawBuffers.size(), drawBuffers.data());
+            }
+            GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+            if (status != GL_FRAMEBUFFER_COMPLETE)
+                std::cout << "Framebuffer error in pass " << pass.Name << ": " << status << std::endl;
+            m_Framebuffers[key] = fbo;
+        }
+        glViewport(0, 0, width, height);
+    }
+
+    static void uploadFormat(GLenum internalFormat, GLenum& format, GLenum& type) {
+        switch (internalFormat) {
+            case GL_R8: format = GL_RED; type = GL_UNSIGNED_BYTE; break;
+            case GL_RG8: format = GL_RG; type = GL_UNSIGNED_BYTE; break;
+            case GL_RGBA8: format = GL_RGBA; type = GL_UNSIGNED_BYTE; break;
+            case GL_R16F: case GL_R32F: format = GL_RED; type = GL_FLOAT; break;
+            case GL_RG16F: case GL_RG32F: format = GL_RG; type = GL_FLOAT; break;
+            case GL_RGB16F: case GL_R11F_G11F_B10F: format = GL_RGB; type = GL_FLOAT; break;
+            case GL_RGBA16F: case GL_RGBA32F: format = GL_RGBA; type = GL_FLOAT; break;
+            case GL_DEPTH24_STENCIL8: format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; break;
+            case GL_DEPTH_COMPONENT24: case GL_DEPTH_COMPONENT32F: format = GL_DEPTH_COMPONENT; type = GL_FLOAT; break;
+            default: ASSERT(false, "Unknown frame graph texture format");
+        }
+    }
+};
+
+}
+#endif //PROJECT_BASE_FRAMEGRAPH_H
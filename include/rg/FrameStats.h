@@ -0,0 +1,172 @@
+#ifndef PROJECT_BASE_FRAMESTATS_H
+#define PROJECT_BASE_FRAMESTATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include <rg/DrawCounter.h>
+
+namespace rg {
+
+// Frame, CPU and GPU times of the last RING_SIZE frames, for percentiles and histograms over
+// rolling windows instead of averages that hide stutter. Record() is one store and one atomic
+// increment, the render thread never waits; Last() may run on any thread and drops the samples
+// the writer replaced while it was copying, like rg::CpuProfiler.
+// A frame longer than HitchFactor times the median of the HitchWindow frames before it is a
+// hitch: it is logged with the rg::DrawCounter counters of the frame and kept in Hitches().
+class FrameStats {
+public:
+    static const uint64_t RING_SIZE = 1 << 12;
+    static const int HITCH_HISTORY = 32;
+
+    struct Sample {
+        // wall time since the previous frame
+        float FrameMs;
+        // from the start of the frame to the end of its submission
+        float CpuMs;
+        // rg::GpuTimer result, a few frames behind the other two
+        float GpuMs;
+    };
+
+    struct Summary {
+        float P50;
+        float P95;
+        float P99;
+        float Max;
+        int Count;
+    };
+
+    struct Hitch {
+        uint64_t Frame;
+        Sample Times;
+        float MedianMs;
+        DrawCounter::Counters Counters;
+    };
+
+    float HitchFactor = 2.0f;
+    int HitchWindow = 120;
+    bool LogHitches = true;
+
+    FrameStats() = default;
+
+    FrameStats(const FrameStats&) = delete;
+    FrameStats& operator=(const FrameStats&) = delete;
+
+    // call once per frame, before the next rg::DrawCounter::Reset()
+    void Record(float frameMs, float cpuMs, float gpuMs) {
+        uint64_t count = m_Count.load(std::memory_order_relaxed);
+        Sample sample{frameMs, cpuMs, gpuMs};
+        detectHitch(count, sample);
+        m_Ring[count & (RING_SIZE - 1)] = sample;
+        m_Count.store(count + 1, std::memory_order_release);
+    }
+
+    // frames recorded so far
+    uint64_t Count() const {
+        return m_Count.load(std::memory_order_acquire);
+    }
+
+    // up to the last frames samples, oldest first
+    std::vector<Sample> Last(int frames) const {
+        uint64_t end = m_Count.load(std::memory_order_acquire);
+        uint64_t wanted = std::min<uint64_t>({(uint64_t) std::max(frames, 0), end, RING_SIZE});
+        std::vector<Sample> samples;
+        samples.reserve((size_t) wanted);
+        uint64_t start = end - wanted;
+        for (uint64_t i = start; i < end; i++)
+            samples.push_back(m_Ring[i & (RING_SIZE - 1)]);
+        // the copies above happen before the count is read again
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // at written == start + RING_SIZE the writer may be storing over sample start right now
+        uint64_t written = m_Count.load(std::memory_order_relaxed);
+        if (written >= start + RING_SIZE)
+            samples.erase(samples.begin(), samples.begin() + (size_t) std::min<uint64_t>(wanted, written - RING_SIZE - start + 1));
+        return samples;
+    }
+
+    // nearest rank percentiles of one field over the last frames, as rg::Benchmark reports them
+    Summary Summarize(int frames, float Sample::*field) const {
+        std::vector<float> values = collect(frames, field);
+        std::sort(values.begin(), values.end());
+        Summary summary{0.0f, 0.0f, 0.0f, 0.0f, (int) values.size()};
+        if (values.empty())
+            return summary;
+        summary.P50 = percentile(values, 50.0f);
+        summary.P95 = percentile(values, 95.0f);
+        summary.P99 = percentile(values, 99.0f);
+        summary.Max = values.back();
+        return summary;
+    }
+
+    // frames per bin, bins of maxMs / bins from 0, longer frames in the last bin
+    std::vector<float> Histogram(int frames, float Sample::*field, int bins, float maxMs) const {
+        std::vector<float> histogram((size_t) std::max(bins, 1), 0.0f);
+        for (float value : collect(frames, field)) {
+            int bin = (int) (value / maxMs * histogram.size());
+            histogram[(size_t) std::min(std::max(bin, 0), (int) histogram.size() - 1)] += 1.0f;
+        }
+        return histogram;
+    }
+
+    // the last HITCH_HISTORY hitches, oldest first; render thread only
+    const std::vector<Hitch>& Hitches() const {
+        return m_Hitches;
+    }
+
+    int HitchCount() const {
+        return m_HitchCount;
+    }
+
+private:
+    Sample m_Ring[RING_SIZE];
+    std::atomic<uint64_t> m_Count{0};
+    std::vector<Hitch> m_Hitches;
+    int m_HitchCount = 0;
+    std::vector<float> m_Window;
+
+    std::vector<float> collect(int frames, float Sample::*field) const {
+        std::vector<float> values;
+        for (const Sample& sample : Last(frames))
+            values.push_back(sample.*field);
+        return values;
+    }
+
+    static float percentile(const std::vector<float>& sorted, float p) {
+        size_t rank = (size_t) std::ceil(p / 100.0f * sorted.size());
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    }
+
+    // against the frames before this one, read from the ring on the writing thread
+    void detectHitch(uint64_t count, const Sample& sample) {
+        int window = std::min(std::max(HitchWindow, 1), (int) RING_SIZE);
+        if (count < (uint64_t) window)
+            return;
+        m_Window.clear();
+        for (uint64_t i = count - window; i < count; i++)
+            m_Window.push_back(m_Ring[i & (RING_SIZE - 1)].FrameMs);
+        std::nth_element(m_Window.begin(), m_Window.begin() + window / 2, m_Window.end());
+        float median = m_Window[window / 2];
+        if (median <= 0.0f || sample.FrameMs <= HitchFactor * median)
+            return;
+        Hitch hitch{count, sample, median, DrawCounter::Frame()};
+        m_HitchCount++;
+        if ((int) m_Hitches.size() == HITCH_HISTORY)
+            m_Hitches.erase(m_Hitches.begin());
+        m_Hitches.push_back(hitch);
+        if (!LogHitches)
+            return;
+        std::cout << "WARNING::FRAME_STATS:: Hitch at frame " << count << ": " << sample.FrameMs << " ms, "
+                  << sample.FrameMs / median << "x the " << median << " ms median (CPU " << sample.CpuMs
+                  << " ms, GPU " << sample.GpuMs << " ms)";
+        for (int counter = 0; counter < DrawCounter::COUNTER_COUNT; counter++)
+            std::cout << ", " << DrawCounter::Name(counter) << " " << hitch.Counters.Values[counter];
+        std::cout << std::endl;
+    }
+};
+
+}
+#endif //PROJECT_BASE_FRAMESTATS_H
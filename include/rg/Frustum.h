@@ -0,0 +1,28 @@
+#ifndef PROJECT_BASE_FRUSTUM_H
+#define PROJECT_BASE_FRUSTUM_H
+
+#include <glm/glm.hpp>
+
+namespace rg {
+
+// Gribb and Hartmann: the six planes of viewProjection (left, right, bottom, top, near, far)
+// as (normal, distance) with the normals pointing inwards, normalized so that
+// dot(plane.xyz, p) + plane.w is the signed distance of p.
+inline void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6]) {
+    const glm::mat4& m = viewProjection;
+    glm::vec4 row0(m[0][0], m[1][0], m[2][0], m[3][0]);
+    glm::vec4 row1(m[0][1], m[1][1], m[2][1], m[3][1]);
+    glm::vec4 row2(m[0][2], m[1][2], m[2][2], m[3][2]);
+    glm::vec4 row3(m[0][3], m[1][3], m[2][3], m[3][3]);
+    planes[0] = row3 + row0;
+    planes[1] = row3 - row0;
+    planes[2] = row3 + row1;
+    planes[3] = row3 - row1;
+    planes[4] = row3 + row2;
+    planes[5] = row3 - row2;
+    for (int i = 0; i < 6; i++)
+        planes[i] /= glm::length(glm::vec3(planes[i]));
+}
+
+}
+#endif //PROJECT_BASE_FRUSTUM_H
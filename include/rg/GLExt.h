@@ -0,0 +1,162 @@
+#ifndef PROJECT_BASE_GLEXT_H
+#define PROJECT_BASE_GLEXT_H
+
+#include <glad/glad.h>
+
+#include <cstring>
+
+// The bundled glad loader only covers core 3.3. Entry points and enums from newer versions
+// are loaded here by hand after gladLoadGLLoader, under the usual gl* names, so code on the
+// 4.3 path reads the same as the rest. Check the rg::GLExt flags before calling any of them.
+
+#ifndef GL_COMPUTE_SHADER
+#define GL_COMPUTE_SHADER 0x91B9
+#define GL_TEXTURE_FETCH_BARRIER_BIT 0x00000008
+#define GL_SHADER_IMAGE_ACCESS_BARRIER_BIT 0x00000020
+#define GL_SHADER_STORAGE_BUFFER 0x90D2
+#define GL_SHADER_STORAGE_BARRIER_BIT 0x00002000
+#endif
+
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#define GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT 0x00000001
+#define GL_COMMAND_BARRIER_BIT 0x00000040
+#endif
+
+#ifndef GL_BUFFER_UPDATE_BARRIER_BIT
+#define GL_BUFFER_UPDATE_BARRIER_BIT 0x00000200
+#endif
+
+#ifndef GL_PARAMETER_BUFFER
+#define GL_PARAMETER_BUFFER 0x80EE
+#endif
+
+#ifndef GL_DEBUG_OUTPUT
+#define GL_DEBUG_OUTPUT 0x92E0
+#define GL_DEBUG_OUTPUT_SYNCHRONOUS 0x8242
+#define GL_CONTEXT_FLAG_DEBUG_BIT 0x00000002
+#define GL_DEBUG_SOURCE_API 0x8246
+#define GL_DEBUG_SOURCE_WINDOW_SYSTEM 0x8247
+#define GL_DEBUG_SOURCE_SHADER_COMPILER 0x8248
+#define GL_DEBUG_SOURCE_THIRD_PARTY 0x8249
+#define GL_DEBUG_SOURCE_APPLICATION 0x824A
+#define GL_DEBUG_SOURCE_OTHER 0x824B
+#define GL_DEBUG_TYPE_ERROR 0x824C
+#define GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR 0x824D
+#define GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR 0x824E
+#define GL_DEBUG_TYPE_PORTABILITY 0x824F
+#define GL_DEBUG_TYPE_PERFORMANCE 0x8250
+#define GL_DEBUG_TYPE_OTHER 0x8251
+#define GL_DEBUG_TYPE_MARKER 0x8268
+#define GL_DEBUG_TYPE_PUSH_GROUP 0x8269
+#define GL_DEBUG_TYPE_POP_GROUP 0x826A
+#define GL_DEBUG_SEVERITY_NOTIFICATION 0x826B
+#define GL_DEBUG_SEVERITY_HIGH 0x9146
+#define GL_DEBUG_SEVERITY_MEDIUM 0x9147
+#define GL_DEBUG_SEVERITY_LOW 0x9148
+#endif
+
+#ifndef GL_VERTEX_SHADER_INVOCATIONS
+#define GL_VERTEX_SHADER_INVOCATIONS 0x82F0
+#define GL_FRAGMENT_SHADER_INVOCATIONS 0x82F4
+#define GL_CLIPPING_INPUT_PRIMITIVES 0x82F6
+#define GL_CLIPPING_OUTPUT_PRIMITIVES 0x82F7
+#endif
+
+typedef void (APIENTRYP PFNGLDISPATCHCOMPUTEPROC)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+typedef void (APIENTRYP PFNGLMEMORYBARRIERPROC)(GLbitfield barriers);
+typedef void (APIENTRYP PFNGLBINDIMAGETEXTUREPROC)(GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format);
+typedef void (APIENTRYP PFNGLDRAWARRAYSINDIRECTPROC)(GLenum mode, const void *indirect);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTPROC)(GLenum mode, GLenum type, const void *indirect, GLsizei drawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC)(GLenum mode, GLenum type, const void *indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECALLBACKPROC)(GLDEBUGPROC callback, const void *userParam);
+typedef void (APIENTRYP PFNGLDEBUGMESSAGECONTROLPROC)(GLenum source, GLenum type, GLenum severity, GLsizei count, const GLuint *ids, GLboolean enabled);
+
+PFNGLDISPATCHCOMPUTEPROC rg_glDispatchCompute = NULL;
+PFNGLMEMORYBARRIERPROC rg_glMemoryBarrier = NULL;
+PFNGLBINDIMAGETEXTUREPROC rg_glBindImageTexture = NULL;
+PFNGLDRAWARRAYSINDIRECTPROC rg_glDrawArraysIndirect = NULL;
+PFNGLMULTIDRAWELEMENTSINDIRECTPROC rg_glMultiDrawElementsIndirect = NULL;
+PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC rg_glMultiDrawElementsIndirectCount = NULL;
+PFNGLDEBUGMESSAGECALLBACKPROC rg_glDebugMessageCallback = NULL;
+PFNGLDEBUGMESSAGECONTROLPROC rg_glDebugMessageControl = NULL;
+
+#define glDispatchCompute rg_glDispatchCompute
+#define glMemoryBarrier rg_glMemoryBarrier
+#define glBindImageTexture rg_glBindImageTexture
+#define glDrawArraysIndirect rg_glDrawArraysIndirect
+#define glMultiDrawElementsIndirect rg_glMultiDrawElementsIndirect
+#define glMultiDrawElementsIndirectCount rg_glMultiDrawElementsIndirectCount
+#define glDebugMessageCallback rg_glDebugMessageCallback
+#define glDebugMessageControl rg_glDebugMessageControl
+
+namespace rg {
+
+struct GLExt {
+    // compute shaders, image load/store and shader storage buffers (core 4.3)
+    static bool Compute;
+    // indirect draws whose commands honour baseInstance (core 4.2)
+    static bool DrawIndirect;
+    // glMultiDrawElementsIndirect (core 4.3)
+    static bool MultiDrawIndirect;
+    // draw counts read from a GL_PARAMETER_BUFFER (core 4.6)
+    static bool IndirectCount;
+    // glDebugMessageCallback (core 4.3, GL_KHR_debug or GL_ARB_debug_output)
+    static bool Debug;
+    // shader invocation and clipping counter queries (core 4.6, GL_ARB_pipeline_statistics_query)
+    static bool PipelineStatistics;
+};
+
+bool GLExt::Compute = false;
+bool GLExt::DrawIndirect = false;
+bool GLExt::MultiDrawIndirect = false;
+bool GLExt::IndirectCount = false;
+bool GLExt::Debug = false;
+bool GLExt::PipelineStatistics = false;
+
+bool isGLVersionAtLeast(int major, int minor) {
+    return GLVersion.major > major || (GLVersion.major == major && GLVersion.minor >= minor);
+}
+
+bool hasGLExtension(const char* name) {
+    GLint count = 0;
+    glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+    for (GLint i = 0; i < count; i++)
+        if (std::strcmp((const char*) glGetStringi(GL_EXTENSIONS, i), name) == 0)
+            return true;
+    return false;
+}
+
+// call once after gladLoadGLLoader with the same loader
+void loadGLExtensions(GLADloadproc load) {
+    if (isGLVersionAtLeast(4, 2)) {
+        rg_glDrawArraysIndirect = (PFNGLDRAWARRAYSINDIRECTPROC) load("glDrawArraysIndirect");
+        GLExt::DrawIndirect = rg_glDrawArraysIndirect != NULL;
+    }
+    if (isGLVersionAtLeast(4, 3)) {
+        rg_glDispatchCompute = (PFNGLDISPATCHCOMPUTEPROC) load("glDispatchCompute");
+        rg_glMemoryBarrier = (PFNGLMEMORYBARRIERPROC) load("glMemoryBarrier");
+        rg_glBindImageTexture = (PFNGLBINDIMAGETEXTUREPROC) load("glBindImageTexture");
+        GLExt::Compute = rg_glDispatchCompute && rg_glMemoryBarrier && rg_glBindImageTexture;
+        rg_glMultiDrawElementsIndirect = (PFNGLMULTIDRAWELEMENTSINDIRECTPROC) load("glMultiDrawElementsIndirect");
+        GLExt::MultiDrawIndirect = rg_glMultiDrawElementsIndirect != NULL;
+    }
+    if (isGLVersionAtLeast(4, 6)) {
+        rg_glMultiDrawElementsIndirectCount = (PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC) load("glMultiDrawElementsIndirectCount");
+        GLExt::IndirectCount = rg_glMultiDrawElementsIndirectCount != NULL;
+    }
+    // the ARB entry points take the same arguments
+    if (isGLVersionAtLeast(4, 3) || hasGLExtension("GL_KHR_debug")) {
+        rg_glDebugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC) load("glDebugMessageCallback");
+        rg_glDebugMessageControl = (PFNGLDEBUGMESSAGECONTROLPROC) load("glDebugMessageControl");
+    } else if (hasGLExtension("GL_ARB_debug_output")) {
+        rg_glDebugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC) load("glDebugMessageCallbackARB");
+        rg_glDebugMessageControl = (PFNGLDEBUGMESSAGECONTROLPROC) load("glDebugMessageControlARB");
+    }
+    GLExt::Debug = rg_glDebugMessageCallback && rg_glDebugMessageControl;
+    // only new query targets, no entry points
+    GLExt::PipelineStatistics = isGLVersionAtLeast(4, 6) || hasGLExtension("GL_ARB_pipeline_statistics_query");
+}
+
+}
+#endif //PROJECT_BASE_GLEXT_H
@@ -0,0 +1,208 @@
+#ifndef PROJECT_BASE_GPUPROFILER_H
+#define PROJECT_BASE_GPUPROFILER_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+// Nested named GPU time scopes. Push() and Pop() each put a GL_TIMESTAMP query in the command
+// stream (GL_TIME_ELAPSED queries can not nest), the zones of a frame are the intervals
+// between them. Frames go into a ring of RING_SIZE, and BeginFrame() reads back only frames
+// whose last query is already available, so reading never stalls; if the GPU falls more
+// than RING_SIZE frames behind, the oldest frame is dropped.
+// LastFrame() is the most recent finished frame as a timeline, History() the rolling
+// milliseconds of one zone name over the last HISTORY finished frames. Frames are numbered,
+// rg::PipelineStatistics takes the number to pair its results with the same frame.
+class GpuProfiler {
+public:
+    static const int RING_SIZE = 4;
+    static const int HISTORY = 240;
+
+    struct Zone {
+        std::string Name;
+        int Depth;
+        // relative to the start of the frame
+        float StartMs;
+        float Ms;
+    };
+
+    // Push() in the constructor, Pop() in the destructor
+    class Scope {
+    public:
+        Scope(GpuProfiler& profiler, const std::string& name)
+            : m_Profiler(profiler) {
+            m_Profiler.Push(name);
+        }
+
+        ~Scope() {
+            m_Profiler.Pop();
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        GpuProfiler& m_Profiler;
+    };
+
+    bool Enabled = true;
+
+    GpuProfiler() = default;
+
+    ~GpuProfiler() {
+        for (Frame& frame : m_Frames)
+            if (!frame.Queries.empty())
+                glDeleteQueries((GLsizei) frame.Queries.size(), frame.Queries.data());
+    }
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // opens the "frame" zone every other zone of the frame nests in
+    void BeginFrame() {
+        collect();
+        Frame& frame = m_Frames[m_Write];
+        frame.Pending = false;
+        frame.Number = ++m_Number;
+        frame.Zones.clear();
+        frame.Stack.clear();
+        m_Recording = Enabled;
+        Push("frame");
+    }
+
+    // the frame BeginFrame() started
+    uint64_t FrameNumber() const {
+        return m_Number;
+    }
+
+    void EndFrame() {
+        if (!m_Recording)
+            return;
+        while (!m_Frames[m_Write].Stack.empty())
+            Pop();
+        m_Frames[m_Write].Pending = true;
+        m_Write = (m_Write + 1) % RING_SIZE;
+        m_Recording = false;
+    }
+
+    // the index of the zone in LastFrame() once the frame is finished, -1 when not recording
+    int Push(const std::string& name) {
+        if (!m_Recording)
+            return -1;
+        Frame& frame = m_Frames[m_Write];
+        int zone = (int) frame.Zones.size();
+        frame.Zones.push_back(Record{name, (int) frame.Stack.size()});
+        if (frame.Queries.size() < frame.Zones.size() * 2) {
+            size_t count = frame.Queries.size();
+            frame.Queries.resize(std::max<size_t>(32, 2 * count));
+            glGenQueries((GLsizei) (frame.Queries.size() - count), frame.Queries.data() + count);
+        }
+        glQueryCounter(frame.Queries[2 * zone], GL_TIMESTAMP);
+        frame.Stack.push_back(zone);
+        return zone;
+    }
+
+    void Pop() {
+        if (!m_Recording || m_Frames[m_Write].Stack.empty())
+            return;
+        Frame& frame = m_Frames[m_Write];
+        glQueryCounter(frame.Queries[2 * frame.Stack.back() + 1], GL_TIMESTAMP);
+        frame.Stack.pop_back();
+    }
+
+    // zones of the last finished frame in the order they were opened, "frame" first
+    const std::vector<Zone>& LastFrame() const {
+        return m_LastFrame;
+    }
+
+    // FrameNumber() of LastFrame(), 0 before the first
+    uint64_t LastFrameNumber() const {
+        return m_LastNumber;
+    }
+
+    // the last HISTORY finished frames of a zone, oldest first, 0 where it did not run
+    std::vector<float> History(const std::string& name) const {
+        std::vector<float> history(HISTORY, 0.0f);
+        auto it = m_History.find(name);
+        if (it != m_History.end())
+            for (int i = 0; i < HISTORY; i++)
+                history[i] = it->second[(m_HistoryWrite + i) % HISTORY];
+        return history;
+    }
+
+    // every zone name seen so far
+    std::vector<std::string> Names() const {
+        std::vector<std::string> names;
+        for (const auto& entry : m_History)
+            names.push_back(entry.first);
+        return names;
+    }
+
+private:
+    struct Record {
+        std::string Name;
+        int Depth;
+    };
+
+    struct Frame {
+        std::vector<Record> Zones;
+        std::vector<int> Stack;
+        // begin and end timestamp of every zone
+        std::vector<unsigned int> Queries;
+        bool Pending = false;
+        uint64_t Number = 0;
+    };
+
+    Frame m_Frames[RING_SIZE];
+    int m_Write = 0;
+    bool m_Recording = false;
+    uint64_t m_Number = 0;
+    std::vector<Zone> m_LastFrame;
+    uint64_t m_LastNumber = 0;
+    std::map<std::string, std::vector<float>> m_History;
+    int m_HistoryWrite = 0;
+
+    void collect() {
+        // walk from the oldest slot, timestamps land in order so the "frame" end query
+        // being available means the whole frame is
+        for (int i = 0; i < RING_SIZE; i++) {
+            Frame& frame = m_Frames[(m_Write + i) % RING_SIZE];
+            if (!frame.Pending)
+                continue;
+            GLuint available = 0;
+            glGetQueryObjectuiv(frame.Queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+            std::vector<GLuint64> timestamps(2 * frame.Zones.size());
+            for (size_t query = 0; query < timestamps.size(); query++)
+                glGetQueryObjectui64v(frame.Queries[query], GL_QUERY_RESULT, &timestamps[query]);
+            m_LastFrame.clear();
+            m_LastNumber = frame.Number;
+            std::map<std::string, float> sums;
+            for (size_t zone = 0; zone < frame.Zones.size(); zone++) {
+                float start = (float) ((double) (timestamps[2 * zone] - timestamps[0]) / 1.0e6);
+                float ms = (float) ((double) (timestamps[2 * zone + 1] - timestamps[2 * zone]) / 1.0e6);
+                m_LastFrame.push_back(Zone{frame.Zones[zone].Name, frame.Zones[zone].Depth, start, ms});
+                sums[frame.Zones[zone].Name] += ms;
+            }
+            for (const auto& sum : sums)
+                if (m_History.find(sum.first) == m_History.end())
+                    m_History[sum.first].assign(HISTORY, 0.0f);
+            for (auto& entry : m_History) {
+                auto sum = sums.find(entry.first);
+                entry.second[m_HistoryWrite] = sum != sums.end() ? sum->second : 0.0f;
+            }
+            m_HistoryWrite = (m_HistoryWrite + 1) % HISTORY;
+            frame.Pending = false;
+        }
+    }
+};
+
+}
+#endif //PROJECT_BASE_GPUPROFILER_H
@@ -0,0 +1,573 @@
+#ifndef PROJECT_BASE_GPUSCENE_H
+#define PROJECT_BASE_GPUSCENE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define RG_GPU_SCENE_SSE 1
+#endif
+
+#include <learnopengl/model.h>
+#include <learnopengl/shader.h>
+#include <rg/Frustum.h>
+#include <rg/GLExt.h>
+#include <rg/GpuTimer.h>
+#include <rg/Meshlets.h>
+
+namespace rg {
+
+// GPU-driven rendering of static and rigidly moving models (4.3 contexts). The meshes of every
+// added model are split into meshlets and copied into one vertex and one index buffer, every
+// meshlet of every instance becomes an object with a bounding sphere and a normal cone in a
+// shader storage buffer. Each frame the objects are culled against the frustum and, for models
+// drawn with face culling, against their cones, and a compacted DrawElementsIndirectCommand
+// list is written per draw group (shader, face culling and textures). Every group is a single
+// glMultiDrawElementsIndirect, so the CPU cost no longer grows with the number of meshes.
+// Models with levels of detail get meshlets for every level, only those of the levels an
+// instance is set to with SetLod() survive culling.
+//  - GPU culling: scene_cull.cs writes the commands and the draw counts.
+//  - CPU culling: the bounds are tested four at a time with SSE and the commands uploaded.
+// The model shaders are built from gpu_scene.vs, which fetches the transform of the object.
+class GpuScene {
+public:
+    static const unsigned int MESHLET_TRIANGLES = 124;
+
+    // triangles of the last culled frame, from three frames back with GPU culling
+    struct CullStats {
+        unsigned int VisibleMeshlets = 0;
+        unsigned int VisibleTriangles = 0;
+        unsigned int FrustumRejectedTriangles = 0;
+        unsigned int ConeRejectedTriangles = 0;
+    };
+
+    bool Enabled = true;
+    bool FrustumCulling = true;
+    bool ConeCulling = true;
+    bool CullOnCpu = false;
+
+    GpuScene() {
+        if (!GLExt::Compute || !GLExt::MultiDrawIndirect)
+            return;
+        m_CullShader.reset(new Shader("resources/shaders/scene_cull.cs"));
+        glGenVertexArrays(1, &m_VAO);
+        glGenBuffers(BUFFER_COUNT, m_Buffers);
+        glGenBuffers(STATS_FRAMES, m_StatsBuffers);
+        CullStats zero;
+        for (unsigned int buffer : m_StatsBuffers) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(CullStats), &zero, GL_DYNAMIC_READ);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    ~GpuScene() {
+        if (!IsAvailable())
+            return;
+        glDeleteVertexArrays(1, &m_VAO);
+        glDeleteBuffers(BUFFER_COUNT, m_Buffers);
+        glDeleteBuffers(STATS_FRAMES, m_StatsBuffers);
+    }
+
+    GpuScene(const GpuScene&) = delete;
+    GpuScene& operator=(const GpuScene&) = delete;
+
+    bool IsAvailable() const {
+        return m_CullShader != nullptr;
+    }
+
+    // Splits the meshes of model, every level of detail of them, into meshlets, copies them into
+    // the shared buffers and returns the model id. The meshes are drawn with shader, made from gpu_scene.vs and a fragment
+    // shader with the usual material.texture_diffuse1 and material.texture_specular1 samplers,
+    // culling cullFace (GL_FRONT or GL_BACK) when it is not GL_NONE. Cone culling only applies
+    // to models with face culling, the others may show either side of a triangle.
+    int AddModel(const Model& model, Shader& shader, GLenum cullFace = GL_NONE) {
+        ModelInfo info;
+        info.FirstMeshlet = (int) m_Meshlets.size();
+        info.Program = &shader;
+        info.CullFace = cullFace;
+        for (const Mesh& mesh : model.meshes) {
+            GLint baseVertex = (GLint) m_Vertices.size();
+            std::pair<unsigned int, unsigned int> textures(findTexture(mesh, "texture_diffuse"), findTexture(mesh, "texture_specular"));
+            // meshes with a shorter chain repeat their coarsest level
+            for (int lod = 0; lod < model.LodCount(); lod++) {
+                GLuint firstIndex = (GLuint) m_Indices.size();
+                std::vector<unsigned int> indices = mesh.LodIndices(std::min(lod, (int) mesh.lods.size() - 1));
+                for (const Meshlet& meshlet : buildMeshlets(mesh.vertices, indices, MESHLET_TRIANGLES, m_Indices)) {
+                    MeshletRange range = {meshlet.IndexCount, firstIndex + meshlet.FirstIndex, baseVertex, (GLuint) lod};
+                    glm::vec4 cone = meshlet.Cone;
+                    if (cullFace == GL_NONE)
+                        cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+                    else if (cullFace == GL_FRONT)
+                        cone = glm::vec4(-glm::vec3(cone), cone.w);
+                    m_Meshlets.push_back(range);
+                    m_MeshletBounds.push_back(std::make_pair(meshlet.Sphere, cone));
+                    m_MeshletTextures.push_back(textures);
+                }
+            }
+            m_Vertices.insert(m_Vertices.end(), mesh.vertices.begin(), mesh.vertices.end());
+        }
+        info.MeshletCount = (int) m_Meshlets.size() - info.FirstMeshlet;
+        m_Models.push_back(info);
+        m_Built = false;
+        return (int) m_Models.size() - 1;
+    }
+
+    // returns the instance id for SetTransform
+    int AddInstance(int model, const glm::mat4& transform = glm::mat4(1.0f)) {
+        m_InstanceModels.push_back(model);
+        m_Transforms.push_back(transform);
+        m_InstanceLods.push_back(InstanceLod{0, 0, 1.0f, 0});
+        m_Built = false;
+        return (int) m_Transforms.size() - 1;
+    }
+
+    void SetTransform(int instance, const glm::mat4& transform) {
+        m_Transforms[instance] = transform;
+    }
+
+    // draws nothing of the instance until the next SetLod()
+    void Hide(int instance) {
+        m_InstanceLods[instance] = InstanceLod{HIDDEN_LOD, HIDDEN_LOD, 1.0f, 0};
+    }
+
+    // Draws the instance at level current, and while fade is below 1 also at level previous,
+    // with the complementary dither patterns of clock.fs (see rg::LodSelector).
+    void SetLod(int instance, int current, int previous, float fade) {
+        m_InstanceLods[instance] = InstanceLod{(GLuint) current, (GLuint) (fade < 1.0f ? previous : current), fade, 0};
+    }
+
+    void Draw(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& cameraPosition) {
+        if (!m_Built)
+            build();
+        if (m_Objects.empty())
+            return;
+        auto start = std::chrono::high_resolution_clock::now();
+        m_Timer.Begin();
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffers[TRANSFORMS]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_Transforms.size() * sizeof(glm::mat4), m_Transforms.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffers[INSTANCE_LODS]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_InstanceLods.size() * sizeof(InstanceLod), m_InstanceLods.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        glm::vec4 planes[6];
+        extractFrustumPlanes(projection * view, planes);
+        if (CullOnCpu)
+            cullOnCpu(planes, cameraPosition);
+        else
+            cullOnGpu(planes, cameraPosition);
+
+        glBindVertexArray(m_VAO);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, OBJECTS, m_Buffers[OBJECTS]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TRANSFORMS, m_Buffers[TRANSFORMS]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_LODS_BINDING, m_Buffers[INSTANCE_LODS]);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_Buffers[COMMANDS]);
+        if (GLExt::IndirectCount)
+            glBindBuffer(GL_PARAMETER_BUFFER, m_Buffers[DRAW_COUNTS]);
+        Shader* program = nullptr;
+        for (size_t i = 0; i < m_Groups.size(); i++) {
+            const Group& group = m_Groups[i];
+            if (group.Program != program) {
+                program = group.Program;
+                program->use();
+                program->setMat4("projection", projection);
+                program->setMat4("view", view);
+            }
+            if (group.CullFace == GL_NONE) {
+                glDisable(GL_CULL_FACE);
+            } else {
+                glEnable(GL_CULL_FACE);
+                glCullFace(group.CullFace);
+            }
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, group.Diffuse);
+            glActiveTexture(GL_TEXTURE1);
+            glBindTexture(GL_TEXTURE_2D, group.Specular);
+
+            // commands past a group's count are zero, which makes them empty draws
+            const void* commands = (const void*) (group.FirstCommand * sizeof(DrawElementsIndirectCommand));
+            if (GLExt::IndirectCount)
+                glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, commands, (GLintptr) (i * sizeof(GLuint)),
+                                                 (GLsizei) group.Capacity, 0);
+            else
+                glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, commands, (GLsizei) group.Capacity, 0);
+        }
+        if (GLExt::IndirectCount)
+            glBindBuffer(GL_PARAMETER_BUFFER, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+        glActiveTexture(GL_TEXTURE0);
+        glDisable(GL_CULL_FACE);
+
+        m_Timer.End();
+        m_SubmitMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+    int ObjectCount() const {
+        return (int) m_Objects.size();
+    }
+
+    // glMultiDrawElementsIndirect calls per frame
+    int GroupCount() const {
+        return (int) m_Groups.size();
+    }
+
+    // triangles of all instances at full detail
+    unsigned int TriangleCount() const {
+        return m_TriangleCount;
+    }
+
+    const CullStats& Stats() const {
+        return m_Stats;
+    }
+
+    // GPU time of culling and drawing
+    float LastMs() const {
+        return m_Timer.LastMs();
+    }
+
+    // CPU time Draw() spends on culling, uploads and submission
+    float SubmitMs() const {
+        return m_SubmitMs;
+    }
+
+private:
+    enum BufferName {
+        // the first six are the shader storage bindings of scene_cull.cs, the statistics are 6
+        OBJECTS, TRANSFORMS, MESHLETS, GROUP_OFFSETS, COMMANDS, DRAW_COUNTS,
+        VERTICES, INDICES, OBJECT_IDS, INSTANCE_LODS, BUFFER_COUNT
+    };
+
+    static const GLuint INSTANCE_LODS_BINDING = 7;
+    // a level no meshlet has
+    static const GLuint HIDDEN_LOD = 0xFFFFFFFFu;
+
+    // GPU statistics are read back this many frames late, long after the GPU wrote them
+    static const int STATS_FRAMES = 3;
+
+    // std430 layouts of scene_cull.cs
+    struct Object {
+        glm::vec4 Sphere;
+        glm::vec4 Cone;
+        GLuint Meshlet;
+        GLuint Transform;
+        GLuint Group;
+        GLuint Lod;
+    };
+
+    struct MeshletRange {
+        GLuint IndexCount;
+        GLuint FirstIndex;
+        GLint BaseVertex;
+        // level of detail on the CPU, padding to the shader
+        GLuint Lod;
+    };
+
+    struct InstanceLod {
+        GLuint Current;
+        GLuint Previous;
+        float Fade;
+        GLuint Padding;
+    };
+
+    struct DrawElementsIndirectCommand {
+        GLuint Count;
+        GLuint InstanceCount;
+        GLuint FirstIndex;
+        GLint BaseVertex;
+        GLuint BaseInstance;
+    };
+
+    struct ModelInfo {
+        int FirstMeshlet;
+        int MeshletCount;
+        Shader* Program;
+        GLenum CullFace;
+    };
+
+    struct Group {
+        Shader* Program;
+        GLenum CullFace;
+        unsigned int Diffuse;
+        unsigned int Specular;
+        GLuint FirstCommand;
+        GLuint Capacity;
+    };
+
+    std::unique_ptr<Shader> m_CullShader;
+    unsigned int m_VAO = 0;
+    unsigned int m_Buffers[BUFFER_COUNT] = {};
+    unsigned int m_StatsBuffers[STATS_FRAMES] = {};
+    unsigned int m_Frame = 0;
+    GpuTimer m_Timer;
+    float m_SubmitMs = 0.0f;
+    bool m_Built = false;
+    CullStats m_Stats;
+    unsigned int m_TriangleCount = 0;
+
+    std::vector<Vertex> m_Vertices;
+    std::vector<unsigned int> m_Indices;
+    std::vector<MeshletRange> m_Meshlets;
+    std::vector<std::pair<glm::vec4, glm::vec4>> m_MeshletBounds;
+    std::vector<std::pair<unsigned int, unsigned int>> m_MeshletTextures;
+    std::vector<ModelInfo> m_Models;
+    std::vector<int> m_InstanceModels;
+    std::vector<glm::mat4> m_Transforms;
+    std::vector<InstanceLod> m_InstanceLods;
+
+    std::vector<Object> m_Objects;
+    std::vector<Group> m_Groups;
+    std::vector<DrawElementsIndirectCommand> m_ZeroCommands;
+    std::vector<GLuint> m_ZeroCounts;
+
+    // CPU culling: world space bounds as structure of arrays, padded to a multiple of four
+    std::vector<float> m_CenterX, m_CenterY, m_CenterZ, m_Radius;
+    std::vector<float> m_AxisX, m_AxisY, m_AxisZ, m_Cutoff;
+    std::vector<DrawElementsIndirectCommand> m_Commands;
+    std::vector<GLuint> m_Counts;
+
+    static unsigned int findTexture(const Mesh& mesh, const std::string& type) {
+        for (const Texture& texture : mesh.textures)
+            if (texture.type == type)
+                return texture.id;
+        return 0;
+    }
+
+    void cullOnGpu(const glm::vec4 planes[6], const glm::vec3& cameraPosition) {
+        // the statistics written STATS_FRAMES ago, then the buffer is reused for this frame
+        unsigned int statsBuffer = m_StatsBuffers[m_Frame++ % STATS_FRAMES];
+        CullStats zero;
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, statsBuffer);
+        if (m_Frame > STATS_FRAMES)
+            glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(CullStats), &m_Stats);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(CullStats), &zero);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffers[COMMANDS]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_ZeroCommands.size() * sizeof(DrawElementsIndirectCommand), m_ZeroCommands.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffers[DRAW_COUNTS]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_ZeroCounts.size() * sizeof(GLuint), m_ZeroCounts.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        m_CullShader->use();
+        glUniform1ui(glGetUniformLocation(m_CullShader->ID, "objectCount"), (GLuint) m_Objects.size());
+        glUniform4fv(glGetUniformLocation(m_CullShader->ID, "frustumPlanes"), 6, &planes[0][0]);
+        m_CullShader->setVec3("cameraPosition", cameraPosition);
+        m_CullShader->setBool("frustumCulling", FrustumCulling);
+        m_CullShader->setBool("coneCulling", ConeCulling);
+        for (int binding = OBJECTS; binding <= DRAW_COUNTS; binding++)
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, m_Buffers[binding]);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, statsBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_LODS_BINDING, m_Buffers[INSTANCE_LODS]);
+        glDispatchCompute(((GLuint) m_Objects.size() + 63) / 64, 1, 1);
+        // the draws read the commands; glGetBufferSubData of the statistics and the next frame's
+        // glBufferSubData of the commands and counts need the shader writes finished as well
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+    }
+
+    void cullOnCpu(const glm::vec4 planes[6], const glm::vec3& cameraPosition) {
+        // world space bounds, the transforms may have changed since the last frame
+        for (size_t i = 0; i < m_Objects.size(); i++) {
+            const Object& object = m_Objects[i];
+            const glm::mat4& model = m_Transforms[object.Transform];
+            glm::vec3 center = glm::vec3(model * glm::vec4(glm::vec3(object.Sphere), 1.0f));
+            float scale = std::max(glm::length(glm::vec3(model[0])), std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+            glm::vec3 axis = glm::vec3(model * glm::vec4(glm::vec3(object.Cone), 0.0f));
+            float axisLength = glm::length(axis);
+            axis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f);
+            m_CenterX[i] = center.x;
+            m_CenterY[i] = center.y;
+            m_CenterZ[i] = center.z;
+            m_Radius[i] = object.Sphere.w * scale;
+            m_AxisX[i] = axis.x;
+            m_AxisY[i] = axis.y;
+            m_AxisZ[i] = axis.z;
+            m_Cutoff[i] = object.Cone.w;
+        }
+
+        m_Commands = m_ZeroCommands;
+        std::fill(m_Counts.begin(), m_Counts.end(), 0);
+        m_Stats = CullStats();
+        size_t count = m_Objects.size();
+#ifdef RG_GPU_SCENE_SSE
+        __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+        for (int p = 0; p < 6; p++) {
+            planeX[p] = _mm_set1_ps(planes[p].x);
+            planeY[p] = _mm_set1_ps(planes[p].y);
+            planeZ[p] = _mm_set1_ps(planes[p].z);
+            planeW[p] = _mm_set1_ps(planes[p].w);
+        }
+        __m128 cameraX = _mm_set1_ps(cameraPosition.x);
+        __m128 cameraY = _mm_set1_ps(cameraPosition.y);
+        __m128 cameraZ = _mm_set1_ps(cameraPosition.z);
+        __m128 zero = _mm_setzero_ps();
+        int frustumMask = FrustumCulling ? 0xF : 0;
+        int coneMask = ConeCulling ? 0xF : 0;
+
+        for (size_t i = 0; i < count; i += 4) {
+            __m128 x = _mm_loadu_ps(&m_CenterX[i]);
+            __m128 y = _mm_loadu_ps(&m_CenterY[i]);
+            __m128 z = _mm_loadu_ps(&m_CenterZ[i]);
+            __m128 radius = _mm_loadu_ps(&m_Radius[i]);
+            __m128 negativeRadius = _mm_sub_ps(zero, radius);
+
+            __m128 outside = zero;
+            for (int p = 0; p < 6; p++) {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+                                      _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(d, negativeRadius));
+            }
+
+            // back facing when dot(center - camera, axis) >= cutoff * |center - camera| + radius
+            __m128 dx = _mm_sub_ps(x, cameraX);
+            __m128 dy = _mm_sub_ps(y, cameraY);
+            __m128 dz = _mm_sub_ps(z, cameraZ);
+            __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+            __m128 alongAxis = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, _mm_loadu_ps(&m_AxisX[i])), _mm_mul_ps(dy, _mm_loadu_ps(&m_AxisY[i]))),
+                                          _mm_mul_ps(dz, _mm_loadu_ps(&m_AxisZ[i])));
+            __m128 backFacing = _mm_cmpge_ps(alongAxis, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_Cutoff[i]), distance), radius));
+
+            int outsideLanes = _mm_movemask_ps(outside) & frustumMask;
+            int backFacingLanes = _mm_movemask_ps(backFacing) & coneMask;
+            for (int lane = 0; lane < 4 && i + lane < count; lane++)
+                emit(i + lane, (outsideLanes >> lane) & 1, (backFacingLanes >> lane) & 1);
+        }
+#else
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 center(m_CenterX[i], m_CenterY[i], m_CenterZ[i]);
+            bool outside = false;
+            for (int p = 0; p < 6; p++)
+                outside = outside || glm::dot(glm::vec3(planes[p]), center) + planes[p].w < -m_Radius[i];
+            glm::vec3 toCenter = center - cameraPosition;
+            bool backFacing = glm::dot(toCenter, glm::vec3(m_AxisX[i], m_AxisY[i], m_AxisZ[i]))
+                              >= m_Cutoff[i] * glm::length(toCenter) + m_Radius[i];
+            emit(i, FrustumCulling && outside, ConeCulling && backFacing);
+        }
+#endif
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffers[COMMANDS]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_Commands.size() * sizeof(DrawElementsIndirectCommand), m_Commands.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_Buffers[DRAW_COUNTS]);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, m_Counts.size() * sizeof(GLuint), m_Counts.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    // the CPU side of what scene_cull.cs does for one object
+    void emit(size_t index, bool outside, bool backFacing) {
+        const Object& object = m_Objects[index];
+        const InstanceLod& lod = m_InstanceLods[object.Transform];
+        if (object.Lod != lod.Current && object.Lod != lod.Previous)
+            return;
+        const MeshletRange& meshlet = m_Meshlets[object.Meshlet];
+        unsigned int triangles = meshlet.IndexCount / 3;
+        if (outside) {
+            m_Stats.FrustumRejectedTriangles += triangles;
+        } else if (backFacing) {
+            m_Stats.ConeRejectedTriangles += triangles;
+        } else {
+            m_Stats.VisibleMeshlets++;
+            m_Stats.VisibleTriangles += triangles;
+            GLuint slot = m_Groups[object.Group].FirstCommand + m_Counts[object.Group]++;
+            m_Commands[slot] = DrawElementsIndirectCommand{meshlet.IndexCount, 1, meshlet.FirstIndex, meshlet.BaseVertex, (GLuint) index};
+        }
+    }
+
+    void build() {
+        // one group per shader, face culling and texture pair, ordered so shader changes are rare
+        typedef std::tuple<unsigned int, GLenum, unsigned int, unsigned int> GroupKey;
+        std::map<GroupKey, Group> groups;
+        std::vector<std::pair<Object, GroupKey>> objects;
+        m_TriangleCount = 0;
+        for (size_t instance = 0; instance < m_InstanceModels.size(); instance++) {
+            const ModelInfo& model = m_Models[m_InstanceModels[instance]];
+            for (int meshlet = model.FirstMeshlet; meshlet < model.FirstMeshlet + model.MeshletCount; meshlet++) {
+                const std::pair<unsigned int, unsigned int>& textures = m_MeshletTextures[meshlet];
+                GroupKey key(model.Program->ID, model.CullFace, textures.first, textures.second);
+                if (groups.find(key) == groups.end())
+                    groups[key] = Group{model.Program, model.CullFace, textures.first, textures.second, 0, 0};
+                groups[key].Capacity++;
+                GLuint lod = m_Meshlets[meshlet].Lod;
+                Object object = {m_MeshletBounds[meshlet].first, m_MeshletBounds[meshlet].second, (GLuint) meshlet, (GLuint) instance, 0, lod};
+                objects.push_back(std::make_pair(object, key));
+                if (lod == 0)
+                    m_TriangleCount += m_Meshlets[meshlet].IndexCount / 3;
+            }
+        }
+
+        m_Groups.clear();
+        std::map<GroupKey, GLuint> groupIndices;
+        std::vector<GLuint> offsets;
+        GLuint commandCount = 0;
+        for (auto& group : groups) {
+            group.second.FirstCommand = commandCount;
+            commandCount += group.second.Capacity;
+            groupIndices[group.first] = (GLuint) m_Groups.size();
+            offsets.push_back(group.second.FirstCommand);
+            m_Groups.push_back(group.second);
+        }
+        m_Objects.clear();
+        for (auto& object : objects) {
+            object.first.Group = groupIndices[object.second];
+            m_Objects.push_back(object.first);
+        }
+        m_ZeroCommands.assign(commandCount, DrawElementsIndirectCommand{0, 0, 0, 0, 0});
+        m_ZeroCounts.assign(m_Groups.size(), 0);
+        m_Counts.assign(m_Groups.size(), 0);
+        size_t padded = (m_Objects.size() + 3) / 4 * 4;
+        for (std::vector<float>* column : {&m_CenterX, &m_CenterY, &m_CenterZ, &m_Radius, &m_AxisX, &m_AxisY, &m_AxisZ, &m_Cutoff})
+            column->assign(padded, 0.0f);
+
+        std::vector<GLuint> objectIds(m_Objects.size());
+        for (size_t i = 0; i < objectIds.size(); i++)
+            objectIds[i] = (GLuint) i;
+
+        upload(GL_SHADER_STORAGE_BUFFER, m_Buffers[OBJECTS], m_Objects, GL_STATIC_DRAW);
+        upload(GL_SHADER_STORAGE_BUFFER, m_Buffers[TRANSFORMS], m_Transforms, GL_DYNAMIC_DRAW);
+        upload(GL_SHADER_STORAGE_BUFFER, m_Buffers[INSTANCE_LODS], m_InstanceLods, GL_DYNAMIC_DRAW);
+        upload(GL_SHADER_STORAGE_BUFFER, m_Buffers[MESHLETS], m_Meshlets, GL_STATIC_DRAW);
+        upload(GL_SHADER_STORAGE_BUFFER, m_Buffers[GROUP_OFFSETS], offsets, GL_STATIC_DRAW);
+        upload(GL_SHADER_STORAGE_BUFFER, m_Buffers[COMMANDS], m_ZeroCommands, GL_DYNAMIC_DRAW);
+        upload(GL_SHADER_STORAGE_BUFFER, m_Buffers[DRAW_COUNTS], m_ZeroCounts, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        glBindVertexArray(m_VAO);
+        upload(GL_ARRAY_BUFFER, m_Buffers[VERTICES], m_Vertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) 0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, Normal));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*) offsetof(Vertex, TexCoords));
+        // instance i of a command reads objectIds[baseInstance + i], the object the command belongs to
+        upload(GL_ARRAY_BUFFER, m_Buffers[OBJECT_IDS], objectIds, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(5);
+        glVertexAttribIPointer(5, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*) 0);
+        glVertexAttribDivisor(5, 1);
+        upload(GL_ELEMENT_ARRAY_BUFFER, m_Buffers[INDICES], m_Indices, GL_STATIC_DRAW);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        for (const Group& group : m_Groups) {
+            group.Program->use();
+            group.Program->setInt("material.texture_diffuse1", 0);
+            group.Program->setInt("material.texture_specular1", 1);
+        }
+        m_Built = true;
+    }
+
+    template <typename T>
+    static void upload(GLenum target, unsigned int buffer, const std::vector<T>& data, GLenum usage) {
+        glBindBuffer(target, buffer);
+        glBufferData(target, data.size() * sizeof(T), data.empty() ? NULL : data.data(), usage);
+    }
+};
+
+}
+#endif //PROJECT_BASE_GPUSCENE_H
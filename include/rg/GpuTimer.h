@@ -0,0 +1,80 @@
+#ifndef PROJECT_BASE_GPUTIMER_H
+#define PROJECT_BASE_GPUTIMER_H
+
+#include <glad/glad.h>
+
+namespace rg {
+
+// Measures the GPU time between Begin() and End() with GL_TIMESTAMP queries.
+// Results are read back a few frames later from a ring of query pairs, so the
+// CPU never waits on the GPU. LastMs() returns the most recent finished interval, or the one
+// just ended after Collect(true).
+class GpuTimer {
+public:
+    static const int RING_SIZE = 4;
+
+    GpuTimer() {
+        glGenQueries(2 * RING_SIZE, m_Queries);
+    }
+
+    ~GpuTimer() {
+        glDeleteQueries(2 * RING_SIZE, m_Queries);
+    }
+
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    void Begin() {
+        // if the GPU is more than RING_SIZE frames behind, the oldest interval is dropped
+        m_Pending[m_Write] = false;
+        glQueryCounter(m_Queries[2 * m_Write], GL_TIMESTAMP);
+    }
+
+    void End() {
+        glQueryCounter(m_Queries[2 * m_Write + 1], GL_TIMESTAMP);
+        m_Pending[m_Write] = true;
+        m_Write = (m_Write + 1) % RING_SIZE;
+        Collect(false);
+    }
+
+    // reads the finished intervals, End() does it without waiting; wait blocks until the
+    // last End() is finished, so LastMs() is the frame just submitted (rg::Benchmark)
+    void Collect(bool wait) {
+        // walk from the oldest slot so the newest available result ends up in m_LastMs
+        for (int i = 0; i < RING_SIZE; i++) {
+            int slot = (m_Write + i) % RING_SIZE;
+            if (!m_Pending[slot])
+                continue;
+            GLuint available = 0;
+            if (!wait)
+                glGetQueryObjectuiv(m_Queries[2 * slot + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!wait && !available)
+                break;
+            GLuint64 begin = 0, end = 0;
+            glGetQueryObjectui64v(m_Queries[2 * slot], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(m_Queries[2 * slot + 1], GL_QUERY_RESULT, &end);
+            m_LastMs = (float) ((double) (end - begin) / 1.0e6);
+            m_HasResult = true;
+            m_Pending[slot] = false;
+        }
+    }
+
+    // milliseconds of the last interval the GPU has finished, 0 until the first one is available
+    float LastMs() const {
+        return m_LastMs;
+    }
+
+    bool HasResult() const {
+        return m_HasResult;
+    }
+
+private:
+    unsigned int m_Queries[2 * RING_SIZE];
+    bool m_Pending[RING_SIZE] = {};
+    int m_Write = 0;
+    float m_LastMs = 0.0f;
+    bool m_HasResult = false;
+};
+
+}
+#endif //PROJECT_BASE_GPUTIMER_H
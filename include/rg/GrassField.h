@@ -0,0 +1,587 @@
+#ifndef PROJECT_BASE_GRASSFIELD_H
+#define PROJECT_BASE_GRASSFIELD_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define RG_GRASS_FIELD_SSE 1
+#endif
+
+#include <learnopengl/shader.h>
+#include <rg/Frustum.h>
+#include <rg/GLExt.h>
+#include <rg/GpuTimer.h>
+
+namespace rg {
+
+// per-instance data, the layout of Instance in grass_cull.cs and of attributes 3 and 4 in grass_field.vs
+struct GrassInstance {
+    glm::vec4 PositionHeight; // root position, blade height
+    glm::vec4 Params;         // facing angle, bend, width, shade
+};
+
+// Instanced grass blades scattered over a square field from a density map.
+//  - 4.3 contexts: the instances live in a shader storage buffer, grass_cull.cs culls them
+//    against the frustum and appends the survivors per LOD, and every LOD is one
+//    glDrawArraysIndirect whose instance count the compute pass wrote.
+//  - otherwise: the CPU culls a structure-of-arrays copy of the bounds four instances at a
+//    time with SSE, uploads the survivors into an orphaned stream buffer of its own and
+//    issues one glDrawArraysInstanced per LOD. The GPU path's visible buffer keeps its full
+//    capacity, so switching between the two never leaves the compute pass a smaller buffer.
+// LOD 0 is a blade with three segments, LOD 1 a single triangle, past MaxDistance nothing.
+class GrassField {
+public:
+    static const int LOD_COUNT = 2;
+
+    bool Enabled = true;
+    // only honoured when IsGpuCullingAvailable()
+    bool GpuCulling = true;
+    int InstanceCount = 50000;
+    glm::vec3 Center = glm::vec3(0.0f);
+    float Size = 160.0f;
+    float BladeHeight = 0.8f;
+    float LodDistance = 25.0f;
+    float MaxDistance = 90.0f;
+
+    GrassField() : m_Shader("resources/shaders/grass_field.vs", "resources/shaders/grass_field.fs") {
+        if (GLExt::Compute && GLExt::DrawIndirect)
+            m_CullShader.reset(new Shader("resources/shaders/grass_cull.cs"));
+
+        // LOD 0 is a 7 vertex strip, LOD 1 a 3 vertex strip, see m_LodFirst and m_LodCount
+        const float blades[] = {
+            -1.0f, 0.0f, 1.0f, 0.0f, -1.0f, 1.0f / 3.0f, 1.0f, 1.0f / 3.0f, -1.0f, 2.0f / 3.0f, 1.0f, 2.0f / 3.0f, 0.0f, 1.0f,
+            -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f
+        };
+        glGenVertexArrays(1, &m_VAO);
+        glGenBuffers(1, &m_BladeVBO);
+        glGenBuffers(1, &m_InstanceBuffer);
+        glGenBuffers(1, &m_VisibleBuffer);
+        glGenBuffers(1, &m_StreamBuffer);
+        glGenBuffers(1, &m_CommandBuffer);
+        glGenBuffers(COUNT_RING, m_CountBuffers);
+        for (unsigned int buffer : m_CountBuffers) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, LOD_COUNT * sizeof(GLuint), NULL, GL_DYNAMIC_READ);
+        }
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glBindVertexArray(m_VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_BladeVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(blades), blades, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*) 0);
+        glEnableVertexAttribArray(3);
+        glVertexAttribDivisor(3, 1);
+        glEnableVertexAttribArray(4);
+        glVertexAttribDivisor(4, 1);
+        setInstanceOffset(m_VisibleBuffer, 0);
+        glBindVertexArray(0);
+    }
+
+    ~GrassField() {
+        glDeleteVertexArrays(1, &m_VAO);
+        glDeleteBuffers(1, &m_BladeVBO);
+        glDeleteBuffers(1, &m_InstanceBuffer);
+        glDeleteBuffers(1, &m_VisibleBuffer);
+        glDeleteBuffers(1, &m_StreamBuffer);
+        glDeleteBuffers(1, &m_CommandBuffer);
+        resetCounts();
+        glDeleteBuffers(COUNT_RING, m_CountBuffers);
+    }
+
+    GrassField(const GrassField&) = delete;
+    GrassField& operator=(const GrassField&) = delete;
+
+    bool IsGpuCullingAvailable() const {
+        return m_CullShader != nullptr;
+    }
+
+    // Grayscale image stretched over the field, brighter is denser. Without one the density
+    // comes from value noise.
+    bool LoadDensityMap(const std::string& path) {
+        int width, height, components;
+        unsigned char* data = stbi_load(path.c_str(), &width, &height, &components, 1);
+        if (!data) {
+            std::cout << "Grass density map failed to load at path: " << path << std::endl;
+            return false;
+        }
+        m_DensityWidth = width;
+        m_DensityHeight = height;
+        m_Density.assign(data, data + width * height);
+        stbi_image_free(data);
+        m_Generated = false;
+        return true;
+    }
+
+    // uniforms the field does not set itself, the point light and the view position
+    Shader& GetShader() {
+        return m_Shader;
+    }
+
+    void Draw(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& cameraPosition, float time) {
+        if (!m_Generated || m_GeneratedCount != InstanceCount || m_GeneratedCenter != Center
+            || m_GeneratedSize != Size || m_GeneratedHeight != BladeHeight)
+            regenerate();
+        if (m_Instances.empty())
+            return;
+
+        glm::vec4 planes[6];
+        extractFrustumPlanes(projection * view, planes);
+
+        m_Timer.Begin();
+        bool gpu = GpuCulling && IsGpuCullingAvailable();
+        if (gpu)
+            cullOnGpu(planes, cameraPosition);
+        else
+            cullOnCpu(planes, cameraPosition);
+
+        m_Shader.use();
+        m_Shader.setMat4("projection", projection);
+        m_Shader.setMat4("view", view);
+        m_Shader.setFloat("time", time);
+        glBindVertexArray(m_VAO);
+        if (gpu) {
+            setInstanceOffset(m_VisibleBuffer, 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+            for (int lod = 0; lod < LOD_COUNT; lod++)
+                glDrawArraysIndirect(GL_TRIANGLE_STRIP, (void*) (lod * sizeof(DrawArraysIndirectCommand)));
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        } else {
+            size_t offset = 0;
+            for (int lod = 0; lod < LOD_COUNT; lod++) {
+                if (!m_Visible[lod].empty()) {
+                    setInstanceOffset(m_StreamBuffer, offset);
+                    glDrawArraysInstanced(GL_TRIANGLE_STRIP, m_LodFirst[lod], m_LodCount[lod], (GLsizei) m_Visible[lod].size());
+                }
+                offset += m_Visible[lod].size() * sizeof(GrassInstance);
+            }
+        }
+        glBindVertexArray(0);
+        m_Timer.End();
+    }
+
+    // instances drawn by a LOD in the last frame; with GPU culling the count of the newest frame
+    // the GPU has finished, -1 until the first one has been read back
+    int VisibleCount(int lod) const {
+        if (m_LastCullOnGpu)
+            return m_HasGpuVisible ? (int) m_GpuVisible[lod] : -1;
+        return (int) m_Visible[lod].size();
+    }
+
+    // GPU time of culling and drawing
+    float LastMs() const {
+        return m_Timer.LastMs();
+    }
+
+    float CpuCullMs() const {
+        return m_CpuCullMs;
+    }
+
+    // Sweeps the instance count (and the culling path where both exist), holding every step
+    // for BENCHMARK_FRAMES after BENCHMARK_WARMUP_FRAMES, then writes one CSV row per step.
+    void StartBenchmark(const std::string& csvPath) {
+        m_BenchmarkPath = csvPath;
+        m_BenchmarkSteps.clear();
+        const int counts[] = {10000, 25000, 50000, 100000, 200000, 400000};
+        for (int count : counts) {
+            m_BenchmarkSteps.push_back(BenchmarkStep{count, false});
+            if (IsGpuCullingAvailable())
+                m_BenchmarkSteps.push_back(BenchmarkStep{count, true});
+        }
+        m_BenchmarkRows.clear();
+        m_SavedInstanceCount = InstanceCount;
+        m_SavedGpuCulling = GpuCulling;
+        m_BenchmarkStep = 0;
+        startBenchmarkStep();
+    }
+
+    bool IsBenchmarkRunning() const {
+        return m_BenchmarkStep >= 0;
+    }
+
+    // call once per frame with the duration of the last frame
+    void UpdateBenchmark(float frameSeconds) {
+        if (!IsBenchmarkRunning())
+            return;
+        m_BenchmarkFrame++;
+        if (m_BenchmarkFrame <= BENCHMARK_WARMUP_FRAMES)
+            return;
+        m_BenchmarkFrameMs += frameSeconds * 1000.0;
+        m_BenchmarkGpuMs += LastMs();
+        m_BenchmarkCullMs += CpuCullMs();
+        if (VisibleCount(0) >= 0) {
+            m_BenchmarkVisible += VisibleCount(0) + VisibleCount(1);
+            m_BenchmarkVisibleFrames++;
+        }
+        if (m_BenchmarkFrame < BENCHMARK_WARMUP_FRAMES + BENCHMARK_FRAMES)
+            return;
+
+        const BenchmarkStep& step = m_BenchmarkSteps[m_BenchmarkStep];
+        std::ostringstream row;
+        row << step.Instances << ',' << (step.Gpu ? "gpu" : "cpu") << ','
+            << m_BenchmarkFrameMs / BENCHMARK_FRAMES << ',' << m_BenchmarkGpuMs / BENCHMARK_FRAMES << ','
+            << m_BenchmarkCullMs / BENCHMARK_FRAMES << ',';
+        if (m_BenchmarkVisibleFrames > 0)
+            row << m_BenchmarkVisible / m_BenchmarkVisibleFrames;
+        m_BenchmarkRows.push_back(row.str());
+        std::cout << "[GrassField] " << row.str() << std::endl;
+
+        if (++m_BenchmarkStep < (int) m_BenchmarkSteps.size()) {
+            startBenchmarkStep();
+            return;
+        }
+        std::ofstream out(m_BenchmarkPath);
+        out << "instances,culling,frame_ms,grass_gpu_ms,cpu_cull_ms,visible\n";
+        for (const std::string& line : m_BenchmarkRows)
+            out << line << '\n';
+        std::cout << "[GrassField] benchmark written to " << m_BenchmarkPath << std::endl;
+        InstanceCount = m_SavedInstanceCount;
+        GpuCulling = m_SavedGpuCulling;
+        m_BenchmarkStep = -1;
+    }
+
+    // e.g. "3/12: 25000 instances, gpu"
+    std::string BenchmarkStatus() const {
+        if (!IsBenchmarkRunning())
+            return m_BenchmarkRows.empty() ? "" : "written to " + m_BenchmarkPath;
+        const BenchmarkStep& step = m_BenchmarkSteps[m_BenchmarkStep];
+        return std::to_string(m_BenchmarkStep + 1) + "/" + std::to_string(m_BenchmarkSteps.size()) + ": "
+               + std::to_string(step.Instances) + " instances, " + (step.Gpu ? "gpu" : "cpu");
+    }
+
+private:
+    struct DrawArraysIndirectCommand {
+        GLuint Count;
+        GLuint InstanceCount;
+        GLuint First;
+        GLuint BaseInstance;
+    };
+
+    struct BenchmarkStep {
+        int Instances;
+        bool Gpu;
+    };
+
+    // GPU visible counts of up to this many frames wait for the GPU to finish them
+    static const int COUNT_RING = 4;
+    static const int BENCHMARK_WARMUP_FRAMES = 30;
+    static const int BENCHMARK_FRAMES = 120;
+
+    const GLint m_LodFirst[LOD_COUNT] = {0, 7};
+    const GLsizei m_LodCount[LOD_COUNT] = {7, 3};
+
+    Shader m_Shader;
+    std::unique_ptr<Shader> m_CullShader;
+    unsigned int m_VAO = 0;
+    unsigned int m_BladeVBO = 0;
+    unsigned int m_InstanceBuffer = 0;
+    unsigned int m_VisibleBuffer = 0;
+    // CPU culling results, re-specified every frame
+    unsigned int m_StreamBuffer = 0;
+    unsigned int m_CommandBuffer = 0;
+    // the instance counts of the indirect commands of COUNT_RING frames, a buffer per frame so
+    // reading one never waits for the copy into another, and the fence after each copy
+    unsigned int m_CountBuffers[COUNT_RING] = {};
+    GLsync m_CountFences[COUNT_RING] = {};
+    // frames copied and frames read back
+    int m_CountFrame = 0;
+    int m_CountRead = 0;
+    GLuint m_GpuVisible[LOD_COUNT] = {};
+    bool m_HasGpuVisible = false;
+    GpuTimer m_Timer;
+
+    std::vector<unsigned char> m_Density;
+    int m_DensityWidth = 0;
+    int m_DensityHeight = 0;
+
+    bool m_Generated = false;
+    int m_GeneratedCount = 0;
+    glm::vec3 m_GeneratedCenter = glm::vec3(0.0f);
+    float m_GeneratedSize = 0.0f;
+    float m_GeneratedHeight = 0.0f;
+
+    std::vector<GrassInstance> m_Instances;
+    // bounding spheres as structure of arrays, padded to a multiple of four for the SSE loop
+    std::vector<float> m_CenterX, m_CenterY, m_CenterZ, m_Radius;
+    std::vector<GrassInstance> m_Visible[LOD_COUNT];
+    bool m_LastCullOnGpu = false;
+    float m_CpuCullMs = 0.0f;
+
+    std::string m_BenchmarkPath;
+    std::vector<BenchmarkStep> m_BenchmarkSteps;
+    std::vector<std::string> m_BenchmarkRows;
+    int m_BenchmarkStep = -1;
+    int m_BenchmarkFrame = 0;
+    double m_BenchmarkFrameMs = 0.0;
+    double m_BenchmarkGpuMs = 0.0;
+    double m_BenchmarkCullMs = 0.0;
+    size_t m_BenchmarkVisible = 0;
+    int m_BenchmarkVisibleFrames = 0;
+    int m_SavedInstanceCount = 0;
+    bool m_SavedGpuCulling = true;
+
+    void startBenchmarkStep() {
+        const BenchmarkStep& step = m_BenchmarkSteps[m_BenchmarkStep];
+        InstanceCount = step.Instances;
+        GpuCulling = step.Gpu;
+        m_BenchmarkFrame = 0;
+        m_BenchmarkFrameMs = m_BenchmarkGpuMs = m_BenchmarkCullMs = 0.0;
+        m_BenchmarkVisible = 0;
+        m_BenchmarkVisibleFrames = 0;
+    }
+
+    // the instance attributes start at offset bytes into buffer
+    void setInstanceOffset(unsigned int buffer, size_t offset) {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+        glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, sizeof(GrassInstance),
+                              (void*) (offset + offsetof(GrassInstance, PositionHeight)));
+        glVertexAttribPointer(4, 4, GL_FLOAT, GL_FALSE, sizeof(GrassInstance),
+                              (void*) (offset + offsetof(GrassInstance, Params)));
+    }
+
+    float density(float u, float v) const {
+        if (!m_Density.empty()) {
+            int x = std::min(m_DensityWidth - 1, (int) (u * m_DensityWidth));
+            int y = std::min(m_DensityHeight - 1, (int) (v * m_DensityHeight));
+            return m_Density[y * m_DensityWidth + x] / 255.0f;
+        }
+        // two octaves of value noise, patches of a few meters with bare spots between them
+        float noise = 0.65f * valueNoise(u * 8.0f, v * 8.0f) + 0.35f * valueNoise(u * 23.0f, v * 23.0f);
+        return glm::clamp((noise - 0.3f) * 2.0f, 0.0f, 1.0f);
+    }
+
+    static float hash(int x, int y) {
+        uint32_t h = (uint32_t) x * 374761393u + (uint32_t) y * 668265263u;
+        h = (h ^ (h >> 13)) * 1274126177u;
+        return (h ^ (h >> 16)) / 4294967295.0f;
+    }
+
+    static float valueNoise(float x, float y) {
+        int ix = (int) std::floor(x), iy = (int) std::floor(y);
+        float fx = x - ix, fy = y - iy;
+        fx = fx * fx * (3.0f - 2.0f * fx);
+        fy = fy * fy * (3.0f - 2.0f * fy);
+        float top = glm::mix(hash(ix, iy), hash(ix + 1, iy), fx);
+        float bottom = glm::mix(hash(ix, iy + 1), hash(ix + 1, iy + 1), fx);
+        return glm::mix(top, bottom, fy);
+    }
+
+    // rejection sampling against the density map, fixed seed so the field looks the same every run
+    void regenerate() {
+        std::mt19937 random(1234);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        m_Instances.clear();
+        m_Instances.reserve(InstanceCount);
+        long long attempts = 0, maxAttempts = 50LL * std::max(InstanceCount, 1);
+        while ((int) m_Instances.size() < InstanceCount && attempts++ < maxAttempts) {
+            float u = unit(random), v = unit(random);
+            float d = density(u, v);
+            if (unit(random) >= d)
+                continue;
+            GrassInstance instance;
+            float height = BladeHeight * (0.6f + 0.8f * unit(random)) * (0.5f + 0.5f * d);
+            instance.PositionHeight = glm::vec4(Center.x + (u - 0.5f) * Size, Center.y, Center.z + (v - 0.5f) * Size, height);
+            instance.Params = glm::vec4(unit(random) * 6.2831853f, 0.1f + 0.3f * unit(random),
+                                        0.03f + 0.03f * unit(random), 0.7f + 0.4f * unit(random));
+            m_Instances.push_back(instance);
+        }
+
+        size_t padded = (m_Instances.size() + 3) / 4 * 4;
+        m_CenterX.assign(padded, 0.0f);
+        m_CenterY.assign(padded, 0.0f);
+        m_CenterZ.assign(padded, 0.0f);
+        m_Radius.assign(padded, 0.0f);
+        for (size_t i = 0; i < m_Instances.size(); i++) {
+            const glm::vec4& p = m_Instances[i].PositionHeight;
+            m_CenterX[i] = p.x;
+            m_CenterY[i] = p.y + 0.5f * p.w;
+            m_CenterZ[i] = p.z;
+            m_Radius[i] = 0.6f * p.w;
+        }
+
+        if (IsGpuCullingAvailable()) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_InstanceBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, m_Instances.size() * sizeof(GrassInstance), m_Instances.data(), GL_STATIC_DRAW);
+            // every LOD gets room for all instances
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_VisibleBuffer);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, LOD_COUNT * m_Instances.size() * sizeof(GrassInstance), NULL, GL_DYNAMIC_COPY);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+
+        resetCounts();
+        m_Generated = true;
+        m_GeneratedCount = InstanceCount;
+        m_GeneratedCenter = Center;
+        m_GeneratedSize = Size;
+        m_GeneratedHeight = BladeHeight;
+    }
+
+    void cullOnGpu(const glm::vec4 planes[6], const glm::vec3& cameraPosition) {
+        // counts in the ring from before CPU culling belong to other frames
+        if (!m_LastCullOnGpu)
+            resetCounts();
+        m_LastCullOnGpu = true;
+        m_CpuCullMs = 0.0f;
+        GLuint count = (GLuint) m_Instances.size();
+        // the instance counts start at zero, the LOD regions of the visible buffer are count apart
+        DrawArraysIndirectCommand commands[LOD_COUNT];
+        for (int lod = 0; lod < LOD_COUNT; lod++)
+            commands[lod] = DrawArraysIndirectCommand{(GLuint) m_LodCount[lod], 0, (GLuint) m_LodFirst[lod], lod * count};
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_CommandBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(commands), commands, GL_DYNAMIC_COPY);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        m_CullShader->use();
+        glUniform1ui(glGetUniformLocation(m_CullShader->ID, "instanceCount"), count);
+        glUniform1ui(glGetUniformLocation(m_CullShader->ID, "capacity"), count);
+        glUniform4fv(glGetUniformLocation(m_CullShader->ID, "frustumPlanes"), 6, &planes[0][0]);
+        m_CullShader->setVec3("cameraPosition", cameraPosition);
+        m_CullShader->setFloat("lodDistance", LodDistance);
+        m_CullShader->setFloat("maxDistance", MaxDistance);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_InstanceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, m_VisibleBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, m_CommandBuffer);
+        glDispatchCompute((count + 255) / 256, 1, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+        readCounts();
+    }
+
+    // Reads back every frame whose fence has signalled, oldest first, then copies this frame's
+    // instance counts into the next buffer of the ring. Never waits: a frame the GPU has not
+    // finished stays for later, and when the GPU is COUNT_RING frames behind the oldest is dropped.
+    void readCounts() {
+        while (m_CountRead < m_CountFrame) {
+            int slot = m_CountRead % COUNT_RING;
+            GLenum status = glClientWaitSync(m_CountFences[slot], 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+                break;
+            glBindBuffer(GL_COPY_READ_BUFFER, m_CountBuffers[slot]);
+            glGetBufferSubData(GL_COPY_READ_BUFFER, 0, LOD_COUNT * sizeof(GLuint), m_GpuVisible);
+            glDeleteSync(m_CountFences[slot]);
+            m_CountFences[slot] = 0;
+            m_HasGpuVisible = true;
+            m_CountRead++;
+        }
+        int slot = m_CountFrame % COUNT_RING;
+        if (m_CountFences[slot]) {
+            glDeleteSync(m_CountFences[slot]);
+            m_CountFences[slot] = 0;
+            m_CountRead++;
+        }
+        glBindBuffer(GL_COPY_READ_BUFFER, m_CommandBuffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, m_CountBuffers[slot]);
+        for (int lod = 0; lod < LOD_COUNT; lod++)
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                lod * sizeof(DrawArraysIndirectCommand) + offsetof(DrawArraysIndirectCommand, InstanceCount),
+                                lod * sizeof(GLuint), sizeof(GLuint));
+        m_CountFences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_CountFrame++;
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    void resetCounts() {
+        for (GLsync& fence : m_CountFences)
+            if (fence) {
+                glDeleteSync(fence);
+                fence = 0;
+            }
+        m_CountFrame = 0;
+        m_CountRead = 0;
+        m_HasGpuVisible = false;
+    }
+
+    void cullOnCpu(const glm::vec4 planes[6], const glm::vec3& cameraPosition) {
+        m_LastCullOnGpu = false;
+        auto start = std::chrono::high_resolution_clock::now();
+        for (std::vector<GrassInstance>& visible : m_Visible)
+            visible.clear();
+
+        size_t count = m_Instances.size();
+        float lodDistanceSquared = LodDistance * LodDistance;
+        float maxDistanceSquared = MaxDistance * MaxDistance;
+#ifdef RG_GRASS_FIELD_SSE
+        __m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+        for (int p = 0; p < 6; p++) {
+            planeX[p] = _mm_set1_ps(planes[p].x);
+            planeY[p] = _mm_set1_ps(planes[p].y);
+            planeZ[p] = _mm_set1_ps(planes[p].z);
+            planeW[p] = _mm_set1_ps(planes[p].w);
+        }
+        __m128 cameraX = _mm_set1_ps(cameraPosition.x);
+        __m128 cameraY = _mm_set1_ps(cameraPosition.y);
+        __m128 cameraZ = _mm_set1_ps(cameraPosition.z);
+        __m128 lodLimit = _mm_set1_ps(lodDistanceSquared);
+        __m128 maxLimit = _mm_set1_ps(maxDistanceSquared);
+        __m128 zero = _mm_setzero_ps();
+
+        for (size_t i = 0; i < count; i += 4) {
+            __m128 x = _mm_loadu_ps(&m_CenterX[i]);
+            __m128 y = _mm_loadu_ps(&m_CenterY[i]);
+            __m128 z = _mm_loadu_ps(&m_CenterZ[i]);
+            __m128 negativeRadius = _mm_sub_ps(zero, _mm_loadu_ps(&m_Radius[i]));
+
+            __m128 dx = _mm_sub_ps(x, cameraX);
+            __m128 dy = _mm_sub_ps(y, cameraY);
+            __m128 dz = _mm_sub_ps(z, cameraZ);
+            __m128 distanceSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            __m128 visible = _mm_cmple_ps(distanceSquared, maxLimit);
+            for (int p = 0; p < 6; p++) {
+                __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], x), _mm_mul_ps(planeY[p], y)),
+                                      _mm_add_ps(_mm_mul_ps(planeZ[p], z), planeW[p]));
+                visible = _mm_and_ps(visible, _mm_cmpge_ps(d, negativeRadius));
+            }
+            int visibleMask = _mm_movemask_ps(visible);
+            if (visibleMask == 0)
+                continue;
+            int nearMask = _mm_movemask_ps(_mm_cmplt_ps(distanceSquared, lodLimit));
+            for (int lane = 0; lane < 4 && i + lane < count; lane++)
+                if (visibleMask & (1 << lane))
+                    m_Visible[(nearMask & (1 << lane)) ? 0 : 1].push_back(m_Instances[i + lane]);
+        }
+#else
+        for (size_t i = 0; i < count; i++) {
+            glm::vec3 center(m_CenterX[i], m_CenterY[i], m_CenterZ[i]);
+            glm::vec3 toCamera = center - cameraPosition;
+            float distanceSquared = glm::dot(toCamera, toCamera);
+            bool visible = distanceSquared <= maxDistanceSquared;
+            for (int p = 0; p < 6 && visible; p++)
+                visible = glm::dot(glm::vec3(planes[p]), center) + planes[p].w >= -m_Radius[i];
+            if (visible)
+                m_Visible[distanceSquared < lodDistanceSquared ? 0 : 1].push_back(m_Instances[i]);
+        }
+#endif
+        m_CpuCullMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+        // orphan the buffer so the upload never waits for last frame's draws
+        size_t bytes = (m_Visible[0].size() + m_Visible[1].size()) * sizeof(GrassInstance);
+        glBindBuffer(GL_ARRAY_BUFFER, m_StreamBuffer);
+        glBufferData(GL_ARRAY_BUFFER, bytes, NULL, GL_STREAM_DRAW);
+        size_t offset = 0;
+        for (const std::vector<GrassInstance>& visible : m_Visible) {
+            if (!visible.empty())
+                glBufferSubData(GL_ARRAY_BUFFER, offset, visible.size() * sizeof(GrassInstance), visible.data());
+            offset += visible.size() * sizeof(GrassInstance);
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+};
+
+}
+#endif //PROJECT_BASE_GRASSFIELD_H
@@ -0,0 +1,139 @@
+#ifndef PROJECT_BASE_HEADLESS_H
+#define PROJECT_BASE_HEADLESS_H
+
+#include <glad/glad.h>
+
+#include <iostream>
+
+#ifdef RG_HEADLESS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+#ifndef EGL_PLATFORM_SURFACELESS_MESA
+#define EGL_PLATFORM_SURFACELESS_MESA 0x31DD
+#endif
+#endif
+
+namespace rg {
+
+// OpenGL context without a window for the --benchmark mode. It is an EGL context made current
+// with no surface (EGL_MESA_platform_surfaceless, falling back to the default display), so it
+// also runs on render nodes and on Mesa llvmpipe without any GPU or display server.
+// With no default framebuffer, the frame ends in an RGBA8 renderbuffer the size of the
+// window it replaces: Framebuffer() is what the frame graph imports as the backbuffer.
+// Without RG_HEADLESS_EGL (CMake found no EGL) IsAvailable() is false and the caller uses a
+// hidden GLFW window instead. debug asks for a debug context, for rg::DebugOutput.
+class HeadlessContext {
+public:
+    HeadlessContext(unsigned int width, unsigned int height, bool debug = false) {
+#ifdef RG_HEADLESS_EGL
+        PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+            (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+        if (getPlatformDisplay)
+            m_Display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+        if (m_Display == EGL_NO_DISPLAY)
+            m_Display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        EGLint major, minor;
+        if (m_Display == EGL_NO_DISPLAY || !eglInitialize(m_Display, &major, &minor)) {
+            std::cout << "ERROR::HEADLESS:: No EGL display" << std::endl;
+            m_Display = EGL_NO_DISPLAY;
+            return;
+        }
+        eglBindAPI(EGL_OPENGL_API);
+
+        const EGLint configAttributes[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8, EGL_ALPHA_SIZE, 8,
+            EGL_NONE
+        };
+        EGLConfig config;
+        EGLint configCount = 0;
+        if (!eglChooseConfig(m_Display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+            std::cout << "ERROR::HEADLESS:: No EGL config with desktop OpenGL" << std::endl;
+            return;
+        }
+        // 4.3 enables the compute paths, everything else still runs on 3.3, same as the window
+        for (EGLint majorVersion : {4, 3}) {
+            const EGLint contextAttributes[] = {
+                EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+                EGL_CONTEXT_MINOR_VERSION, 3,
+                EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+                EGL_CONTEXT_OPENGL_DEBUG, debug ? EGL_TRUE : EGL_FALSE,
+                EGL_NONE
+            };
+            m_Context = eglCreateContext(m_Display, config, EGL_NO_CONTEXT, contextAttributes);
+            if (m_Context != EGL_NO_CONTEXT)
+                break;
+        }
+        if (m_Context == EGL_NO_CONTEXT || !eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, m_Context)) {
+            std::cout << "ERROR::HEADLESS:: Could not make a surfaceless OpenGL context current" << std::endl;
+            return;
+        }
+        if (!gladLoadGLLoader((GLADloadproc) eglGetProcAddress)) {
+            std::cout << "ERROR::HEADLESS:: Failed to initialize GLAD" << std::endl;
+            return;
+        }
+
+        glGenRenderbuffers(1, &m_Color);
+        glBindRenderbuffer(GL_RENDERBUFFER, m_Color);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        glGenFramebuffers(1, &m_Framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, m_Framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_Color);
+        m_Available = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+        if (!m_Available)
+            std::cout << "ERROR::HEADLESS:: Offscreen backbuffer is not complete!" << std::endl;
+        glViewport(0, 0, width, height);
+#endif
+    }
+
+    ~HeadlessContext() {
+#ifdef RG_HEADLESS_EGL
+        if (m_Framebuffer) {
+            glDeleteFramebuffers(1, &m_Framebuffer);
+            glDeleteRenderbuffers(1, &m_Color);
+        }
+        if (m_Display != EGL_NO_DISPLAY) {
+            eglMakeCurrent(m_Display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (m_Context != EGL_NO_CONTEXT)
+                eglDestroyContext(m_Display, m_Context);
+            eglTerminate(m_Display);
+        }
+#endif
+    }
+
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+    // the context is current and glad is loaded
+    bool IsAvailable() const {
+        return m_Available;
+    }
+
+    // the loader for rg::loadGLExtensions
+    static GLADloadproc Loader() {
+#ifdef RG_HEADLESS_EGL
+        return (GLADloadproc) eglGetProcAddress;
+#else
+        return NULL;
+#endif
+    }
+
+    unsigned int Framebuffer() const {
+        return m_Framebuffer;
+    }
+
+private:
+#ifdef RG_HEADLESS_EGL
+    EGLDisplay m_Display = EGL_NO_DISPLAY;
+    EGLContext m_Context = EGL_NO_CONTEXT;
+#endif
+    unsigned int m_Framebuffer = 0;
+    unsigned int m_Color = 0;
+    bool m_Available = false;
+};
+
+}
+#endif //PROJECT_BASE_HEADLESS_H
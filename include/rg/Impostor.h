@@ -0,0 +1,239 @@
+#ifndef PROJECT_BASE_IMPOSTOR_H
+#define PROJECT_BASE_IMPOSTOR_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include <learnopengl/model.h>
+#include <learnopengl/shader.h>
+#include <rg/GpuTimer.h>
+
+namespace rg {
+
+// Octahedral impostor of a Model. At construction the model is rendered orthographically from
+// frames x frames directions spread over the whole sphere by an octahedral mapping, into an
+// albedo atlas (rgb, coverage in alpha) and a normal and depth atlas (model space normal,
+// depth along the view direction in alpha, 0.5 on the plane through the bounding sphere
+// center). Every instance is then a single camera facing quad: impostor.vs projects the
+// camera ray of each corner into the four frames nearest the view direction, impostor.fs
+// blends them bilinearly, lights the blended normal and moves the fragment depth by the
+// baked depth, so impostors still intersect the scene correctly.
+// The model must already have its texture name prefix set, the bake draws it with it.
+class Impostor {
+public:
+    // per-instance data, attributes 3 to 7 of impostor.vs
+    struct Instance {
+        glm::mat4 Transform;
+        // the dither fade of clock.fs, 1 draws the whole impostor
+        float Fade;
+    };
+
+    explicit Impostor(Model& model, int frames = 12, int frameSize = 128)
+        : m_Shader("resources/shaders/impostor.vs", "resources/shaders/impostor.fs"), m_Frames(frames), m_FrameSize(frameSize) {
+        glm::vec3 low(0.0f), high(0.0f);
+        bool first = true;
+        for (const Mesh& mesh : model.meshes)
+            for (const Vertex& vertex : mesh.vertices) {
+                low = first ? vertex.Position : glm::min(low, vertex.Position);
+                high = first ? vertex.Position : glm::max(high, vertex.Position);
+                first = false;
+            }
+        glm::vec3 center = 0.5f * (low + high);
+        float radius = 0.0f;
+        for (const Mesh& mesh : model.meshes)
+            for (const Vertex& vertex : mesh.vertices)
+                radius = std::max(radius, glm::length(vertex.Position - center));
+        m_Sphere = glm::vec4(center, std::max(radius, 1e-4f));
+
+        bake(model);
+
+        const float corners[] = {-1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f};
+        glGenVertexArrays(1, &m_VAO);
+        glGenBuffers(1, &m_QuadVBO);
+        glGenBuffers(1, &m_InstanceVBO);
+        glBindVertexArray(m_VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_QuadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(corners), corners, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*) 0);
+        glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+        for (int column = 0; column < 4; column++) {
+            glEnableVertexAttribArray(3 + column);
+            glVertexAttribPointer(3 + column, 4, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*) (column * sizeof(glm::vec4)));
+            glVertexAttribDivisor(3 + column, 1);
+        }
+        glEnableVertexAttribArray(7);
+        glVertexAttribPointer(7, 1, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*) offsetof(Instance, Fade));
+        glVertexAttribDivisor(7, 1);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_Shader.use();
+        m_Shader.setInt("albedoAtlas", 0);
+        m_Shader.setInt("normalDepthAtlas", 1);
+    }
+
+    ~Impostor() {
+        glDeleteVertexArrays(1, &m_VAO);
+        glDeleteBuffers(1, &m_QuadVBO);
+        glDeleteBuffers(1, &m_InstanceVBO);
+        glDeleteTextures(1, &m_AlbedoAtlas);
+        glDeleteTextures(1, &m_NormalDepthAtlas);
+    }
+
+    Impostor(const Impostor&) = delete;
+    Impostor& operator=(const Impostor&) = delete;
+
+    // uniforms the impostor does not set itself, the point light and the view position
+    Shader& GetShader() {
+        return m_Shader;
+    }
+
+    // the instances are collected anew every frame
+    void Clear() {
+        m_Instances.clear();
+    }
+
+    void AddInstance(const glm::mat4& transform, float fade = 1.0f) {
+        m_Instances.push_back(Instance{transform, fade});
+    }
+
+    int InstanceCount() const {
+        return (int) m_Instances.size();
+    }
+
+    // GPU time of the last drawn frame
+    float LastMs() const {
+        return m_Timer.LastMs();
+    }
+
+    void Draw(const glm::mat4& projection, const glm::mat4& view, const glm::vec3& cameraPosition) {
+        if (m_Instances.empty())
+            return;
+        m_Timer.Begin();
+        // orphan the buffer so the upload never waits for last frame's draws
+        glBindBuffer(GL_ARRAY_BUFFER, m_InstanceVBO);
+        glBufferData(GL_ARRAY_BUFFER, m_Instances.size() * sizeof(Instance), m_Instances.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        m_Shader.use();
+        m_Shader.setMat4("projection", projection);
+        m_Shader.setMat4("view", view);
+        m_Shader.setVec3("cameraPosition", cameraPosition);
+        m_Shader.setVec4("sphere", m_Sphere);
+        m_Shader.setInt("frames", m_Frames);
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, m_AlbedoAtlas);
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, m_NormalDepthAtlas);
+        glActiveTexture(GL_TEXTURE0);
+
+        glBindVertexArray(m_VAO);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei) m_Instances.size());
+        glBindVertexArray(0);
+        m_Timer.End();
+    }
+
+    // Direction from the model toward the camera of frame (x, y): the grid points of the
+    // octahedral map, y up, the lower hemisphere folded over the corners. impostor.vs has the
+    // same mapping.
+    static glm::vec3 FrameDirection(int x, int y, int frames) {
+        glm::vec2 p = glm::vec2((float) x, (float) y) / (float) (frames - 1) * 2.0f - 1.0f;
+        glm::vec3 n(p.x, 1.0f - std::fabs(p.x) - std::fabs(p.y), p.y);
+        if (n.y < 0.0f) {
+            float nx = (1.0f - std::fabs(n.z)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+            float nz = (1.0f - std::fabs(n.x)) * (n.z >= 0.0f ? 1.0f : -1.0f);
+            n.x = nx;
+            n.z = nz;
+        }
+        return glm::normalize(n);
+    }
+
+private:
+    Shader m_Shader;
+    int m_Frames;
+    int m_FrameSize;
+    glm::vec4 m_Sphere;
+    unsigned int m_AlbedoAtlas = 0;
+    unsigned int m_NormalDepthAtlas = 0;
+    unsigned int m_VAO = 0;
+    unsigned int m_QuadVBO = 0;
+    unsigned int m_InstanceVBO = 0;
+    std::vector<Instance> m_Instances;
+    GpuTimer m_Timer;
+
+    void bake(Model& model) {
+        GLint viewport[4];
+        GLint framebuffer;
+        GLfloat clearColor[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        glGetIntegerv(GL_FRAMEBUFFER_BINDING, &framebuffer);
+        glGetFloatv(GL_COLOR_CLEAR_VALUE, clearColor);
+
+        int size = m_Frames * m_FrameSize;
+        for (unsigned int* atlas : {&m_AlbedoAtlas, &m_NormalDepthAtlas}) {
+            glGenTextures(1, atlas);
+            glBindTexture(GL_TEXTURE_2D, *atlas);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        unsigned int fbo, depth;
+        glGenFramebuffers(1, &fbo);
+        glGenRenderbuffers(1, &depth);
+        glBindRenderbuffer(GL_RENDERBUFFER, depth);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size, size);
+        glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_AlbedoAtlas, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_NormalDepthAtlas, 0);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+        const GLenum attachments[] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+        glDrawBuffers(2, attachments);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::IMPOSTOR:: Bake framebuffer is not complete!" << std::endl;
+
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glEnable(GL_DEPTH_TEST);
+        glDisable(GL_CULL_FACE);
+
+        Shader bakeShader("resources/shaders/impostor_bake.vs", "resources/shaders/impostor_bake.fs");
+        bakeShader.use();
+        glm::vec3 center(m_Sphere);
+        float radius = m_Sphere.w;
+        // the camera sits two radii out, the sphere spans the frame and the depth range
+        bakeShader.setMat4("projection", glm::ortho(-radius, radius, -radius, radius, radius, 3.0f * radius));
+        bakeShader.setFloat("radius", radius);
+        for (int y = 0; y < m_Frames; y++)
+            for (int x = 0; x < m_Frames; x++) {
+                glm::vec3 direction = FrameDirection(x, y, m_Frames);
+                glm::vec3 up = std::fabs(direction.y) > 0.999f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+                bakeShader.setMat4("view", glm::lookAt(center + 2.0f * radius * direction, center, up));
+                glViewport(x * m_FrameSize, y * m_FrameSize, m_FrameSize, m_FrameSize);
+                model.Draw(bakeShader);
+            }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &depth);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+        glClearColor(clearColor[0], clearColor[1], clearColor[2], clearColor[3]);
+        for (unsigned int atlas : {m_AlbedoAtlas, m_NormalDepthAtlas}) {
+            glBindTexture(GL_TEXTURE_2D, atlas);
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+};
+
+}
+#endif //PROJECT_BASE_IMPOSTOR_H
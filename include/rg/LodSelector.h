@@ -0,0 +1,134 @@
+#ifndef PROJECT_BASE_LODSELECTOR_H
+#define PROJECT_BASE_LODSELECTOR_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <learnopengl/model.h>
+
+namespace rg {
+
+// Picks a level of detail of a Model per instance from the projected screen-space error: the
+// coarsest level whose error covers at most MaxPixelError pixels. A change of level starts a
+// cross-fade of FadeSeconds during which both levels are drawn with complementary dither
+// patterns (clock.fs), so the switch never pops in a single frame.
+// With ImpostorPixels set, instances smaller than that on screen go one level past the
+// coarsest mesh, ImpostorLevel(), which the caller draws as an rg::Impostor.
+class LodSelector {
+public:
+    struct State {
+        int Current = 0;
+        int Previous = 0;
+        // 0 .. 1 through a transition, 1 when settled
+        float Fade = 1.0f;
+    };
+
+    bool Enabled = true;
+    float MaxPixelError = 1.0f;
+    float FadeSeconds = 0.3f;
+    // bounding sphere diameter in pixels below which the impostor is used, 0 never does
+    float ImpostorPixels = 0.0f;
+
+    explicit LodSelector(const Model& model) {
+        for (int lod = 0; lod < model.LodCount(); lod++) {
+            m_Errors.push_back(model.LodError(lod));
+            m_Triangles.push_back(model.LodTriangleCount(lod));
+        }
+        // the impostor quad
+        m_Triangles.push_back(2);
+        // a sphere around all vertices, relative to the model origin
+        for (const Mesh& mesh : model.meshes)
+            for (const Vertex& vertex : mesh.vertices)
+                m_Radius = std::max(m_Radius, glm::length(vertex.Position));
+    }
+
+    // Call once per frame before Update() with the camera of the frame. fovY is in radians,
+    // viewportHeight is the rendered height in pixels.
+    void BeginFrame(const glm::vec3& cameraPosition, float fovY, float viewportHeight, float deltaTime, int instanceCount) {
+        m_CameraPosition = cameraPosition;
+        m_PixelsPerUnit = viewportHeight / (2.0f * std::tan(0.5f * fovY));
+        m_DeltaTime = deltaTime;
+        m_States.resize(instanceCount);
+        m_DrawnTriangles = 0;
+        m_FullTriangles = 0;
+    }
+
+    const State& Update(int instance, const glm::mat4& transform) {
+        State& state = m_States[instance];
+        float scale = std::max(glm::length(glm::vec3(transform[0])),
+                               std::max(glm::length(glm::vec3(transform[1])), glm::length(glm::vec3(transform[2]))));
+        float centerDistance = glm::length(glm::vec3(transform[3]) - m_CameraPosition);
+        float distance = std::max(centerDistance - m_Radius * scale, 0.1f);
+        int target = 0;
+        if (Enabled)
+            while (target + 1 < (int) m_Errors.size()
+                   && m_Errors[target + 1] * scale / distance * m_PixelsPerUnit <= MaxPixelError)
+                target++;
+        if (Enabled && ImpostorPixels > 0.0f && 2.0f * m_Radius * scale / std::max(centerDistance, 0.1f) * m_PixelsPerUnit < ImpostorPixels)
+            target = ImpostorLevel();
+
+        if (state.Fade >= 1.0f && target != state.Current) {
+            state.Previous = state.Current;
+            state.Current = target;
+            state.Fade = 0.0f;
+        }
+        if (state.Fade < 1.0f)
+            state.Fade = FadeSeconds > 0.0f ? std::min(1.0f, state.Fade + m_DeltaTime / FadeSeconds) : 1.0f;
+        if (state.Fade >= 1.0f)
+            state.Previous = state.Current;
+
+        m_FullTriangles += m_Triangles[0];
+        m_DrawnTriangles += m_Triangles[state.Current];
+        if (state.Previous != state.Current)
+            m_DrawnTriangles += m_Triangles[state.Previous];
+        return state;
+    }
+
+    // the state the last Update() left instance in
+    const State& GetState(int instance) const {
+        return m_States[instance];
+    }
+
+    // mesh levels, the impostor not counted
+    int LodCount() const {
+        return (int) m_Errors.size();
+    }
+
+    int ImpostorLevel() const {
+        return (int) m_Errors.size();
+    }
+
+    // triangles of this frame's Update() calls, drawn and at full detail
+    unsigned int DrawnTriangles() const {
+        return m_DrawnTriangles;
+    }
+
+    unsigned int FullTriangles() const {
+        return m_FullTriangles;
+    }
+
+    // instances at every level this frame, the impostor last
+    std::vector<int> Histogram() const {
+        std::vector<int> histogram(m_Errors.size() + 1, 0);
+        for (const State& state : m_States)
+            histogram[state.Current]++;
+        return histogram;
+    }
+
+private:
+    std::vector<float> m_Errors;
+    std::vector<unsigned int> m_Triangles;
+    float m_Radius = 0.0f;
+    std::vector<State> m_States;
+    glm::vec3 m_CameraPosition = glm::vec3(0.0f);
+    float m_PixelsPerUnit = 1.0f;
+    float m_DeltaTime = 0.0f;
+    unsigned int m_DrawnTriangles = 0;
+    unsigned int m_FullTriangles = 0;
+};
+
+}
+#endif //PROJECT_BASE_LODSELECTOR_H
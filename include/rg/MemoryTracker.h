@@ -0,0 +1,363 @@
+#ifndef PROJECT_BASE_MEMORYTRACKER_H
+#define PROJECT_BASE_MEMORYTRACKER_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace rg {
+
+// Accounts the GPU memory of every buffer, texture and renderbuffer. Like rg::DrawCounter it
+// swaps the glad entry points that allocate and free them for wrappers, so no allocation site
+// has to report itself. Every resource is tagged with Tag when it is (re)allocated: a Model
+// tags with its name while it loads, the frame graph with the name of the pass, main with the
+// subsystem it builds. CPU side copies kept next to the GPU data (a model's vertices and
+// indices) are reported by their owner with SetCpuBytes().
+// Sizes are what the data needs, not what the driver allocates: three channel formats count
+// as four, mip chains as every level down to 1x1, alignment and compression are ignored.
+// The bound buffer is tracked through glBindBuffer, the bound texture, renderbuffer and
+// element buffer (part of the VAO) are queried when they are allocated, which only happens
+// while loading and on resize.
+class MemoryTracker {
+public:
+    enum Kind {
+        BUFFER,
+        TEXTURE,
+        RENDERBUFFER,
+        KIND_COUNT
+    };
+
+    struct Resource {
+        Kind Type;
+        unsigned int Id;
+        std::string Tag;
+        size_t Bytes;
+        // texels of level 0, 0 for buffers
+        int Width;
+        int Height;
+    };
+
+    struct Usage {
+        size_t Bytes[KIND_COUNT] = {};
+        size_t CpuBytes = 0;
+
+        size_t GpuBytes() const {
+            return Bytes[BUFFER] + Bytes[TEXTURE] + Bytes[RENDERBUFFER];
+        }
+    };
+
+    // sets Tag until the scope ends, scopes nest
+    class Scope {
+    public:
+        explicit Scope(const std::string& tag)
+            : m_Previous(Tag) {
+            Tag = tag;
+        }
+
+        ~Scope() {
+            Tag = m_Previous;
+        }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        std::string m_Previous;
+    };
+
+    // what resources allocated now are accounted to
+    static std::string Tag;
+
+    static const char* Name(Kind kind) {
+        static const char* names[KIND_COUNT] = {"buffer", "texture", "renderbuffer"};
+        return names[kind];
+    }
+
+    // install once, after gladLoadGLLoader
+    static void Install() {
+        if (s_BufferData)
+            return;
+        s_BindBuffer = glad_glBindBuffer;
+        s_BindBufferBase = glad_glBindBufferBase;
+        s_BindBufferRange = glad_glBindBufferRange;
+        s_BufferData = glad_glBufferData;
+        s_DeleteBuffers = glad_glDeleteBuffers;
+        s_TexImage2D = glad_glTexImage2D;
+        s_GenerateMipmap = glad_glGenerateMipmap;
+        s_DeleteTextures = glad_glDeleteTextures;
+        s_RenderbufferStorage = glad_glRenderbufferStorage;
+        s_RenderbufferStorageMultisample = glad_glRenderbufferStorageMultisample;
+        s_DeleteRenderbuffers = glad_glDeleteRenderbuffers;
+        glad_glBindBuffer = bindBuffer;
+        glad_glBindBufferBase = bindBufferBase;
+        glad_glBindBufferRange = bindBufferRange;
+        glad_glBufferData = bufferData;
+        glad_glDeleteBuffers = deleteBuffers;
+        glad_glTexImage2D = texImage2D;
+        glad_glGenerateMipmap = generateMipmap;
+        glad_glDeleteTextures = deleteTextures;
+        glad_glRenderbufferStorage = renderbufferStorage;
+        glad_glRenderbufferStorageMultisample = renderbufferStorageMultisample;
+        glad_glDeleteRenderbuffers = deleteRenderbuffers;
+    }
+
+    // bytes the owner of tag keeps on the CPU, replaces what was set before
+    static void SetCpuBytes(const std::string& tag, size_t bytes) {
+        s_CpuBytes[tag] = bytes;
+    }
+
+    static Usage Total() {
+        Usage total;
+        for (int kind = 0; kind < KIND_COUNT; kind++)
+            for (const auto& entry : s_Resources[kind])
+                total.Bytes[kind] += entry.second.Bytes();
+        for (const auto& cpu : s_CpuBytes)
+            total.CpuBytes += cpu.second;
+        return total;
+    }
+
+    static std::map<std::string, Usage> ByTag() {
+        std::map<std::string, Usage> tags;
+        for (int kind = 0; kind < KIND_COUNT; kind++)
+            for (const auto& entry : s_Resources[kind])
+                tags[entry.second.Tag].Bytes[kind] += entry.second.Bytes();
+        for (const auto& cpu : s_CpuBytes)
+            tags[cpu.first].CpuBytes += cpu.second;
+        return tags;
+    }
+
+    // the count largest resources, largest first
+    static std::vector<Resource> Largest(size_t count) {
+        std::vector<Resource> resources;
+        for (int kind = 0; kind < KIND_COUNT; kind++)
+            for (const auto& entry : s_Resources[kind])
+                resources.push_back(Resource{(Kind) kind, entry.first, entry.second.Tag, entry.second.Bytes(),
+                                             entry.second.Width, entry.second.Height});
+        count = std::min(count, resources.size());
+        std::partial_sort(resources.begin(), resources.begin() + count, resources.end(),
+                          [](const Resource& a, const Resource& b) { return a.Bytes > b.Bytes; });
+        resources.resize(count);
+        return resources;
+    }
+
+    // highest GPU total since Install()
+    static size_t PeakGpuBytes() {
+        return s_PeakGpuBytes;
+    }
+
+    static size_t BytesPerTexel(GLenum internalFormat) {
+        switch (internalFormat) {
+            case GL_RED: case GL_R8: case GL_STENCIL_INDEX8: return 1;
+            case GL_RG: case GL_RG8: case GL_R16: case GL_R16F: return 2;
+            case GL_RGBA16F: case GL_RGB16F: case GL_RG32F: case GL_RGBA16: return 8;
+            case GL_RGBA32F: case GL_RGB32F: return 16;
+        }
+        // GL_RGB(A)8, sRGB, 32 bit single channel, packed float and depth formats
+        return 4;
+    }
+
+private:
+    struct Entry {
+        std::string Tag;
+        // buffers and renderbuffers
+        size_t Size = 0;
+        int Width = 0;
+        int Height = 0;
+        // textures, their size follows from the texel size and the mip chain
+        size_t BytesPerTexel = 0;
+        int Faces = 1;
+        bool Mipmapped = false;
+
+        size_t Bytes() const {
+            if (!BytesPerTexel)
+                return Size;
+            size_t bytes = 0;
+            int width = Width, height = Height;
+            while (width > 0 && height > 0) {
+                bytes += (size_t) width * height * BytesPerTexel * Faces;
+                if (!Mipmapped || (width == 1 && height == 1))
+                    break;
+                width = std::max(1, width / 2);
+                height = std::max(1, height / 2);
+            }
+            return bytes;
+        }
+    };
+
+    static std::map<unsigned int, Entry> s_Resources[KIND_COUNT];
+    static std::map<std::string, size_t> s_CpuBytes;
+    static std::map<GLenum, GLuint> s_BufferBindings;
+    static size_t s_GpuBytes;
+    static size_t s_PeakGpuBytes;
+
+    static PFNGLBINDBUFFERPROC s_BindBuffer;
+    static PFNGLBINDBUFFERBASEPROC s_BindBufferBase;
+    static PFNGLBINDBUFFERRANGEPROC s_BindBufferRange;
+    static PFNGLBUFFERDATAPROC s_BufferData;
+    static PFNGLDELETEBUFFERSPROC s_DeleteBuffers;
+    static PFNGLTEXIMAGE2DPROC s_TexImage2D;
+    static PFNGLGENERATEMIPMAPPROC s_GenerateMipmap;
+    static PFNGLDELETETEXTURESPROC s_DeleteTextures;
+    static PFNGLRENDERBUFFERSTORAGEPROC s_RenderbufferStorage;
+    static PFNGLRENDERBUFFERSTORAGEMULTISAMPLEPROC s_RenderbufferStorageMultisample;
+    static PFNGLDELETERENDERBUFFERSPROC s_DeleteRenderbuffers;
+
+    // the entry is replaced in place, the running total follows its size
+    static void update(Kind kind, unsigned int id, const Entry& entry) {
+        if (!id)
+            return;
+        auto it = s_Resources[kind].find(id);
+        if (it != s_Resources[kind].end())
+            s_GpuBytes -= it->second.Bytes();
+        s_Resources[kind][id] = entry;
+        s_GpuBytes += entry.Bytes();
+        s_PeakGpuBytes = std::max(s_PeakGpuBytes, s_GpuBytes);
+    }
+
+    static void erase(Kind kind, GLsizei n, const GLuint* ids) {
+        for (GLsizei i = 0; i < n; i++) {
+            auto it = s_Resources[kind].find(ids[i]);
+            if (it == s_Resources[kind].end())
+                continue;
+            s_GpuBytes -= it->second.Bytes();
+            s_Resources[kind].erase(it);
+        }
+    }
+
+    static GLuint bound(GLenum binding) {
+        GLint id = 0;
+        glGetIntegerv(binding, &id);
+        return (GLuint) id;
+    }
+
+    static GLuint boundBuffer(GLenum target) {
+        if (target == GL_ELEMENT_ARRAY_BUFFER)
+            return bound(GL_ELEMENT_ARRAY_BUFFER_BINDING);
+        auto it = s_BufferBindings.find(target);
+        return it != s_BufferBindings.end() ? it->second : 0;
+    }
+
+    // 0 for targets that are not accounted
+    static GLuint boundTexture(GLenum target) {
+        if (target == GL_TEXTURE_2D)
+            return bound(GL_TEXTURE_BINDING_2D);
+        if (target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
+            return bound(GL_TEXTURE_BINDING_CUBE_MAP);
+        return 0;
+    }
+
+    static void APIENTRY bindBuffer(GLenum target, GLuint buffer) {
+        s_BufferBindings[target] = buffer;
+        s_BindBuffer(target, buffer);
+    }
+
+    // indexed binds set the generic binding point too
+    static void APIENTRY bindBufferBase(GLenum target, GLuint index, GLuint buffer) {
+        s_BufferBindings[target] = buffer;
+        s_BindBufferBase(target, index, buffer);
+    }
+
+    static void APIENTRY bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size) {
+        s_BufferBindings[target] = buffer;
+        s_BindBufferRange(target, index, buffer, offset, size);
+    }
+
+    static void APIENTRY bufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+        Entry entry;
+        entry.Tag = Tag;
+        entry.Size = (size_t) size;
+        update(BUFFER, boundBuffer(target), entry);
+        s_BufferData(target, size, data, usage);
+    }
+
+    static void APIENTRY deleteBuffers(GLsizei n, const GLuint* buffers) {
+        erase(BUFFER, n, buffers);
+        for (auto& binding : s_BufferBindings)
+            for (GLsizei i = 0; i < n; i++)
+                if (binding.second == buffers[i])
+                    binding.second = 0;
+        s_DeleteBuffers(n, buffers);
+    }
+
+    static void APIENTRY texImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                                    GLint border, GLenum format, GLenum type, const void* pixels) {
+        GLuint id = boundTexture(target);
+        if (id) {
+            auto it = s_Resources[TEXTURE].find(id);
+            Entry entry = it != s_Resources[TEXTURE].end() ? it->second : Entry();
+            if (level == 0) {
+                entry.Tag = Tag;
+                entry.Width = width;
+                entry.Height = height;
+                entry.BytesPerTexel = BytesPerTexel((GLenum) internalFormat);
+                entry.Faces = target == GL_TEXTURE_2D ? 1 : 6;
+            } else {
+                entry.Mipmapped = true;
+            }
+            update(TEXTURE, id, entry);
+        }
+        s_TexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+    }
+
+    static void APIENTRY generateMipmap(GLenum target) {
+        GLuint id = boundTexture(target == GL_TEXTURE_CUBE_MAP ? GL_TEXTURE_CUBE_MAP_POSITIVE_X : target);
+        auto it = s_Resources[TEXTURE].find(id);
+        if (it != s_Resources[TEXTURE].end()) {
+            Entry entry = it->second;
+            entry.Mipmapped = true;
+            update(TEXTURE, id, entry);
+        }
+        s_GenerateMipmap(target);
+    }
+
+    static void APIENTRY deleteTextures(GLsizei n, const GLuint* textures) {
+        erase(TEXTURE, n, textures);
+        s_DeleteTextures(n, textures);
+    }
+
+    static void APIENTRY renderbufferStorage(GLenum target, GLenum internalFormat, GLsizei width, GLsizei height) {
+        renderbufferStorageMultisample(target, 0, internalFormat, width, height);
+    }
+
+    static void APIENTRY renderbufferStorageMultisample(GLenum target, GLsizei samples, GLenum internalFormat, GLsizei width, GLsizei height) {
+        Entry entry;
+        entry.Tag = Tag;
+        entry.Size = (size_t) width * height * BytesPerTexel(internalFormat) * std::max(1, (int) samples);
+        entry.Width = width;
+        entry.Height = height;
+        update(RENDERBUFFER, bound(GL_RENDERBUFFER_BINDING), entry);
+        if (samples > 0)
+            s_RenderbufferStorageMultisample(target, samples, internalFormat, width, height);
+        else
+            s_RenderbufferStorage(target, internalFormat, width, height);
+    }
+
+    static void APIENTRY deleteRenderbuffers(GLsizei n, const GLuint* renderbuffers) {
+        erase(RENDERBUFFER, n, renderbuffers);
+        s_DeleteRenderbuffers(n, renderbuffers);
+    }
+};
+
+std::string MemoryTracker::Tag = "untagged";
+std::map<unsigned int, MemoryTracker::Entry> MemoryTracker::s_Resources[MemoryTracker::KIND_COUNT];
+std::map<std::string, size_t> MemoryTracker::s_CpuBytes;
+std::map<GLenum, GLuint> MemoryTracker::s_BufferBindings;
+size_t MemoryTracker::s_GpuBytes = 0;
+size_t MemoryTracker::s_PeakGpuBytes = 0;
+PFNGLBINDBUFFERPROC MemoryTracker::s_BindBuffer = NULL;
+PFNGLBINDBUFFERBASEPROC MemoryTracker::s_BindBufferBase = NULL;
+PFNGLBINDBUFFERRANGEPROC MemoryTracker::s_BindBufferRange = NULL;
+PFNGLBUFFERDATAPROC MemoryTracker::s_BufferData = NULL;
+PFNGLDELETEBUFFERSPROC MemoryTracker::s_DeleteBuffers = NULL;
+PFNGLTEXIMAGE2DPROC MemoryTracker::s_TexImage2D = NULL;
+PFNGLGENERATEMIPMAPPROC MemoryTracker::s_GenerateMipmap = NULL;
+PFNGLDELETETEXTURESPROC MemoryTracker::s_DeleteTextures = NULL;
+PFNGLRENDERBUFFERSTORAGEPROC MemoryTracker::s_RenderbufferStorage = NULL;
+PFNGLRENDERBUFFERSTORAGEMULTISAMPLEPROC MemoryTracker::s_RenderbufferStorageMultisample = NULL;
+PFNGLDELETERENDERBUFFERSPROC MemoryTracker::s_DeleteRenderbuffers = NULL;
+
+}
+#endif //PROJECT_BASE_MEMORYTRACKER_H
@@ -0,0 +1,244 @@
+#ifndef PROJECT_BASE_MESHSIMPLIFIER_H
+#define PROJECT_BASE_MESHSIMPLIFIER_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace rg {
+
+// Quadric error metric simplification (Garland and Heckbert 1997). Edges collapse onto one of
+// their existing vertices, so the result indexes the original vertex buffer and every vertex
+// keeps its own normal and texture coordinates.
+//  - Topology works on positions: vertices with equal position, normal and texture
+//    coordinates are one wedge (importers without vertex joining give every face corner its
+//    own vertex), and the wedges at one position are one topological vertex.
+//  - A collapse moves every wedge at From onto the wedge at To of a triangle they share. One
+//    with no such triangle (collapsing across a UV or normal seam) would take attributes from
+//    the other side, so the collapse is rejected; along the seam every side has its own.
+//  - Vertices on open borders never move, which keeps open edges in place.
+//  - A collapse is rejected when it turns any neighbouring triangle by more than 60 degrees.
+//  - Collapses happen cheapest first in passes of independent edges until the index count
+//    reaches targetIndexCount or nothing can collapse anymore.
+// error is raised to the largest distance (in model units) a collapse moved the surface.
+// V needs Position, Normal and TexCoords members.
+template <typename V>
+std::vector<unsigned int> simplifyMesh(const std::vector<V>& vertices, const std::vector<unsigned int>& indices,
+                                       size_t targetIndexCount, float& error) {
+    // plane quadric as the upper triangle of a symmetric 4x4 matrix
+    struct Quadric {
+        double A[10] = {};
+
+        void AddPlane(const glm::vec3& n, float d) {
+            double p[4] = {n.x, n.y, n.z, d};
+            int k = 0;
+            for (int i = 0; i < 4; i++)
+                for (int j = i; j < 4; j++)
+                    A[k++] += p[i] * p[j];
+        }
+
+        void Add(const Quadric& other) {
+            for (int i = 0; i < 10; i++)
+                A[i] += other.A[i];
+        }
+
+        double Evaluate(const glm::vec3& v) const {
+            double p[4] = {v.x, v.y, v.z, 1.0};
+            double sum = 0.0;
+            int k = 0;
+            for (int i = 0; i < 4; i++)
+                for (int j = i; j < 4; j++)
+                    sum += (i == j ? 1.0 : 2.0) * A[k++] * p[i] * p[j];
+            return std::max(sum, 0.0);
+        }
+    };
+
+    size_t vertexCount = vertices.size();
+    // every vertex maps to the first vertex with its attributes (its wedge) and to the first
+    // vertex at its position, topology works on the latter
+    std::vector<unsigned int> wedge(vertexCount);
+    std::vector<unsigned int> position(vertexCount);
+    std::vector<bool> locked(vertexCount, false);
+    {
+        std::map<std::tuple<float, float, float>, unsigned int> firstAtPosition;
+        std::map<std::tuple<float, float, float, float, float, float, float, float>, unsigned int> firstWedge;
+        for (unsigned int v = 0; v < vertexCount; v++) {
+            const V& vertex = vertices[v];
+            const glm::vec3& p = vertex.Position;
+            position[v] = firstAtPosition.insert(std::make_pair(std::make_tuple(p.x, p.y, p.z), v)).first->second;
+            wedge[v] = firstWedge.insert(std::make_pair(std::make_tuple(p.x, p.y, p.z, vertex.Normal.x, vertex.Normal.y,
+                                                                        vertex.Normal.z, vertex.TexCoords.x, vertex.TexCoords.y), v)).first->second;
+        }
+    }
+
+    std::vector<unsigned int> result(indices.size());
+    for (size_t i = 0; i < indices.size(); i++)
+        result[i] = wedge[indices[i]];
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t + 2 < result.size(); t += 3) {
+        const glm::vec3& a = vertices[result[t]].Position;
+        glm::vec3 normal = glm::cross(vertices[result[t + 1]].Position - a, vertices[result[t + 2]].Position - a);
+        float length = glm::length(normal);
+        if (length == 0.0f)
+            continue;
+        normal = normal / length;
+        for (int corner = 0; corner < 3; corner++)
+            quadrics[position[result[t + corner]]].AddPlane(normal, -glm::dot(normal, a));
+    }
+
+    // border edges belong to a single triangle
+    {
+        std::map<std::pair<unsigned int, unsigned int>, int> edgeUses;
+        for (size_t t = 0; t + 2 < result.size(); t += 3)
+            for (int corner = 0; corner < 3; corner++) {
+                unsigned int a = position[result[t + corner]], b = position[result[t + (corner + 1) % 3]];
+                edgeUses[std::make_pair(std::min(a, b), std::max(a, b))]++;
+            }
+        for (const auto& edge : edgeUses)
+            if (edge.second == 1)
+                locked[edge.first.first] = locked[edge.first.second] = true;
+    }
+
+    struct Collapse {
+        double Cost;
+        unsigned int From;
+        unsigned int To;
+        bool operator<(const Collapse& other) const { return Cost < other.Cost; }
+    };
+
+    std::vector<unsigned int> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<unsigned int> firstTriangle, vertexTriangles;
+    // wedges at From and the wedge at To each moves onto
+    std::vector<std::pair<unsigned int, unsigned int>> moves;
+    while (result.size() > targetIndexCount) {
+        std::vector<Collapse> collapses;
+        for (size_t t = 0; t + 2 < result.size(); t += 3)
+            for (int corner = 0; corner < 3; corner++) {
+                unsigned int a = position[result[t + corner]], b = position[result[t + (corner + 1) % 3]];
+                Quadric sum = quadrics[a];
+                sum.Add(quadrics[b]);
+                if (!locked[a])
+                    collapses.push_back(Collapse{sum.Evaluate(vertices[b].Position), a, b});
+                if (!locked[b])
+                    collapses.push_back(Collapse{sum.Evaluate(vertices[a].Position), b, a});
+            }
+        if (collapses.empty())
+            break;
+        std::sort(collapses.begin(), collapses.end());
+
+        // triangles around every position
+        firstTriangle.assign(vertexCount + 1, 0);
+        vertexTriangles.assign(result.size(), 0);
+        for (unsigned int index : result)
+            firstTriangle[position[index] + 1]++;
+        for (size_t v = 0; v < vertexCount; v++)
+            firstTriangle[v + 1] += firstTriangle[v];
+        std::vector<unsigned int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+        for (size_t i = 0; i < result.size(); i++)
+            vertexTriangles[fill[position[result[i]]]++] = (unsigned int) (i / 3);
+
+        for (unsigned int v = 0; v < vertexCount; v++)
+            remap[v] = v;
+        std::fill(touched.begin(), touched.end(), false);
+        // about two triangles go per collapse, stop at the target
+        size_t budget = (result.size() - targetIndexCount) / 6 + 1;
+        size_t collapsed = 0;
+        for (const Collapse& collapse : collapses) {
+            if (collapsed == budget)
+                break;
+            if (touched[collapse.From] || touched[collapse.To])
+                continue;
+
+            // every wedge at From moves onto the wedge at To of a triangle both are in
+            moves.clear();
+            for (unsigned int i = firstTriangle[collapse.From]; i < firstTriangle[collapse.From + 1]; i++) {
+                const unsigned int* triangle = &result[3 * vertexTriangles[i]];
+                unsigned int from = 0, to = 0;
+                bool shared = false;
+                for (int corner = 0; corner < 3; corner++) {
+                    if (position[triangle[corner]] == collapse.From)
+                        from = triangle[corner];
+                    if (position[triangle[corner]] == collapse.To) {
+                        shared = true;
+                        to = triangle[corner];
+                    }
+                }
+                if (shared)
+                    moves.push_back(std::make_pair(from, to));
+            }
+            // a wedge with no wedge to move onto, or with two different ones, is across a seam
+            bool seam = false;
+            for (const std::pair<unsigned int, unsigned int>& move : moves)
+                for (const std::pair<unsigned int, unsigned int>& other : moves)
+                    seam = seam || (move.first == other.first && move.second != other.second);
+            for (unsigned int i = firstTriangle[collapse.From]; i < firstTriangle[collapse.From + 1] && !seam; i++) {
+                const unsigned int* triangle = &result[3 * vertexTriangles[i]];
+                for (int corner = 0; corner < 3; corner++)
+                    if (position[triangle[corner]] == collapse.From)
+                        seam = seam || std::find_if(moves.begin(), moves.end(), [&](const std::pair<unsigned int, unsigned int>& move) {
+                            return move.first == triangle[corner];
+                        }) == moves.end();
+            }
+            if (seam)
+                continue;
+
+            bool flips = false;
+            for (unsigned int i = firstTriangle[collapse.From]; i < firstTriangle[collapse.From + 1] && !flips; i++) {
+                const unsigned int* triangle = &result[3 * vertexTriangles[i]];
+                bool shared = false;
+                for (int corner = 0; corner < 3; corner++)
+                    shared = shared || position[triangle[corner]] == collapse.To;
+                if (shared)
+                    continue;
+                glm::vec3 p[3], q[3];
+                for (int corner = 0; corner < 3; corner++) {
+                    p[corner] = vertices[triangle[corner]].Position;
+                    q[corner] = position[triangle[corner]] == collapse.From ? vertices[collapse.To].Position : p[corner];
+                }
+                glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+                glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+                float lengths = glm::length(before) * glm::length(after);
+                if (glm::length(before) > 0.0f)
+                    flips = lengths == 0.0f || glm::dot(before, after) < 0.5f * lengths;
+            }
+            if (flips)
+                continue;
+
+            for (const std::pair<unsigned int, unsigned int>& move : moves)
+                remap[move.first] = move.second;
+            quadrics[collapse.To].Add(quadrics[collapse.From]);
+            error = std::max(error, (float) std::sqrt(collapse.Cost));
+            // the neighbourhoods changed, their remaining collapses wait for the next pass
+            for (unsigned int v : {collapse.From, collapse.To})
+                for (unsigned int i = firstTriangle[v]; i < firstTriangle[v + 1]; i++)
+                    for (int corner = 0; corner < 3; corner++)
+                        touched[position[result[3 * vertexTriangles[i] + corner]]] = true;
+            collapsed++;
+        }
+        if (collapsed == 0)
+            break;
+
+        size_t kept = 0;
+        for (size_t t = 0; t + 2 < result.size(); t += 3) {
+            unsigned int triangle[3];
+            for (int corner = 0; corner < 3; corner++)
+                triangle[corner] = remap[result[t + corner]];
+            if (position[triangle[0]] == position[triangle[1]] || position[triangle[1]] == position[triangle[2]]
+                || position[triangle[0]] == position[triangle[2]])
+                continue;
+            for (int corner = 0; corner < 3; corner++)
+                result[kept++] = triangle[corner];
+        }
+        result.resize(kept);
+    }
+    return result;
+}
+
+}
+#endif //PROJECT_BASE_MESHSIMPLIFIER_H
@@ -0,0 +1,143 @@
+#ifndef PROJECT_BASE_MESHLETS_H
+#define PROJECT_BASE_MESHLETS_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <learnopengl/mesh.h>
+
+namespace rg {
+
+// A cluster of neighbouring triangles, a contiguous range of the reordered index buffer.
+struct Meshlet {
+    // bounding sphere, center and radius
+    glm::vec4 Sphere;
+    // normal cone: the average normal and the sine of the widest angle of a triangle normal to it.
+    // All triangles face away from a viewer at p when
+    //   dot(center - p, axis) >= cutoff * length(center - p) + radius.
+    // A cutoff of 1 never passes the test.
+    glm::vec4 Cone;
+    unsigned int FirstIndex;
+    unsigned int IndexCount;
+};
+
+// Splits an indexed triangle list into meshlets of at most maxTriangles triangles. Starting
+// from the first unassigned triangle, a meshlet grows across shared vertices, always taking
+// the neighbour that stays closest to the meshlet and whose normal agrees best with it, so
+// the spheres stay small and the cones narrow. The indices of each meshlet are appended to
+// reordered, FirstIndex is relative to the first index appended.
+inline std::vector<Meshlet> buildMeshlets(const std::vector<Vertex>& vertices, const std::vector<unsigned int>& indices,
+                                          unsigned int maxTriangles, std::vector<unsigned int>& reordered) {
+    std::vector<Meshlet> meshlets;
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return meshlets;
+
+    std::vector<glm::vec3> centroids(triangleCount), normals(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        const glm::vec3& a = vertices[indices[3 * t]].Position;
+        const glm::vec3& b = vertices[indices[3 * t + 1]].Position;
+        const glm::vec3& c = vertices[indices[3 * t + 2]].Position;
+        centroids[t] = (a + b + c) / 3.0f;
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float length = glm::length(normal);
+        normals[t] = length > 0.0f ? normal / length : glm::vec3(0.0f);
+    }
+
+    // triangles around every vertex, compressed rows
+    std::vector<unsigned int> firstTriangle(vertices.size() + 1, 0), vertexTriangles(indices.size());
+    for (unsigned int index : indices)
+        firstTriangle[index + 1]++;
+    for (size_t v = 0; v < vertices.size(); v++)
+        firstTriangle[v + 1] += firstTriangle[v];
+    std::vector<unsigned int> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+    for (size_t i = 0; i < indices.size(); i++)
+        vertexTriangles[fill[indices[i]]++] = (unsigned int) (i / 3);
+
+    std::vector<bool> assigned(triangleCount, false);
+    std::vector<unsigned int> members, frontier;
+    size_t seed = 0;
+    unsigned int baseIndex = (unsigned int) reordered.size();
+    while (true) {
+        while (seed < triangleCount && assigned[seed])
+            seed++;
+        if (seed == triangleCount)
+            break;
+
+        members.clear();
+        frontier.assign(1, (unsigned int) seed);
+        glm::vec3 centerSum(0.0f), normalSum(0.0f);
+        while (members.size() < maxTriangles && !frontier.empty()) {
+            // the frontier candidate nearest the running center, weighted by how much its normal turns
+            size_t best = 0;
+            float bestScore = 0.0f;
+            glm::vec3 center = members.empty() ? centroids[frontier[0]] : centerSum / (float) members.size();
+            glm::vec3 axis = glm::length(normalSum) > 0.0f ? glm::normalize(normalSum) : glm::vec3(0.0f);
+            for (size_t f = 0; f < frontier.size(); f++) {
+                unsigned int t = frontier[f];
+                float score = glm::length(centroids[t] - center) * (2.0f - glm::dot(normals[t], axis));
+                if (f == 0 || score < bestScore) {
+                    best = f;
+                    bestScore = score;
+                }
+            }
+            unsigned int triangle = frontier[best];
+            frontier[best] = frontier.back();
+            frontier.pop_back();
+            if (assigned[triangle])
+                continue;
+
+            assigned[triangle] = true;
+            members.push_back(triangle);
+            centerSum += centroids[triangle];
+            normalSum += normals[triangle];
+            for (int corner = 0; corner < 3; corner++) {
+                unsigned int vertex = indices[3 * triangle + corner];
+                for (unsigned int i = firstTriangle[vertex]; i < firstTriangle[vertex + 1]; i++)
+                    if (!assigned[vertexTriangles[i]])
+                        frontier.push_back(vertexTriangles[i]);
+            }
+            // the same neighbour is reached through up to three vertices
+            std::sort(frontier.begin(), frontier.end());
+            frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+        }
+
+        Meshlet meshlet;
+        meshlet.FirstIndex = (unsigned int) reordered.size() - baseIndex;
+        meshlet.IndexCount = (unsigned int) members.size() * 3;
+        glm::vec3 low(0.0f), high(0.0f);
+        for (size_t m = 0; m < members.size(); m++) {
+            for (int corner = 0; corner < 3; corner++) {
+                unsigned int index = indices[3 * members[m] + corner];
+                reordered.push_back(index);
+                const glm::vec3& p = vertices[index].Position;
+                low = (m == 0 && corner == 0) ? p : glm::min(low, p);
+                high = (m == 0 && corner == 0) ? p : glm::max(high, p);
+            }
+        }
+        glm::vec3 center = 0.5f * (low + high);
+        float radius = 0.0f;
+        for (unsigned int i = meshlet.FirstIndex; i < meshlet.FirstIndex + meshlet.IndexCount; i++)
+            radius = std::max(radius, glm::length(vertices[reordered[baseIndex + i]].Position - center));
+        meshlet.Sphere = glm::vec4(center, radius);
+
+        // a cone wider than about 84 degrees culls too rarely to be worth the test
+        meshlet.Cone = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+        if (glm::length(normalSum) > 0.0f) {
+            glm::vec3 axis = glm::normalize(normalSum);
+            float minDot = 1.0f;
+            for (unsigned int triangle : members)
+                minDot = std::min(minDot, glm::dot(normals[triangle], axis));
+            if (minDot > 0.1f)
+                meshlet.Cone = glm::vec4(axis, std::sqrt(1.0f - minDot * minDot));
+        }
+        meshlets.push_back(meshlet);
+    }
+    return meshlets;
+}
+
+}
+#endif //PROJECT_BASE_MESHLETS_H
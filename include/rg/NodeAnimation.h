@@ -0,0 +1,263 @@
+#ifndef PROJECT_BASE_NODEANIMATION_H
+#define PROJECT_BASE_NODEANIMATION_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define RG_NODE_ANIMATION_SSE 1
+#endif
+
+namespace rg {
+
+// a node of an imported scene, parents come before their children
+struct AnimationNode {
+    std::string Name;
+    int Parent;
+    glm::mat4 Transform;
+};
+
+// translation * rotation * scale, the rotation a unit quaternion (x, y, z, w)
+inline glm::mat4 trsMatrix(const glm::vec3& t, const glm::vec4& q, const glm::vec3& s) {
+    float x = q.x, y = q.y, z = q.z, w = q.w;
+    glm::mat4 m(1.0f);
+    m[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f) * s.x;
+    m[1] = glm::vec4(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f) * s.y;
+    m[2] = glm::vec4(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f) * s.z;
+    m[3] = glm::vec4(t, 1.0f);
+    return m;
+}
+
+// The keyframes of one animation as structure of arrays. Every channel animates one node and
+// owns a contiguous range of the position, rotation and scale keys, times are in seconds.
+struct AnimationClip {
+    struct Channel {
+        int Node;
+        unsigned int FirstPosition, PositionCount;
+        unsigned int FirstRotation, RotationCount;
+        unsigned int FirstScale, ScaleCount;
+    };
+
+    std::string Name;
+    float Duration = 0.0f;
+    std::vector<Channel> Channels;
+    std::vector<float> PositionTimes, PositionX, PositionY, PositionZ;
+    std::vector<float> RotationTimes, RotationX, RotationY, RotationZ, RotationW;
+    std::vector<float> ScaleTimes, ScaleX, ScaleY, ScaleZ;
+};
+
+// Plays a clip on any number of instances of a node hierarchy. Instances do not get a time of
+// their own, they pick one of Phases() evenly spaced offsets into the clip (gl_InstanceID
+// modulo the phase count in clock.vs). Every frame the channels are sampled at all phases,
+// four phases at a time with SSE, the hierarchy is composed and the Phases() x NodeCount()
+// node matrices go to the GPU in one texture buffer, so the CPU cost does not depend on the
+// number of instances drawn.
+class NodeAnimator {
+public:
+    NodeAnimator(const std::vector<AnimationNode>& nodes, const std::vector<AnimationClip>& clips, int phases = 64)
+        : m_Nodes(nodes), m_Phases((std::max(phases, 4) + 3) / 4 * 4) {
+        if (!clips.empty())
+            m_Clip = clips[0];
+        size_t samples = m_Nodes.size() * m_Phases;
+        for (std::vector<float>* column : {&m_TX, &m_TY, &m_TZ, &m_RX, &m_RY, &m_RZ, &m_RW, &m_SX, &m_SY, &m_SZ})
+            column->assign(samples, 0.0f);
+        m_Animated.assign(m_Nodes.size(), false);
+        for (const AnimationClip::Channel& channel : m_Clip.Channels)
+            m_Animated[channel.Node] = true;
+        m_Matrices.assign(samples, glm::mat4(1.0f));
+
+        glGenBuffers(1, &m_Buffer);
+        glGenTextures(1, &m_Texture);
+        glBindBuffer(GL_TEXTURE_BUFFER, m_Buffer);
+        glBufferData(GL_TEXTURE_BUFFER, samples * sizeof(glm::mat4), NULL, GL_STREAM_DRAW);
+        glBindTexture(GL_TEXTURE_BUFFER, m_Texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, m_Buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    ~NodeAnimator() {
+        glDeleteBuffers(1, &m_Buffer);
+        glDeleteTextures(1, &m_Texture);
+    }
+
+    NodeAnimator(const NodeAnimator&) = delete;
+    NodeAnimator& operator=(const NodeAnimator&) = delete;
+
+    bool HasAnimation() const {
+        return !m_Clip.Channels.empty() && m_Clip.Duration > 0.0f;
+    }
+
+    int NodeCount() const {
+        return (int) m_Nodes.size();
+    }
+
+    int Phases() const {
+        return m_Phases;
+    }
+
+    // the GL_TEXTURE_BUFFER of node matrices, four RGBA32F texels per matrix, phase major
+    unsigned int NodeMatrices() const {
+        return m_Texture;
+    }
+
+    // CPU time of the last Update()
+    float UpdateMs() const {
+        return m_UpdateMs;
+    }
+
+    void Update(float time) {
+        auto start = std::chrono::high_resolution_clock::now();
+        float phaseTimes[4];
+        for (int p = 0; p < m_Phases; p += 4) {
+            for (int lane = 0; lane < 4; lane++)
+                phaseTimes[lane] = HasAnimation() ? std::fmod(time + m_Clip.Duration * (p + lane) / m_Phases, m_Clip.Duration) : 0.0f;
+            for (const AnimationClip::Channel& channel : m_Clip.Channels) {
+                size_t offset = (size_t) channel.Node * m_Phases + p;
+                sampleVec3(m_Clip.PositionTimes, m_Clip.PositionX, m_Clip.PositionY, m_Clip.PositionZ, channel.FirstPosition,
+                           channel.PositionCount, phaseTimes, &m_TX[offset], &m_TY[offset], &m_TZ[offset], 0.0f);
+                sampleRotation(channel, phaseTimes, offset);
+                sampleVec3(m_Clip.ScaleTimes, m_Clip.ScaleX, m_Clip.ScaleY, m_Clip.ScaleZ, channel.FirstScale,
+                           channel.ScaleCount, phaseTimes, &m_SX[offset], &m_SY[offset], &m_SZ[offset], 1.0f);
+            }
+        }
+
+        // parents come first, so their matrices are final when the children read them
+        for (size_t node = 0; node < m_Nodes.size(); node++) {
+            int parent = m_Nodes[node].Parent;
+            for (int p = 0; p < m_Phases; p++) {
+                glm::mat4 local = m_Animated[node] ? localMatrix(node * m_Phases + p) : m_Nodes[node].Transform;
+                m_Matrices[(size_t) p * m_Nodes.size() + node] =
+                    parent < 0 ? local : m_Matrices[(size_t) p * m_Nodes.size() + parent] * local;
+            }
+        }
+
+        // orphan the buffer so the upload never waits for last frame's draws
+        glBindBuffer(GL_TEXTURE_BUFFER, m_Buffer);
+        glBufferData(GL_TEXTURE_BUFFER, m_Matrices.size() * sizeof(glm::mat4), m_Matrices.data(), GL_STREAM_DRAW);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        m_UpdateMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+private:
+    std::vector<AnimationNode> m_Nodes;
+    AnimationClip m_Clip;
+    int m_Phases;
+    std::vector<bool> m_Animated;
+    // local translation, rotation and scale of every node at every phase, node major
+    std::vector<float> m_TX, m_TY, m_TZ, m_RX, m_RY, m_RZ, m_RW, m_SX, m_SY, m_SZ;
+    std::vector<glm::mat4> m_Matrices;
+    unsigned int m_Buffer = 0;
+    unsigned int m_Texture = 0;
+    float m_UpdateMs = 0.0f;
+
+    // the keys around time and the blend factor between them, clamped at both ends
+    static void findKeys(const std::vector<float>& times, unsigned int first, unsigned int count, float time,
+                         unsigned int& a, unsigned int& b, float& f) {
+        const float* begin = times.data() + first;
+        unsigned int next = (unsigned int) (std::upper_bound(begin, begin + count, time) - begin);
+        a = first + (next == 0 ? 0 : std::min(next - 1, count - 1));
+        b = first + std::min(next, count - 1);
+        float span = times[b] - times[a];
+        f = span > 0.0f ? (time - times[a]) / span : 0.0f;
+    }
+
+    // out = a + (b - a) * f for four lanes
+    static void lerp4(const float a[4], const float b[4], const float f[4], float* out) {
+#ifdef RG_NODE_ANIMATION_SSE
+        __m128 va = _mm_loadu_ps(a);
+        _mm_storeu_ps(out, _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(b), va), _mm_loadu_ps(f))));
+#else
+        for (int lane = 0; lane < 4; lane++)
+            out[lane] = a[lane] + (b[lane] - a[lane]) * f[lane];
+#endif
+    }
+
+    static void sampleVec3(const std::vector<float>& times, const std::vector<float>& x, const std::vector<float>& y,
+                           const std::vector<float>& z, unsigned int first, unsigned int count, const float phaseTimes[4],
+                           float* outX, float* outY, float* outZ, float fallback) {
+        if (count == 0) {
+            std::fill(outX, outX + 4, fallback);
+            std::fill(outY, outY + 4, fallback);
+            std::fill(outZ, outZ + 4, fallback);
+            return;
+        }
+        float ax[4], ay[4], az[4], bx[4], by[4], bz[4], f[4];
+        for (int lane = 0; lane < 4; lane++) {
+            unsigned int a, b;
+            findKeys(times, first, count, phaseTimes[lane], a, b, f[lane]);
+            ax[lane] = x[a], ay[lane] = y[a], az[lane] = z[a];
+            bx[lane] = x[b], by[lane] = y[b], bz[lane] = z[b];
+        }
+        lerp4(ax, bx, f, outX);
+        lerp4(ay, by, f, outY);
+        lerp4(az, bz, f, outZ);
+    }
+
+    // normalized lerp along the shorter arc
+    void sampleRotation(const AnimationClip::Channel& channel, const float phaseTimes[4], size_t offset) {
+        float* out[4] = {&m_RX[offset], &m_RY[offset], &m_RZ[offset], &m_RW[offset]};
+        if (channel.RotationCount == 0) {
+            for (int c = 0; c < 4; c++)
+                std::fill(out[c], out[c] + 4, c == 3 ? 1.0f : 0.0f);
+            return;
+        }
+        const std::vector<float>* components[4] = {&m_Clip.RotationX, &m_Clip.RotationY, &m_Clip.RotationZ, &m_Clip.RotationW};
+        float a[4][4], b[4][4], f[4];
+        for (int lane = 0; lane < 4; lane++) {
+            unsigned int ka, kb;
+            findKeys(m_Clip.RotationTimes, channel.FirstRotation, channel.RotationCount, phaseTimes[lane], ka, kb, f[lane]);
+            for (int c = 0; c < 4; c++) {
+                a[c][lane] = (*components[c])[ka];
+                b[c][lane] = (*components[c])[kb];
+            }
+        }
+#ifdef RG_NODE_ANIMATION_SSE
+        __m128 dot = _mm_setzero_ps();
+        for (int c = 0; c < 4; c++)
+            dot = _mm_add_ps(dot, _mm_mul_ps(_mm_loadu_ps(a[c]), _mm_loadu_ps(b[c])));
+        // flip b where the quaternions lie in opposite hemispheres
+        __m128 flip = _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+        __m128 factor = _mm_loadu_ps(f);
+        __m128 q[4];
+        __m128 length = _mm_setzero_ps();
+        for (int c = 0; c < 4; c++) {
+            __m128 va = _mm_loadu_ps(a[c]);
+            __m128 vb = _mm_xor_ps(_mm_loadu_ps(b[c]), flip);
+            q[c] = _mm_add_ps(va, _mm_mul_ps(_mm_sub_ps(vb, va), factor));
+            length = _mm_add_ps(length, _mm_mul_ps(q[c], q[c]));
+        }
+        length = _mm_sqrt_ps(length);
+        for (int c = 0; c < 4; c++)
+            _mm_storeu_ps(out[c], _mm_div_ps(q[c], length));
+#else
+        for (int lane = 0; lane < 4; lane++) {
+            float dot = a[0][lane] * b[0][lane] + a[1][lane] * b[1][lane] + a[2][lane] * b[2][lane] + a[3][lane] * b[3][lane];
+            float sign = dot < 0.0f ? -1.0f : 1.0f;
+            float q[4], length = 0.0f;
+            for (int c = 0; c < 4; c++) {
+                q[c] = a[c][lane] + (sign * b[c][lane] - a[c][lane]) * f[lane];
+                length += q[c] * q[c];
+            }
+            length = std::sqrt(length);
+            for (int c = 0; c < 4; c++)
+                out[c][lane] = q[c] / length;
+        }
+#endif
+    }
+
+    glm::mat4 localMatrix(size_t i) const {
+        return trsMatrix(glm::vec3(m_TX[i], m_TY[i], m_TZ[i]), glm::vec4(m_RX[i], m_RY[i], m_RZ[i], m_RW[i]),
+                         glm::vec3(m_SX[i], m_SY[i], m_SZ[i]));
+    }
+};
+
+}
+#endif //PROJECT_BASE_NODEANIMATION_H
@@ -0,0 +1,180 @@
+#ifndef PROJECT_BASE_PIPELINESTATISTICS_H
+#define PROJECT_BASE_PIPELINESTATISTICS_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <rg/GLExt.h>
+
+namespace rg {
+
+// Per pass pipeline statistics: vertex shader invocations, primitives entering and leaving
+// the clipper and fragment shader invocations, what tells a vertex bound pass (many vertices,
+// few fragments each) from a fill bound one. One query per statistic is active from Begin()
+// to End(); queries of the same target can not nest, so neither can the passes. Like
+// rg::GpuProfiler, frames go into a ring of RING_SIZE and BeginFrame() only reads back frames
+// whose queries are all available, so reading never stalls. The two rings finish frames at
+// their own pace: BeginFrame() takes rg::GpuProfiler::FrameNumber() and Begin() the profiler
+// zone of the pass, and the last RING_SIZE finished frames are kept, so ForZone() finds the
+// statistics of exactly the frame and zone a profiler timeline shows, or nothing.
+// Needs GLExt::PipelineStatistics, otherwise every call does nothing.
+class PipelineStatistics {
+public:
+    static const int RING_SIZE = 4;
+
+    enum Statistic {
+        VERTEX_SHADER_INVOCATIONS,
+        CLIPPING_INPUT_PRIMITIVES,
+        CLIPPING_OUTPUT_PRIMITIVES,
+        FRAGMENT_SHADER_INVOCATIONS,
+        STATISTIC_COUNT
+    };
+
+    struct Pass {
+        std::string Name;
+        // rg::GpuProfiler zone index, -1 without one
+        int Zone;
+        GLuint64 Values[STATISTIC_COUNT];
+    };
+
+    bool Enabled = true;
+
+    PipelineStatistics() = default;
+
+    ~PipelineStatistics() {
+        for (Frame& frame : m_Frames)
+            if (!frame.Queries.empty())
+                glDeleteQueries((GLsizei) frame.Queries.size(), frame.Queries.data());
+    }
+
+    PipelineStatistics(const PipelineStatistics&) = delete;
+    PipelineStatistics& operator=(const PipelineStatistics&) = delete;
+
+    static bool IsAvailable() {
+        return GLExt::PipelineStatistics;
+    }
+
+    static const char* Name(int statistic) {
+        static const char* names[STATISTIC_COUNT] = {"VS invocations", "clip in", "clip out", "FS invocations"};
+        return names[statistic];
+    }
+
+    void BeginFrame(uint64_t frameNumber) {
+        if (!IsAvailable())
+            return;
+        collect();
+        Frame& frame = m_Frames[m_Write];
+        frame.Pending = false;
+        frame.Number = frameNumber;
+        frame.Passes.clear();
+        m_Recording = Enabled;
+        m_Open = false;
+    }
+
+    void EndFrame() {
+        if (!m_Recording)
+            return;
+        End();
+        m_Frames[m_Write].Pending = !m_Frames[m_Write].Passes.empty();
+        m_Write = (m_Write + 1) % RING_SIZE;
+        m_Recording = false;
+    }
+
+    // a Begin() while a pass is open is ignored
+    void Begin(const std::string& name, int zone = -1) {
+        if (!m_Recording || m_Open)
+            return;
+        Frame& frame = m_Frames[m_Write];
+        size_t pass = frame.Passes.size();
+        frame.Passes.push_back(Pass{name, zone, {}});
+        if (frame.Queries.size() < frame.Passes.size() * STATISTIC_COUNT) {
+            size_t count = frame.Queries.size();
+            frame.Queries.resize(std::max<size_t>(16 * STATISTIC_COUNT, 2 * count));
+            glGenQueries((GLsizei) (frame.Queries.size() - count), frame.Queries.data() + count);
+        }
+        for (int statistic = 0; statistic < STATISTIC_COUNT; statistic++)
+            glBeginQuery(target(statistic), frame.Queries[pass * STATISTIC_COUNT + statistic]);
+        m_Open = true;
+    }
+
+    void End() {
+        if (!m_Recording || !m_Open)
+            return;
+        for (int statistic = 0; statistic < STATISTIC_COUNT; statistic++)
+            glEndQuery(target(statistic));
+        m_Open = false;
+    }
+
+    // passes of the last finished frame in the order they ran
+    const std::vector<Pass>& LastFrame() const {
+        return m_Finished[(m_FinishedWrite + RING_SIZE - 1) % RING_SIZE].Passes;
+    }
+
+    // the pass that ran in the profiler zone of the frame, null if the frame is not among
+    // the last RING_SIZE finished ones or no pass ran there
+    const Pass* ForZone(uint64_t frameNumber, int zone) const {
+        for (const Frame& frame : m_Finished) {
+            if (frame.Number != frameNumber)
+                continue;
+            for (const Pass& pass : frame.Passes)
+                if (pass.Zone == zone)
+                    return &pass;
+        }
+        return nullptr;
+    }
+
+private:
+    struct Frame {
+        std::vector<Pass> Passes;
+        // STATISTIC_COUNT queries per pass
+        std::vector<unsigned int> Queries;
+        bool Pending = false;
+        // 0 for none
+        uint64_t Number = 0;
+    };
+
+    Frame m_Frames[RING_SIZE];
+    int m_Write = 0;
+    bool m_Recording = false;
+    bool m_Open = false;
+    // read back frames, Queries unused
+    Frame m_Finished[RING_SIZE];
+    int m_FinishedWrite = 0;
+
+    static GLenum target(int statistic) {
+        static const GLenum targets[STATISTIC_COUNT] = {GL_VERTEX_SHADER_INVOCATIONS, GL_CLIPPING_INPUT_PRIMITIVES,
+                                                        GL_CLIPPING_OUTPUT_PRIMITIVES, GL_FRAGMENT_SHADER_INVOCATIONS};
+        return targets[statistic];
+    }
+
+    void collect() {
+        // oldest slot first, the newest finished frame ends up last in m_Finished
+        for (int i = 0; i < RING_SIZE; i++) {
+            Frame& frame = m_Frames[(m_Write + i) % RING_SIZE];
+            if (!frame.Pending)
+                continue;
+            // different targets finish in no set order, every query has to be checked
+            size_t queries = frame.Passes.size() * STATISTIC_COUNT;
+            GLuint available = 1;
+            for (size_t query = 0; query < queries && available; query++)
+                glGetQueryObjectuiv(frame.Queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                break;
+            for (size_t pass = 0; pass < frame.Passes.size(); pass++)
+                for (int statistic = 0; statistic < STATISTIC_COUNT; statistic++)
+                    glGetQueryObjectui64v(frame.Queries[pass * STATISTIC_COUNT + statistic], GL_QUERY_RESULT, &frame.Passes[pass].Values[statistic]);
+            Frame& finished = m_Finished[m_FinishedWrite];
+            finished.Passes = frame.Passes;
+            finished.Number = frame.Number;
+            m_FinishedWrite = (m_FinishedWrite + 1) % RING_SIZE;
+            frame.Pending = false;
+        }
+    }
+};
+
+}
+#endif //PROJECT_BASE_PIPELINESTATISTICS_H
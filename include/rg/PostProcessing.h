@@ -0,0 +1,265 @@
+#ifndef PROJECT_BASE_POSTPROCESSING_H
+#define PROJECT_BASE_POSTPROCESSING_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <learnopengl/shader.h>
+#include <rg/FrameGraph.h>
+#include <rg/GLExt.h>
+#include <rg/GpuTimer.h>
+
+namespace rg {
+
+// Compute-shader post chain (resources/shaders/post.cs) for 4.3 contexts. With Fused set all
+// enabled effects run in a single dispatch, otherwise every effect gets its own dispatch and
+// its own GPU timer. On 3.3 contexts IsAvailable() is false and framebuffer.fs does the work.
+class PostProcessing {
+public:
+    enum Effect {
+        EFFECT_KERNEL = 1,
+        EFFECT_FOG = 2,
+        EFFECT_BLOOM = 4,
+        EFFECT_TONEMAP = 8,
+        EFFECT_GAMMA = 16
+    };
+
+    enum Kernel {
+        // the 3x3 kernel of framebuffer.fs, rank 2 so it splits into two separable terms
+        KERNEL_EDGE,
+        // 9-tap gaussian, a single separable term
+        KERNEL_GAUSSIAN
+    };
+
+    static const int MAX_RADIUS = 4;
+    static const int MAX_TERMS = 2;
+    static const int TAPS = 2 * MAX_RADIUS + 1;
+    static const int TILE = 16;
+    static const int EFFECT_COUNT = 5;
+
+    bool Enabled = true;
+    bool Fused = true;
+    bool FogEnabled = false;
+    Kernel KernelType = KERNEL_EDGE;
+    float Exposure = 0.1f;
+    float Gamma = 2.2f;
+    glm::vec3 FogColor = glm::vec3(0.7f);
+    float FogDensity = 0.02f;
+    float Near = 0.1f;
+    float Far = 100.0f;
+    float BloomStrength = 0.04f;
+
+    PostProcessing() {
+        if (GLExt::Compute)
+            m_Shader.reset(new Shader("resources/shaders/post.cs"));
+    }
+
+    bool IsAvailable() const {
+        return m_Shader != nullptr;
+    }
+
+    // Adds the chain to the graph and returns the texture holding its result. Only the
+    // rendered region (renderWidth x renderHeight) of the scene textures is processed.
+    // bloom is the output of rg::Bloom, needed only with EFFECT_BLOOM. exposure is the buffer
+    // of rg::AutoExposure, without it the tonemap uses the fixed Exposure.
+    FrameGraphResource AddPasses(FrameGraph& graph, FrameGraphResource color, FrameGraphResource depth,
+                                 FrameGraphResource bloom, FrameGraphResource exposure,
+                                 unsigned int renderWidth, unsigned int renderHeight, int effects) {
+        // fog needs the depth of the frame, there is none after a TAA resolve
+        if (FogEnabled && depth >= 0)
+            effects |= EFFECT_FOG;
+        m_RenderWidth = renderWidth;
+        m_RenderHeight = renderHeight;
+        m_ActiveEffects = effects;
+
+        const FrameGraphTextureDesc& sceneDesc = graph.GetDesc(color);
+        FrameGraphTextureDesc desc(sceneDesc.Width, sceneDesc.Height, GL_RGBA16F);
+
+        std::vector<int> stages;
+        if (Fused) {
+            stages.push_back(effects);
+        } else {
+            for (int effect = EFFECT_KERNEL; effect <= EFFECT_GAMMA; effect <<= 1)
+                if (effects & effect)
+                    stages.push_back(effect);
+        }
+
+        // the execute callbacks run after this function returns, so the handles live in m_Stages
+        m_Stages.clear();
+        FrameGraphResource source = color;
+        for (int effectsOfStage : stages) {
+            Stage stage;
+            stage.Effects = effectsOfStage;
+            stage.Source = source;
+            stage.Depth = depth;
+            stage.Bloom = bloom;
+            stage.Exposure = (effectsOfStage & EFFECT_TONEMAP) ? exposure : -1;
+            int index = (int) m_Stages.size();
+            graph.AddPass(stageName(effectsOfStage),
+                [&](FrameGraph::Builder& builder) {
+                    builder.Read(stage.Source);
+                    if (stage.Effects & EFFECT_FOG)
+                        builder.Read(stage.Depth);
+                    if (stage.Effects & EFFECT_BLOOM)
+                        builder.Read(stage.Bloom);
+                    if (stage.Exposure >= 0)
+                        builder.Read(stage.Exposure);
+                    stage.Target = builder.WriteImage(builder.Create("post", desc));
+                },
+                [this, index](const FrameGraph& g) {
+                    dispatch(g, m_Stages[index]);
+                });
+            m_Stages.push_back(stage);
+            source = stage.Target;
+        }
+        return source;
+    }
+
+    // GPU time of the last finished dispatch that ran exactly this set of effects
+    float StageMs(int effects) const {
+        auto it = std::find(m_TimedStages.begin(), m_TimedStages.end(), effects);
+        if (it == m_TimedStages.end())
+            return 0.0f;
+        return m_Timers[it - m_TimedStages.begin()]->LastMs();
+    }
+
+    int ActiveEffects() const {
+        return m_ActiveEffects;
+    }
+
+    static const char* EffectName(int effect) {
+        switch (effect) {
+            case EFFECT_KERNEL: return "kernel";
+            case EFFECT_FOG: return "fog";
+            case EFFECT_BLOOM: return "bloom";
+            case EFFECT_TONEMAP: return "tonemap";
+            case EFFECT_GAMMA: return "gamma";
+        }
+        return "fused";
+    }
+
+private:
+    struct Stage {
+        int Effects = 0;
+        FrameGraphResource Source = -1;
+        FrameGraphResource Target = -1;
+        FrameGraphResource Depth = -1;
+        FrameGraphResource Bloom = -1;
+        FrameGraphResource Exposure = -1;
+    };
+
+    std::unique_ptr<Shader> m_Shader;
+    std::vector<Stage> m_Stages;
+    unsigned int m_RenderWidth = 0;
+    unsigned int m_RenderHeight = 0;
+    int m_ActiveEffects = 0;
+    // one timer per distinct effect set that has been dispatched
+    std::vector<int> m_TimedStages;
+    std::vector<std::unique_ptr<GpuTimer>> m_Timers;
+
+    static std::string stageName(int effects) {
+        std::string name = "post";
+        for (int effect = EFFECT_KERNEL; effect <= EFFECT_GAMMA; effect <<= 1)
+            if (effects & effect)
+                name += std::string(" ") + EffectName(effect);
+        return name;
+    }
+
+    GpuTimer& timer(int effects) {
+        auto it = std::find(m_TimedStages.begin(), m_TimedStages.end(), effects);
+        if (it != m_TimedStages.end())
+            return *m_Timers[it - m_TimedStages.begin()];
+        m_TimedStages.push_back(effects);
+        m_Timers.emplace_back(new GpuTimer());
+        return *m_Timers.back();
+    }
+
+    void dispatch(const FrameGraph& graph, const Stage& stage) {
+        int effects = stage.Effects;
+        GpuTimer& stageTimer = timer(effects);
+        stageTimer.Begin();
+
+        m_Shader->use();
+        m_Shader->setInt("effects", effects);
+        glUniform2i(glGetUniformLocation(m_Shader->ID, "renderSize"), m_RenderWidth, m_RenderHeight);
+        if (effects & EFFECT_KERNEL)
+            setKernel();
+        m_Shader->setFloat("exposure", Exposure);
+        m_Shader->setBool("autoExposure", stage.Exposure >= 0);
+        if (stage.Exposure >= 0)
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, graph.GetBuffer(stage.Exposure));
+        m_Shader->setFloat("gamma", Gamma);
+        m_Shader->setVec3("fogColor", FogColor);
+        m_Shader->setFloat("fogDensity", FogDensity);
+        m_Shader->setFloat("near", Near);
+        m_Shader->setFloat("far", Far);
+        m_Shader->setFloat("bloomStrength", BloomStrength);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, graph.GetTexture(stage.Source));
+        glActiveTexture(GL_TEXTURE1);
+        glBindTexture(GL_TEXTURE_2D, stage.Depth >= 0 ? graph.GetTexture(stage.Depth) : 0);
+        glActiveTexture(GL_TEXTURE2);
+        glBindTexture(GL_TEXTURE_2D, stage.Bloom >= 0 ? graph.GetTexture(stage.Bloom) : 0);
+        glActiveTexture(GL_TEXTURE0);
+        glBindImageTexture(0, graph.GetTexture(stage.Target), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+
+        glDispatchCompute((m_RenderWidth + TILE - 1) / TILE, (m_RenderHeight + TILE - 1) / TILE, 1);
+        // the next stage or the final blit samples what was just stored
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+
+        stageTimer.End();
+    }
+
+    void setKernel() {
+        float horizontal[MAX_TERMS * TAPS] = {};
+        float vertical[MAX_TERMS * TAPS] = {};
+        int terms = 0;
+        if (KernelType == KERNEL_EDGE) {
+            // framebuffer.fs samples at 1/800 of the screen, converted to whole texels of the rendered region
+            int sx = std::max(1, std::min(MAX_RADIUS, (int) std::lround(m_RenderWidth / 800.0)));
+            int sy = std::max(1, std::min(MAX_RADIUS, (int) std::lround(m_RenderHeight / 800.0)));
+            // rows are top to bottom in the kernel, the texture's y axis points up
+            //  -3  2 -3     [1]                 [0]
+            //  42  5  2  =  [0] x [-3 2 -3]  +  [1] x [42 5 2]
+            //  -3  2 -3     [1]                 [0]
+            setTaps(horizontal, 0, sx, -3.0f, 2.0f, -3.0f);
+            setTaps(vertical, 0, sy, 1.0f, 0.0f, 1.0f);
+            setTaps(horizontal, 1, sx, 42.0f, 5.0f, 2.0f);
+            setTaps(vertical, 1, sy, 0.0f, 1.0f, 0.0f);
+            terms = 2;
+        } else {
+            float sigma = MAX_RADIUS / 2.0f;
+            float sum = 0.0f;
+            for (int k = -MAX_RADIUS; k <= MAX_RADIUS; k++) {
+                float w = std::exp(-(k * k) / (2.0f * sigma * sigma));
+                horizontal[k + MAX_RADIUS] = w;
+                sum += w;
+            }
+            for (int k = 0; k < TAPS; k++) {
+                horizontal[k] /= sum;
+                vertical[k] = horizontal[k];
+            }
+            terms = 1;
+        }
+        m_Shader->setInt("kernelTerms", terms);
+        glUniform1fv(glGetUniformLocation(m_Shader->ID, "horizontalWeights"), MAX_TERMS * TAPS, horizontal);
+        glUniform1fv(glGetUniformLocation(m_Shader->ID, "verticalWeights"), MAX_TERMS * TAPS, vertical);
+    }
+
+    // three taps at -stride, 0 and +stride of term t
+    static void setTaps(float* weights, int term, int stride, float before, float center, float after) {
+        weights[term * TAPS + MAX_RADIUS - stride] = before;
+        weights[term * TAPS + MAX_RADIUS] = center;
+        weights[term * TAPS + MAX_RADIUS + stride] = after;
+    }
+};
+
+}
+#endif //PROJECT_BASE_POSTPROCESSING_H
@@ -0,0 +1,274 @@
+#ifndef PROJECT_BASE_SCENEGRAPH_H
+#define PROJECT_BASE_SCENEGRAPH_H
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64) || defined(_M_AMD64)
+#include <xmmintrin.h>
+#define RG_SCENE_GRAPH_SSE 1
+#endif
+
+#include <rg/NodeAnimation.h>
+
+namespace rg {
+
+// Transform hierarchy as structure of arrays. Nodes are stored sorted by depth, so every parent
+// precedes its children and the nodes of one depth form a contiguous range whose world
+// matrices only read the range before it: Update() is one linear pass, and each level could
+// be split across threads. Node handles stay valid through the reordering.
+// Setting a local translation, rotation or scale marks the node dirty only when the value
+// changes. Update() starts at the first dirty slot, pushes the flag from parents to children
+// on the way and rebuilds only dirty world matrices, a frame without changes costs nothing.
+class SceneGraph {
+public:
+    // returns the node handle, parent is a handle or -1 for a root
+    int Create(int parent = -1, const glm::vec3& translation = glm::vec3(0.0f),
+               const glm::vec4& rotation = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), const glm::vec3& scale = glm::vec3(1.0f)) {
+        int handle = (int) m_Slot.size();
+        int slot = (int) m_Parent.size();
+        m_Slot.push_back(slot);
+        m_Handle.push_back(handle);
+        m_Parent.push_back(parent < 0 ? -1 : m_Slot[parent]);
+        m_TX.push_back(translation.x), m_TY.push_back(translation.y), m_TZ.push_back(translation.z);
+        m_RX.push_back(rotation.x), m_RY.push_back(rotation.y), m_RZ.push_back(rotation.z), m_RW.push_back(rotation.w);
+        m_SX.push_back(scale.x), m_SY.push_back(scale.y), m_SZ.push_back(scale.z);
+        m_World.push_back(glm::mat4(1.0f));
+        m_Dirty.push_back(1);
+        m_FirstDirty = std::min(m_FirstDirty, slot);
+        m_Sorted = false;
+        return handle;
+    }
+
+    // Adds an imported hierarchy (Model::nodes) under parent and returns the handles of its
+    // nodes in the same order. The node matrices are taken apart into translation, rotation
+    // and scale, which assumes they have no shear.
+    std::vector<int> AddHierarchy(const std::vector<AnimationNode>& nodes, int parent = -1) {
+        std::vector<int> handles;
+        for (const AnimationNode& node : nodes) {
+            handles.push_back(Create(node.Parent < 0 ? parent : handles[node.Parent]));
+            SetLocal(handles.back(), node.Transform);
+        }
+        return handles;
+    }
+
+    void SetTranslation(int node, const glm::vec3& translation) {
+        int slot = m_Slot[node];
+        if (m_TX[slot] == translation.x && m_TY[slot] == translation.y && m_TZ[slot] == translation.z)
+            return;
+        m_TX[slot] = translation.x, m_TY[slot] = translation.y, m_TZ[slot] = translation.z;
+        markDirty(slot);
+    }
+
+    // a unit quaternion (x, y, z, w)
+    void SetRotation(int node, const glm::vec4& rotation) {
+        int slot = m_Slot[node];
+        if (m_RX[slot] == rotation.x && m_RY[slot] == rotation.y && m_RZ[slot] == rotation.z && m_RW[slot] == rotation.w)
+            return;
+        m_RX[slot] = rotation.x, m_RY[slot] = rotation.y, m_RZ[slot] = rotation.z, m_RW[slot] = rotation.w;
+        markDirty(slot);
+    }
+
+    void SetScale(int node, const glm::vec3& scale) {
+        int slot = m_Slot[node];
+        if (m_SX[slot] == scale.x && m_SY[slot] == scale.y && m_SZ[slot] == scale.z)
+            return;
+        m_SX[slot] = scale.x, m_SY[slot] = scale.y, m_SZ[slot] = scale.z;
+        markDirty(slot);
+    }
+
+    void SetLocal(int node, const glm::mat4& local) {
+        glm::vec3 scale(glm::length(glm::vec3(local[0])), glm::length(glm::vec3(local[1])), glm::length(glm::vec3(local[2])));
+        glm::vec3 x = glm::vec3(local[0]) / scale.x, y = glm::vec3(local[1]) / scale.y, z = glm::vec3(local[2]) / scale.z;
+        // rotation matrix to quaternion, from the largest diagonal term for stability
+        glm::vec4 q;
+        float trace = x.x + y.y + z.z;
+        if (trace > 0.0f) {
+            float s = 0.5f / std::sqrt(trace + 1.0f);
+            q = glm::vec4((y.z - z.y) * s, (z.x - x.z) * s, (x.y - y.x) * s, 0.25f / s);
+        } else if (x.x > y.y && x.x > z.z) {
+            float s = 2.0f * std::sqrt(1.0f + x.x - y.y - z.z);
+            q = glm::vec4(0.25f * s, (y.x + x.y) / s, (z.x + x.z) / s, (y.z - z.y) / s);
+        } else if (y.y > z.z) {
+            float s = 2.0f * std::sqrt(1.0f + y.y - x.x - z.z);
+            q = glm::vec4((y.x + x.y) / s, 0.25f * s, (z.y + y.z) / s, (z.x - x.z) / s);
+        } else {
+            float s = 2.0f * std::sqrt(1.0f + z.z - x.x - y.y);
+            q = glm::vec4((z.x + x.z) / s, (z.y + y.z) / s, 0.25f * s, (x.y - y.x) / s);
+        }
+        SetTranslation(node, glm::vec3(local[3]));
+        SetRotation(node, q);
+        SetScale(node, scale);
+    }
+
+    glm::vec3 Translation(int node) const {
+        int slot = m_Slot[node];
+        return glm::vec3(m_TX[slot], m_TY[slot], m_TZ[slot]);
+    }
+
+    // valid after Update()
+    const glm::mat4& World(int node) const {
+        return m_World[m_Slot[node]];
+    }
+
+    int NodeCount() const {
+        return (int) m_Parent.size();
+    }
+
+    // world matrices the last Update() rebuilt, and its CPU time
+    int LastUpdatedCount() const {
+        return m_UpdatedCount;
+    }
+
+    float LastUpdateMs() const {
+        return m_UpdateMs;
+    }
+
+    void Update() {
+        auto start = std::chrono::high_resolution_clock::now();
+        m_UpdatedCount = 0;
+        if (!m_Sorted)
+            sort();
+        int count = (int) m_Parent.size();
+        for (int slot = m_FirstDirty; slot < count; slot++) {
+            int parent = m_Parent[slot];
+            if (parent >= 0)
+                m_Dirty[slot] |= m_Dirty[parent];
+            if (!m_Dirty[slot])
+                continue;
+            glm::mat4 local = trsMatrix(glm::vec3(m_TX[slot], m_TY[slot], m_TZ[slot]),
+                                        glm::vec4(m_RX[slot], m_RY[slot], m_RZ[slot], m_RW[slot]),
+                                        glm::vec3(m_SX[slot], m_SY[slot], m_SZ[slot]));
+            if (parent < 0)
+                m_World[slot] = local;
+            else
+                multiply(m_World[parent], local, m_World[slot]);
+            m_UpdatedCount++;
+        }
+        if (m_FirstDirty < count)
+            std::fill(m_Dirty.begin() + m_FirstDirty, m_Dirty.end(), 0);
+        m_FirstDirty = count;
+        m_UpdateMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    }
+
+private:
+    // handle -> slot and back
+    std::vector<int> m_Slot;
+    std::vector<int> m_Handle;
+    // slot of the parent, -1 for roots
+    std::vector<int> m_Parent;
+    std::vector<float> m_TX, m_TY, m_TZ, m_RX, m_RY, m_RZ, m_RW, m_SX, m_SY, m_SZ;
+    std::vector<glm::mat4> m_World;
+    std::vector<uint8_t> m_Dirty;
+    int m_FirstDirty = 0;
+    bool m_Sorted = true;
+    int m_UpdatedCount = 0;
+    float m_UpdateMs = 0.0f;
+
+    void markDirty(int slot) {
+        m_Dirty[slot] = 1;
+        m_FirstDirty = std::min(m_FirstDirty, slot);
+    }
+
+    // result = a * b, a column of the result is the columns of a weighted by a column of b
+    static void multiply(const glm::mat4& a, const glm::mat4& b, glm::mat4& result) {
+#ifdef RG_SCENE_GRAPH_SSE
+        __m128 columns[4];
+        for (int k = 0; k < 4; k++)
+            columns[k] = _mm_loadu_ps(&a[k][0]);
+        for (int j = 0; j < 4; j++) {
+            __m128 sum = _mm_mul_ps(columns[0], _mm_set1_ps(b[j][0]));
+            sum = _mm_add_ps(sum, _mm_mul_ps(columns[1], _mm_set1_ps(b[j][1])));
+            sum = _mm_add_ps(sum, _mm_mul_ps(columns[2], _mm_set1_ps(b[j][2])));
+            sum = _mm_add_ps(sum, _mm_mul_ps(columns[3], _mm_set1_ps(b[j][3])));
+            _mm_storeu_ps(&result[j][0], sum);
+        }
+#else
+        result = a * b;
+#endif
+    }
+
+    // stable sort of the slots by depth, parents were created before their children
+    void sort() {
+        size_t count = m_Parent.size();
+        std::vector<int> depth(count, 0);
+        for (size_t slot = 0; slot < count; slot++)
+            depth[slot] = m_Parent[slot] < 0 ? 0 : depth[m_Parent[slot]] + 1;
+        std::vector<int> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return depth[a] < depth[b]; });
+        std::vector<int> newSlot(count);
+        for (size_t i = 0; i < count; i++)
+            newSlot[order[i]] = (int) i;
+
+        std::vector<int> parent(count), handle(count);
+        for (size_t i = 0; i < count; i++) {
+            int old = order[i];
+            parent[i] = m_Parent[old] < 0 ? -1 : newSlot[m_Parent[old]];
+            handle[i] = m_Handle[old];
+            m_Slot[handle[i]] = (int) i;
+        }
+        m_Parent.swap(parent);
+        m_Handle.swap(handle);
+        for (std::vector<float>* column : {&m_TX, &m_TY, &m_TZ, &m_RX, &m_RY, &m_RZ, &m_RW, &m_SX, &m_SY, &m_SZ})
+            permute(*column, order);
+        permute(m_World, order);
+        permute(m_Dirty, order);
+        m_FirstDirty = 0;
+        while (m_FirstDirty < (int) count && !m_Dirty[m_FirstDirty])
+            m_FirstDirty++;
+        m_Sorted = true;
+    }
+
+    template <typename T>
+    static void permute(std::vector<T>& values, const std::vector<int>& order) {
+        std::vector<T> sorted(values.size());
+        for (size_t i = 0; i < order.size(); i++)
+            sorted[i] = values[order[i]];
+        values.swap(sorted);
+    }
+};
+
+struct SceneGraphBenchmark {
+    int Nodes = 0;
+    float FullMs = 0.0f;    // every node moved
+    float PartialMs = 0.0f; // one leaf in a hundred moved
+    float StaticMs = 0.0f;  // nothing moved
+};
+
+// Average Update() times of a four-ary tree of nodeCount nodes.
+inline SceneGraphBenchmark benchmarkSceneGraph(int nodeCount, int runs = 20) {
+    SceneGraph graph;
+    for (int i = 0; i < nodeCount; i++)
+        graph.Create(i == 0 ? -1 : (i - 1) / 4, glm::vec3(1.0f, 0.0f, 0.0f), glm::vec4(0.0f, 0.0f, 0.0f, 1.0f), glm::vec3(0.9f));
+    graph.Update();
+
+    SceneGraphBenchmark result;
+    result.Nodes = nodeCount;
+    for (int run = 0; run < runs; run++) {
+        graph.SetTranslation(0, glm::vec3(0.0f, (float) run + 1.0f, 0.0f));
+        graph.Update();
+        result.FullMs += graph.LastUpdateMs() / runs;
+
+        for (int i = nodeCount - 1 - run % 100; i >= nodeCount / 4 + 1; i -= 100)
+            graph.SetTranslation(i, glm::vec3(1.0f, (float) run + 1.0f, 0.0f));
+        graph.Update();
+        result.PartialMs += graph.LastUpdateMs() / runs;
+
+        graph.Update();
+        result.StaticMs += graph.LastUpdateMs() / runs;
+    }
+    std::cout << "Scene graph benchmark, " << nodeCount << " nodes: full " << result.FullMs << " ms, 1% moved "
+              << result.PartialMs << " ms, static " << result.StaticMs << " ms" << std::endl;
+    return result;
+}
+
+}
+#endif //PROJECT_BASE_SCENEGRAPH_H
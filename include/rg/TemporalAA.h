@@ -0,0 +1,175 @@
+#ifndef PROJECT_BASE_TEMPORALAA_H
+#define PROJECT_BASE_TEMPORALAA_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <learnopengl/shader.h>
+#include <rg/FrameGraph.h>
+#include <rg/GpuTimer.h>
+
+namespace rg {
+
+// Temporal anti-aliasing (resources/shaders/taa.fs). BeginFrame() offsets the projection by a
+// sub-pixel Halton jitter, AddPass() resolves the frame into a history texture at output
+// resolution, reprojecting the previous history with the camera motion. Only the camera moves
+// the history, animated objects rely on the neighbourhood clipping. With Upscale set the scene
+// is rendered at InternalScale of the output and the accumulation fills in the missing pixels.
+class TemporalAA {
+public:
+    static const int JITTER_PHASES = 8;
+
+    bool Enabled = true;
+    bool Upscale = false;
+    // rendered size relative to the output when upscaling without dynamic resolution
+    float InternalScale = 0.67f;
+    float BlendFactor = 0.1f;
+
+    TemporalAA() : m_Shader("resources/shaders/fullscreen.vs", "resources/shaders/taa.fs") {
+        glGenVertexArrays(1, &m_VAO);
+        m_Shader.use();
+        m_Shader.setInt("currentTexture", 0);
+        m_Shader.setInt("depthTexture", 1);
+        m_Shader.setInt("historyTexture", 2);
+    }
+
+    ~TemporalAA() {
+        glDeleteVertexArrays(1, &m_VAO);
+        releaseHistory();
+    }
+
+    TemporalAA(const TemporalAA&) = delete;
+    TemporalAA& operator=(const TemporalAA&) = delete;
+
+    // Call once per frame before the scene passes, with the unjittered matrices and the size
+    // the scene is rendered at. Returns the projection the scene passes should use.
+    glm::mat4 BeginFrame(const glm::mat4& projection, const glm::mat4& view,
+                         unsigned int renderWidth, unsigned int renderHeight) {
+        m_Frame++;
+        m_PreviousViewProjection = m_ViewProjection;
+        m_ViewProjection = projection * view;
+        if (!Enabled) {
+            m_Jitter = glm::vec2(0.0f);
+            return projection;
+        }
+
+        int phase = m_Frame % JITTER_PHASES + 1;
+        m_Jitter = glm::vec2(halton(phase, 2) - 0.5f, halton(phase, 3) - 0.5f);
+        // a shift of one pixel is 2 / size in NDC. The offset goes into the z column, which the
+        // divide by w = -z_view turns into minus the offset, so it is subtracted to move the
+        // geometry by +m_Jitter pixels, the direction taa.fs reconstructs the samples at
+        glm::mat4 jittered = projection;
+        jittered[2][0] -= m_Jitter.x * 2.0f / renderWidth;
+        jittered[2][1] -= m_Jitter.y * 2.0f / renderHeight;
+        return jittered;
+    }
+
+    // Adds the resolve of color and depth (rendered region renderWidth x renderHeight) and
+    // returns the new history, which is also the anti-aliased frame at the size of color.
+    FrameGraphResource AddPass(FrameGraph& graph, FrameGraphResource color, FrameGraphResource depth,
+                               unsigned int renderWidth, unsigned int renderHeight) {
+        const FrameGraphTextureDesc& colorDesc = graph.GetDesc(color);
+        FrameGraphTextureDesc desc(colorDesc.Width, colorDesc.Height, GL_RGBA16F);
+        if (!(desc == m_HistoryDesc)) {
+            releaseHistory();
+            createHistory(desc);
+        }
+
+        // a history that skipped a frame belongs to another camera and is dropped
+        bool historyValid = m_HasHistory && m_LastResolveFrame + 1 == m_Frame;
+        m_HasHistory = true;
+        m_LastResolveFrame = m_Frame;
+        int write = m_Frame % 2;
+        FrameGraphResource previous = graph.Import("taa history", m_History[1 - write], desc);
+        FrameGraphResource next = graph.Import("taa history", m_History[write], desc);
+        glm::vec2 renderScale((float) renderWidth / colorDesc.Width, (float) renderHeight / colorDesc.Height);
+
+        graph.AddPass("taa",
+            [&](FrameGraph::Builder& builder) {
+                builder.Read(color);
+                builder.Read(depth);
+                builder.Read(previous);
+                builder.Write(next);
+            },
+            [this, color, depth, previous, renderScale, historyValid](const FrameGraph& g) {
+                m_Timer.Begin();
+                m_Shader.use();
+                m_Shader.setVec2("renderScale", renderScale);
+                m_Shader.setVec2("jitter", m_Jitter);
+                m_Shader.setMat4("inverseViewProjection", glm::inverse(m_ViewProjection));
+                m_Shader.setMat4("previousViewProjection", m_PreviousViewProjection);
+                m_Shader.setFloat("blendFactor", BlendFactor);
+                m_Shader.setBool("historyValid", historyValid);
+                glDisable(GL_DEPTH_TEST);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, g.GetTexture(color));
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, g.GetTexture(depth));
+                glActiveTexture(GL_TEXTURE2);
+                glBindTexture(GL_TEXTURE_2D, g.GetTexture(previous));
+                glActiveTexture(GL_TEXTURE0);
+                glBindVertexArray(m_VAO);
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+                glEnable(GL_DEPTH_TEST);
+                m_Timer.End();
+            });
+        return next;
+    }
+
+    glm::vec2 Jitter() const {
+        return m_Jitter;
+    }
+
+    float LastMs() const {
+        return m_Timer.LastMs();
+    }
+
+private:
+    Shader m_Shader;
+    unsigned int m_VAO = 0;
+    unsigned int m_History[2] = {0, 0};
+    FrameGraphTextureDesc m_HistoryDesc;
+    unsigned int m_Frame = 0;
+    unsigned int m_LastResolveFrame = 0;
+    bool m_HasHistory = false;
+    glm::vec2 m_Jitter = glm::vec2(0.0f);
+    glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+    glm::mat4 m_PreviousViewProjection = glm::mat4(1.0f);
+    GpuTimer m_Timer;
+
+    static float halton(int index, int base) {
+        float result = 0.0f;
+        float fraction = 1.0f / base;
+        while (index > 0) {
+            result += fraction * (index % base);
+            index /= base;
+            fraction /= base;
+        }
+        return result;
+    }
+
+    void createHistory(const FrameGraphTextureDesc& desc) {
+        m_HistoryDesc = desc;
+        glGenTextures(2, m_History);
+        for (unsigned int texture : m_History) {
+            glBindTexture(GL_TEXTURE_2D, texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, desc.InternalFormat, desc.Width, desc.Height, 0, GL_RGBA, GL_FLOAT, NULL);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+        glBindTexture(GL_TEXTURE_2D, 0);
+        // the new textures hold garbage
+        m_HasHistory = false;
+    }
+
+    void releaseHistory() {
+        if (m_History[0])
+            glDeleteTextures(2, m_History);
+        m_History[0] = m_History[1] = 0;
+    }
+};
+
+}
+#endif //PROJECT_BASE_TEMPORALAA_H
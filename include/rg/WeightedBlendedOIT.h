@@ -0,0 +1,102 @@
+#ifndef PROJECT_BASE_WEIGHTEDBLENDEDOIT_H
+#define PROJECT_BASE_WEIGHTEDBLENDEDOIT_H
+
+#include <glad/glad.h>
+
+#include <functional>
+
+#include <learnopengl/shader.h>
+#include <rg/FrameGraph.h>
+
+namespace rg {
+
+// Weighted blended order-independent transparency (McGuire and Bavoil 2013). Translucent
+// geometry is drawn once, unsorted and without depth writes, into two targets:
+//  - accumulation (RGBA32F): rgb adds up color * alpha * weight, a multiplies up (1 - alpha),
+//  - weight (R32F): adds up alpha * weight.
+// The composite then lays the weighted average over the scene, so the cost does not depend on
+// how many layers overlap. Both targets share one blend function, the color channels add and
+// the alpha channel multiplies, which keeps the whole thing on plain GL 3.3 without per-target
+// blending. Fragment shaders of translucent materials write the two outputs as grass.fs does.
+// The targets are 32-bit float because the lit colors reach several hundred and the weights
+// go up to 3000, which overflows half floats after a few layers.
+class WeightedBlendedOIT {
+public:
+    bool Enabled = true;
+
+    WeightedBlendedOIT() : m_CompositeShader("resources/shaders/fullscreen.vs", "resources/shaders/oit_composite.fs") {
+        glGenVertexArrays(1, &m_VAO);
+        m_CompositeShader.use();
+        m_CompositeShader.setInt("accumulationTexture", 0);
+        m_CompositeShader.setInt("weightTexture", 1);
+    }
+
+    ~WeightedBlendedOIT() {
+        glDeleteVertexArrays(1, &m_VAO);
+    }
+
+    WeightedBlendedOIT(const WeightedBlendedOIT&) = delete;
+    WeightedBlendedOIT& operator=(const WeightedBlendedOIT&) = delete;
+
+    // Adds the accumulation pass, which calls draw with the blend state set up and depth tested
+    // against depth, and the composite into color. Only the rendered region is touched.
+    void AddPasses(FrameGraph& graph, FrameGraphResource color, FrameGraphResource depth,
+                   unsigned int renderWidth, unsigned int renderHeight, const std::function<void()>& draw) {
+        const FrameGraphTextureDesc& colorDesc = graph.GetDesc(color);
+        FrameGraphResource accumulation = -1;
+        FrameGraphResource weight = -1;
+
+        graph.AddPass("translucent",
+            [&](FrameGraph::Builder& builder) {
+                accumulation = builder.Write(builder.Create("oit accumulation",
+                    FrameGraphTextureDesc(colorDesc.Width, colorDesc.Height, GL_RGBA32F, GL_NEAREST)));
+                weight = builder.Write(builder.Create("oit weight",
+                    FrameGraphTextureDesc(colorDesc.Width, colorDesc.Height, GL_R32F, GL_NEAREST)));
+                builder.ReadDepth(depth);
+                builder.SetViewport(renderWidth, renderHeight);
+            },
+            [draw](const FrameGraph&) {
+                const float clearAccumulation[] = {0.0f, 0.0f, 0.0f, 1.0f};
+                const float clearWeight[] = {0.0f, 0.0f, 0.0f, 0.0f};
+                glClearBufferfv(GL_COLOR, 0, clearAccumulation);
+                glClearBufferfv(GL_COLOR, 1, clearWeight);
+
+                glDepthMask(GL_FALSE);
+                glEnable(GL_BLEND);
+                glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+                draw();
+                glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                glDisable(GL_BLEND);
+                glDepthMask(GL_TRUE);
+            });
+
+        graph.AddPass("translucent composite",
+            [&](FrameGraph::Builder& builder) {
+                builder.Read(accumulation);
+                builder.Read(weight);
+                builder.Write(color);
+                builder.SetViewport(renderWidth, renderHeight);
+            },
+            [this, accumulation, weight](const FrameGraph& g) {
+                m_CompositeShader.use();
+                glDisable(GL_DEPTH_TEST);
+                glEnable(GL_BLEND);
+                glActiveTexture(GL_TEXTURE0);
+                glBindTexture(GL_TEXTURE_2D, g.GetTexture(accumulation));
+                glActiveTexture(GL_TEXTURE1);
+                glBindTexture(GL_TEXTURE_2D, g.GetTexture(weight));
+                glActiveTexture(GL_TEXTURE0);
+                glBindVertexArray(m_VAO);
+                glDrawArrays(GL_TRIANGLES, 0, 3);
+                glDisable(GL_BLEND);
+                glEnable(GL_DEPTH_TEST);
+            });
+    }
+
+private:
+    Shader m_CompositeShader;
+    unsigned int m_VAO = 0;
+};
+
+}
+#endif //PROJECT_BASE_WEIGHTEDBLENDEDOIT_H
@@ -0,0 +1,78 @@
+#version 330 core
+
+// 13-tap downsample from the next larger level of the bloom chain (Jimenez, "Next Generation
+// Post Processing in Call of Duty: Advanced Warfare"). The taps form five overlapping 2x2 boxes
+// that are bilinear filtered in hardware, which avoids the shimmering of a plain 2x2 box.
+
+out vec3 FragColor;
+in vec2 texCoords;
+
+uniform sampler2D sourceTexture;
+// part of sourceTexture holding the image, below 1 only for the scene under dynamic resolution
+uniform vec2 renderScale;
+// the first downsample weights each box by its luma so single very bright pixels cannot flicker
+uniform bool karisAverage;
+// source texels per tap step, 1 for a 2:1 reduction
+uniform float sampleSpacing;
+
+vec3 fetch(vec2 uv, vec2 texelSize) {
+    uv = clamp(uv, 0.5 * texelSize, renderScale - 0.5 * texelSize);
+    return texture(sourceTexture, uv).rgb;
+}
+
+float karisWeight(vec3 color) {
+    float luma = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    return 1.0 / (1.0 + luma);
+}
+
+void main()
+{
+    vec2 texelSize = 1.0 / vec2(textureSize(sourceTexture, 0));
+    vec2 uv = texCoords * renderScale;
+    float x = texelSize.x * sampleSpacing;
+    float y = texelSize.y * sampleSpacing;
+
+    // a - b - c
+    // - j - k -
+    // d - e - f
+    // - l - m -
+    // g - h - i
+    vec3 a = fetch(uv + vec2(-2.0 * x,  2.0 * y), texelSize);
+    vec3 b = fetch(uv + vec2( 0.0,      2.0 * y), texelSize);
+    vec3 c = fetch(uv + vec2( 2.0 * x,  2.0 * y), texelSize);
+    vec3 d = fetch(uv + vec2(-2.0 * x,  0.0), texelSize);
+    vec3 e = fetch(uv, texelSize);
+    vec3 f = fetch(uv + vec2( 2.0 * x,  0.0), texelSize);
+    vec3 g = fetch(uv + vec2(-2.0 * x, -2.0 * y), texelSize);
+    vec3 h = fetch(uv + vec2( 0.0,     -2.0 * y), texelSize);
+    vec3 i = fetch(uv + vec2( 2.0 * x, -2.0 * y), texelSize);
+    vec3 j = fetch(uv + vec2(-x,  y), texelSize);
+    vec3 k = fetch(uv + vec2( x,  y), texelSize);
+    vec3 l = fetch(uv + vec2(-x, -y), texelSize);
+    vec3 m = fetch(uv + vec2( x, -y), texelSize);
+
+    vec3 boxes[5] = vec3[](
+        (j + k + l + m) * 0.25,
+        (a + b + d + e) * 0.25,
+        (b + c + e + f) * 0.25,
+        (d + e + g + h) * 0.25,
+        (e + f + h + i) * 0.25
+    );
+    float weights[5] = float[](0.5, 0.125, 0.125, 0.125, 0.125);
+
+    vec3 color = vec3(0.0);
+    if (karisAverage) {
+        float weightSum = 0.0;
+        for (int n = 0; n < 5; n++) {
+            float w = weights[n] * karisWeight(boxes[n]);
+            color += boxes[n] * w;
+            weightSum += w;
+        }
+        color /= weightSum;
+    } else {
+        for (int n = 0; n < 5; n++)
+            color += boxes[n] * weights[n];
+    }
+    // keeps NaNs and negative values out of the chain, they would spread over the whole screen
+    FragColor = max(color, vec3(0.0001));
+}
@@ -0,0 +1,29 @@
+#version 330 core
+
+// 3x3 tent upsample of the next smaller level of the bloom chain, added on top of the current
+// level with GL_ONE, GL_ONE blending. The radius is given in texture coordinates, so every level
+// spreads over the same fraction of the screen and the coarse levels produce the wide glow.
+
+out vec3 FragColor;
+in vec2 texCoords;
+
+uniform sampler2D sourceTexture;
+uniform float filterRadius;
+
+void main()
+{
+    vec2 size = vec2(textureSize(sourceTexture, 0));
+    float x = filterRadius;
+    float y = filterRadius * size.x / size.y;
+
+    vec3 color = texture(sourceTexture, texCoords).rgb * 4.0;
+    color += (texture(sourceTexture, texCoords + vec2(-x, 0.0)).rgb
+            + texture(sourceTexture, texCoords + vec2( x, 0.0)).rgb
+            + texture(sourceTexture, texCoords + vec2(0.0, -y)).rgb
+            + texture(sourceTexture, texCoords + vec2(0.0,  y)).rgb) * 2.0;
+    color += texture(sourceTexture, texCoords + vec2(-x, -y)).rgb
+           + texture(sourceTexture, texCoords + vec2( x, -y)).rgb
+           + texture(sourceTexture, texCoords + vec2(-x,  y)).rgb
+           + texture(sourceTexture, texCoords + vec2( x,  y)).rgb;
+    FragColor = color / 16.0;
+}
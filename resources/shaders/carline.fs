@@ -1,7 +1,9 @@
 #version 330 core
+#include "debug_view.glsl"
 
 out vec4 FragColor;
 
 void main() {
     FragColor = vec4(1.0f, 1.0f, 1.0f, 1.0f);
+    FragColor = debugViewColor(FragColor);
 }
\ No newline at end of file
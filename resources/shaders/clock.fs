@@ -1,4 +1,5 @@
 #version 330 core
+#include "debug_view.glsl"
 out vec4 FragColor;
 
 struct PointLight {
@@ -22,6 +23,9 @@ struct Material {
 in vec2 TexCoords;
 in vec3 Normal;
 in vec3 FragPos;
+// 1 draws every fragment. While two levels of detail cross-fade the new one draws the
+// fraction f of the pixels with f and the old one the rest with -f.
+flat in float LodFade;
 
 uniform PointLight pointLight;
 uniform Material material;
@@ -69,10 +73,22 @@ float logisticDepth(float depth, float steepness, float offset) {
 }
 
 
+// 4x4 ordered dither threshold in (0, 1)
+float bayer4(vec2 fragCoord) {
+    const float matrix[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+                                       3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(fragCoord) & 3;
+    return (matrix[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
 void main() {
+    float threshold = bayer4(gl_FragCoord.xy);
+    if (LodFade >= 0.0 ? threshold >= LodFade : threshold < -LodFade)
+        discard;
     vec3 normal = normalize(Normal);
     vec3 viewDir = normalize(viewPosition - FragPos);
     vec3 result = CalcPointLight(pointLight, normal, FragPos, viewDir);
     float depth = logisticDepth(gl_FragCoord.z, 0.5, 5.0);
     FragColor = vec4(result, 1.0) * (1.0f - depth) + vec4(depth * vec3(0.70, 0.70, 0.70), 1.0f);
+    FragColor = debugViewColor(FragColor);
 }
\ No newline at end of file
@@ -6,15 +6,53 @@ layout (location = 2) in vec2 aTexCoords;
 out vec2 TexCoords;
 out vec3 Normal;
 out vec3 FragPos;
+// level of detail cross-fade, see clock.fs
+flat out float LodFade;
 
 uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
+uniform float lodFade;
+
+// the clock swarm of main.cpp evaluated here, instance gl_InstanceID is clock gl_InstanceID + 1
+uniform bool proceduralMotion;
+uniform float time;
+uniform vec3 swarmOrigin;
+uniform float swarmScale;
+
+// node matrices of rg::NodeAnimator, instance gl_InstanceID plays phase gl_InstanceID % phases
+uniform bool nodeAnimation;
+uniform samplerBuffer nodeMatrices;
+uniform int nodeCount;
+uniform int phases;
+uniform int node;
+
+mat4 nodeMatrix()
+{
+    int first = 4 * ((gl_InstanceID % phases) * nodeCount + node);
+    return mat4(texelFetch(nodeMatrices, first), texelFetch(nodeMatrices, first + 1),
+                texelFetch(nodeMatrices, first + 2), texelFetch(nodeMatrices, first + 3));
+}
+
+// the clockTransform lambda of main.cpp
+mat4 clockTransform(float i)
+{
+    float t = time / 1000.0;
+    vec3 position = swarmOrigin + vec3(cos(i * t) * ((i + 1.0) * t), 10.0 + sin(t * 20.0) * 2.0 * cos(t * 20.0), 35.0 * sin(t * i + 5.0));
+    return mat4(vec4(swarmScale, 0.0, 0.0, 0.0), vec4(0.0, swarmScale, 0.0, 0.0), vec4(0.0, 0.0, swarmScale, 0.0), vec4(position, 1.0));
+}
 
 void main()
 {
-    FragPos = vec3(model * vec4(aPos, 1.0));
+    mat4 transform = proceduralMotion ? clockTransform(float(gl_InstanceID + 1)) : model;
     Normal = aNormal;
+    if (nodeAnimation) {
+        mat4 animated = nodeMatrix();
+        transform = transform * animated;
+        Normal = mat3(animated) * aNormal;
+    }
+    FragPos = vec3(transform * vec4(aPos, 1.0));
     TexCoords = aTexCoords;    
+    LodFade = lodFade;
     gl_Position = projection * view * vec4(FragPos, 1.0);
 }
\ No newline at end of file
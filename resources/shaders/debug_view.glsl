@@ -0,0 +1,22 @@
+// Debug views of rg::DebugView, included by the scene fragment shaders after #version.
+// Shader::use() sets debugView and debugShaderCost, Mesh::Draw() sets debugMeshIndex.
+// 0 = scene, 1 = overdraw, 2 = shader cost, 3 = mesh index
+uniform int debugView;
+// estimated instructions per fragment of this program
+uniform float debugShaderCost;
+uniform int debugMeshIndex;
+
+// views 1 and 2 are drawn with additive blending, red sums the layers (or their cost) of a pixel
+vec4 debugViewColor(vec4 color) {
+    if (debugView == 1)
+        return vec4(1.0f, 0.0f, 0.0f, 1.0f);
+    if (debugView == 2)
+        return vec4(debugShaderCost, 0.0f, 0.0f, 1.0f);
+    if (debugView == 3) {
+        // integer hash, neighbouring indices get unrelated colours
+        uint h = uint(debugMeshIndex) * 2654435761u;
+        h ^= h >> 15;
+        return vec4(vec3(uvec3(h, h >> 8, h >> 16) & 255u) / 255.0f * 0.8f + 0.2f, 1.0f);
+    }
+    return color;
+}
@@ -1,4 +1,5 @@
 #version 330 core
+#include "debug_view.glsl"
 out vec4 FragColor;
 
 struct PointLight {
@@ -78,4 +79,5 @@ void main() {
     vec3 result = CalcPointLight(pointLight, normal, FragPos, viewDir);
     float depth = logisticDepth(gl_FragCoord.z, 0.5, 5.0);
     FragColor = vec4(result, 1.0) * (1.0f - depth) + vec4(depth * vec3(0.70, 0.70, 0.70), 1.0f);
+    FragColor = debugViewColor(FragColor);
 }
\ No newline at end of file
@@ -0,0 +1,52 @@
+#version 430 core
+
+// Reduces the histogram of histogram.cs to the average log luminance with one group of
+// 256 threads, adapts the stored luminance towards it and derives the exposure the tonemap
+// reads. The histogram is cleared for the next frame on the way, so nothing goes to the CPU.
+
+#define BIN_COUNT 256
+
+layout (local_size_x = BIN_COUNT) in;
+
+layout (std430, binding = 0) buffer Exposure {
+    uint histogram[BIN_COUNT];
+    float averageLuminance;
+    float adaptedExposure;
+};
+
+uniform uint pixelCount;
+uniform float minLogLuminance;
+uniform float logLuminanceRange;
+// 1 - exp(-deltaTime * speed), computed on the CPU
+uniform float adaptation;
+// middle grey the average luminance is mapped to
+uniform float keyValue;
+uniform float minExposure;
+uniform float maxExposure;
+
+shared float weighted[BIN_COUNT];
+
+void main() {
+    uint bin = gl_LocalInvocationIndex;
+    uint count = histogram[bin];
+    histogram[bin] = 0u;
+    weighted[bin] = float(count) * float(bin);
+    barrier();
+
+    for (uint stride = BIN_COUNT / 2u; stride > 0u; stride >>= 1u) {
+        if (bin < stride)
+            weighted[bin] += weighted[bin + stride];
+        barrier();
+    }
+
+    if (bin == 0u) {
+        // bin 0 are the black pixels, they would drag the average down
+        float litPixels = max(float(pixelCount) - float(count), 1.0);
+        float meanBin = weighted[0] / litPixels;
+        float logLuminance = (meanBin - 1.0) / 254.0 * logLuminanceRange + minLogLuminance;
+        float luminance = exp2(logLuminance);
+
+        averageLuminance += (luminance - averageLuminance) * adaptation;
+        adaptedExposure = clamp(keyValue / max(averageLuminance, 0.0001), minExposure, maxExposure);
+    }
+}
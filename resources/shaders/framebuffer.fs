@@ -5,20 +5,85 @@ in vec2 texCoords;
 
 uniform sampler2D screenTexture;
 uniform bool HDR;
+uniform bool postProcessing;
 uniform float gamma;
+// part of screenTexture the scene was rendered into (dynamic resolution)
+uniform vec2 renderScale;
+// top level of the bloom chain, covers the rendered region in [0, 1]
+uniform sampler2D bloomTexture;
+uniform bool bloom;
+uniform float bloomStrength;
+// rg::DebugView mode, 1 and 2 show red / debugViewScale as a heat ramp, 3 the colours as they are
+uniform int debugView;
+uniform float debugViewScale;
 
-const float offset_x = 1.0f / 800.0f;  
-const float offset_y = 1.0f / 800.0f;  
+const float offset_x = 1.0f / 800.0f;
+const float offset_y = 1.0f / 800.0f;
 
 
 vec2 offsets[9] = vec2[]
 (
     vec2(-offset_x,  offset_y), vec2( 0.0f,    offset_y), vec2( offset_x,  offset_y),
     vec2(-offset_x,  0.0f),     vec2( 0.0f,    0.0f),     vec2( offset_x,  0.0f),
-    vec2(-offset_x, -offset_y), vec2( 0.0f,   -offset_y), vec2( offset_x, -offset_y) 
+    vec2(-offset_x, -offset_y), vec2( 0.0f,   -offset_y), vec2( offset_x, -offset_y)
 );
 
+// keeps bilinear taps inside the rendered region so stale texels from a bigger frame never bleed in
+vec2 clampToRenderedRegion(vec2 uv, vec2 texSize) {
+    return clamp(uv, vec2(0.5f) / texSize, renderScale - vec2(0.5f) / texSize);
+}
+
+// Catmull-Rom upscale from the rendered region, 9 bilinear taps instead of 16 point taps.
+// At renderScale == 1 every pixel lands on a texel center and the result is exact.
+vec3 sampleScene(vec2 uv) {
+    vec2 texSize = vec2(textureSize(screenTexture, 0));
+    vec2 samplePos = uv * renderScale * texSize;
+    vec2 texPos1 = floor(samplePos - 0.5f) + 0.5f;
+    vec2 f = samplePos - texPos1;
+
+    vec2 w0 = f * (-0.5f + f * (1.0f - 0.5f * f));
+    vec2 w1 = 1.0f + f * f * (-2.5f + 1.5f * f);
+    vec2 w2 = f * (0.5f + f * (2.0f - 1.5f * f));
+    vec2 w3 = f * f * (-0.5f + 0.5f * f);
+
+    vec2 w12 = w1 + w2;
+    vec2 texPos0 = clampToRenderedRegion((texPos1 - 1.0f) / texSize, texSize);
+    vec2 texPos3 = clampToRenderedRegion((texPos1 + 2.0f) / texSize, texSize);
+    vec2 texPos12 = clampToRenderedRegion((texPos1 + w2 / w12) / texSize, texSize);
+
+    vec3 result = vec3(0.0f);
+    result += texture(screenTexture, vec2(texPos0.x,  texPos0.y)).rgb * w0.x * w0.y;
+    result += texture(screenTexture, vec2(texPos12.x, texPos0.y)).rgb * w12.x * w0.y;
+    result += texture(screenTexture, vec2(texPos3.x,  texPos0.y)).rgb * w3.x * w0.y;
+
+    result += texture(screenTexture, vec2(texPos0.x,  texPos12.y)).rgb * w0.x * w12.y;
+    result += texture(screenTexture, vec2(texPos12.x, texPos12.y)).rgb * w12.x * w12.y;
+    result += texture(screenTexture, vec2(texPos3.x,  texPos12.y)).rgb * w3.x * w12.y;
+
+    result += texture(screenTexture, vec2(texPos0.x,  texPos3.y)).rgb * w0.x * w3.y;
+    result += texture(screenTexture, vec2(texPos12.x, texPos3.y)).rgb * w12.x * w3.y;
+    result += texture(screenTexture, vec2(texPos3.x,  texPos3.y)).rgb * w3.x * w3.y;
+    // Catmull-Rom has negative lobes, do not let them ring below black
+    return max(result, vec3(0.0f));
+}
+
+// black, blue, green, yellow, red, then white above the scale
+vec3 heat(float t) {
+    if (t <= 0.0f)
+        return vec3(0.0f);
+    vec3 ramp = clamp(vec3(4.0f * t - 2.0f, t < 0.75f ? 4.0f * t - 1.0f : 4.0f - 4.0f * t, 2.0f - 4.0f * t), 0.0f, 1.0f);
+    ramp.b = t < 0.25f ? 4.0f * t : ramp.b;
+    return mix(ramp, vec3(1.0f), clamp(t - 1.0f, 0.0f, 1.0f));
+}
+
 void main() {
+    if (debugView != 0) {
+        // nearest texel, filtering would blend counts of neighbouring pixels
+        vec2 texSize = vec2(textureSize(screenTexture, 0));
+        vec3 value = texelFetch(screenTexture, ivec2(min(texCoords * renderScale * texSize, texSize * renderScale - 1.0f)), 0).rgb;
+        FragColor = vec4(debugView == 3 ? value : heat(value.r / debugViewScale), 1.0f);
+        return;
+    }
 
     float kernel[9] = float[](
         -3,  2, -3,
@@ -26,15 +91,21 @@ void main() {
         -3,  2, -3
     );
 
-    if (HDR) {
+    if (!postProcessing) {
+        // same output as rendering straight into the default framebuffer, only upscaled
+        FragColor = vec4(sampleScene(texCoords), 1.0f);
+    } else if (HDR) {
+        vec2 texSize = vec2(textureSize(screenTexture, 0));
         vec3 color = vec3(0.0f);
         for(int i = 0; i < 9; i++)
-            color += vec3(texture(screenTexture, texCoords.st + offsets[i])) * kernel[i];
+            color += vec3(texture(screenTexture, clampToRenderedRegion((texCoords.st + offsets[i]) * renderScale, texSize))) * kernel[i];
             FragColor = vec4(color, 1.0f);
     } else {
         float exposure = 0.1f;
-        vec3 fragment = texture(screenTexture, texCoords).rgb;
+        vec3 fragment = sampleScene(texCoords);
+        if (bloom)
+            fragment = mix(fragment, texture(bloomTexture, texCoords).rgb, bloomStrength);
         vec3 toneMapped = vec3(1.0f) - exp(-fragment * exposure);
-        FragColor.rgb = pow(toneMapped, vec3(1.0f/ gamma));    
+        FragColor.rgb = pow(toneMapped, vec3(1.0f/ gamma));
     }
-}
\ No newline at end of file
+}
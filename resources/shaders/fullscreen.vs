@@ -0,0 +1,11 @@
+#version 330 core
+
+out vec2 texCoords;
+
+// one triangle covering the screen, generated from gl_VertexID so no vertex buffer is needed
+void main()
+{
+    vec2 position = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);
+    texCoords = position;
+    gl_Position = vec4(position * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,58 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+// index of the drawn object, an instanced attribute that every indirect command offsets with
+// its baseInstance, so it needs no gl_DrawID or gl_BaseInstance
+layout (location = 5) in uint aObject;
+
+out vec2 TexCoords;
+out vec3 Normal;
+out vec3 FragPos;
+// level of detail cross-fade, see clock.fs
+flat out float LodFade;
+
+// layout of rg::GpuScene::Object
+struct Object {
+    vec4 sphere;
+    vec4 cone;
+    uint meshlet;
+    uint transform;
+    uint group;
+    uint lod;
+};
+
+layout (std430, binding = 0) readonly buffer Objects {
+    Object objects[];
+};
+
+layout (std430, binding = 1) readonly buffer Transforms {
+    mat4 transforms[];
+};
+
+// layout of rg::GpuScene::InstanceLod, one per transform
+struct InstanceLod {
+    uint current;
+    uint previous;
+    float fade;
+    uint padding;
+};
+
+layout (std430, binding = 7) readonly buffer InstanceLods {
+    InstanceLod instanceLods[];
+};
+
+uniform mat4 view;
+uniform mat4 projection;
+
+void main()
+{
+    Object object = objects[aObject];
+    mat4 model = transforms[object.transform];
+    InstanceLod lod = instanceLods[object.transform];
+    LodFade = lod.current == lod.previous ? 1.0 : (object.lod == lod.current ? lod.fade : -lod.fade);
+    FragPos = vec3(model * vec4(aPos, 1.0));
+    Normal = aNormal;
+    TexCoords = aTexCoords;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
@@ -1,5 +1,9 @@
 #version 330 core
-out vec4 FragColor;
+#include "debug_view.glsl"
+// with weightedBlended the outputs go to the targets of rg::WeightedBlendedOIT:
+// location 0 = (color * alpha * weight, alpha), location 1 = alpha * weight
+layout (location = 0) out vec4 FragColor;
+layout (location = 1) out float Weight;
 
 struct PointLight {
     vec3 position;
@@ -27,6 +31,8 @@ uniform PointLight pointLight;
 uniform Material material;
 
 uniform vec3 viewPosition;
+uniform bool weightedBlended;
+uniform float alphaCutoff;
 // calculates the color when using a point light.
 vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
 {
@@ -51,7 +57,7 @@ vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir)
         spec = 0.0;
     }
 
-    if (texture(material.texture_diffuse1, TexCoords).a < 0.1) {
+    if (texture(material.texture_diffuse1, TexCoords).a < alphaCutoff) {
         discard;
     }
 
@@ -87,5 +93,15 @@ void main() {
     vec3 result = CalcPointLight(pointLight, normal, FragPos, viewDir);
     float depth = logisticDepth(gl_FragCoord.z, 0.5, 5.0);
     // FragColor = vec4(result, 1.0) * (1.0f - depth) + vec4(depth * vec3(0.70, 0.70, 0.70), 1.0f);
-    FragColor = vec4(result, 1.0f);
+    if (weightedBlended) {
+        float alpha = texture(material.texture_diffuse1, TexCoords).a;
+        // McGuire and Bavoil 2013, eq. 9: near layers outweigh far ones, view depth from the 0.1 - 100 projection
+        float z = (2.0 * 0.1 * 100.0) / (100.0 + 0.1 - (gl_FragCoord.z * 2.0 - 1.0) * (100.0 - 0.1));
+        float weight = alpha * clamp(10.0 / (1e-5 + pow(z / 5.0, 2.0) + pow(z / 200.0, 6.0)), 1e-2, 3e3);
+        FragColor = vec4(result * alpha * weight, alpha);
+        Weight = alpha * weight;
+    } else {
+        FragColor = vec4(result, 1.0f);
+    }
+    FragColor = debugViewColor(FragColor);
 }
\ No newline at end of file
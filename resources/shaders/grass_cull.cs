@@ -0,0 +1,64 @@
+#version 430 core
+
+// Frustum and distance culling of the grass instances. Every visible instance is appended to
+// the region of its LOD in the visible buffer, the append counter is the instanceCount of that
+// LOD's indirect draw command, so the draws need nothing from the CPU.
+
+#define LOD_COUNT 2
+
+layout (local_size_x = 256) in;
+
+struct Instance {
+    vec4 positionHeight;
+    vec4 params;
+};
+
+struct DrawArraysIndirectCommand {
+    uint count;
+    uint instanceCount;
+    uint first;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Instances {
+    Instance instances[];
+};
+
+layout (std430, binding = 1) writeonly buffer Visible {
+    Instance visible[];
+};
+
+layout (std430, binding = 2) buffer Commands {
+    DrawArraysIndirectCommand commands[LOD_COUNT];
+};
+
+uniform uint instanceCount;
+// first index of every LOD's region in visible
+uniform uint capacity;
+uniform vec4 frustumPlanes[6];
+uniform vec3 cameraPosition;
+uniform float lodDistance;
+uniform float maxDistance;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= instanceCount)
+        return;
+
+    Instance instance = instances[index];
+    // a sphere around the middle of the blade
+    float radius = instance.positionHeight.w * 0.6;
+    vec3 center = instance.positionHeight.xyz + vec3(0.0, instance.positionHeight.w * 0.5, 0.0);
+    for (int i = 0; i < 6; i++)
+        if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius)
+            return;
+
+    vec3 toCamera = center - cameraPosition;
+    float distanceSquared = dot(toCamera, toCamera);
+    if (distanceSquared > maxDistance * maxDistance)
+        return;
+
+    uint lod = distanceSquared < lodDistance * lodDistance ? 0u : 1u;
+    uint slot = atomicAdd(commands[lod].instanceCount, 1u);
+    visible[lod * capacity + slot] = instance;
+}
@@ -0,0 +1,47 @@
+#version 330 core
+#include "debug_view.glsl"
+out vec4 FragColor;
+
+struct PointLight {
+    vec3 position;
+
+    vec3 specular;
+    vec3 diffuse;
+    vec3 ambient;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+in vec3 FragPos;
+in vec3 Normal;
+in float Height;
+in float Shade;
+
+uniform PointLight pointLight;
+uniform vec3 viewPosition;
+
+const vec3 rootColor = vec3(0.05, 0.18, 0.03);
+const vec3 tipColor = vec3(0.45, 0.62, 0.16);
+
+void main()
+{
+    vec3 albedo = mix(rootColor, tipColor, Height) * Shade;
+    vec3 normal = normalize(Normal);
+    vec3 lightDir = normalize(pointLight.position - FragPos);
+    vec3 viewDir = normalize(viewPosition - FragPos);
+
+    // blades are thin, both sides take the light
+    float diff = abs(dot(normal, lightDir));
+    float spec = pow(max(abs(dot(normal, normalize(viewDir + lightDir))), 0.0), 32.0) * 0.05 * Height;
+
+    float distance = length(pointLight.position - FragPos);
+    float attenuation = 1.0 / (pointLight.constant + pointLight.linear * distance + pointLight.quadratic * (distance * distance));
+
+    vec3 ambient = pointLight.ambient * albedo;
+    vec3 diffuse = pointLight.diffuse * diff * albedo;
+    vec3 specular = pointLight.specular * spec;
+    FragColor = vec4((ambient + diffuse + specular) * attenuation, 1.0);
+    FragColor = debugViewColor(FragColor);
+}
@@ -0,0 +1,36 @@
+#version 330 core
+
+// One grass blade per instance. The blade shape comes from a tiny shared vertex buffer,
+// everything else from the per-instance attributes written by rg::GrassField.
+layout (location = 0) in vec2 aBlade;          // x: -1 .. 1 across the blade, y: 0 .. 1 up
+layout (location = 3) in vec4 aPositionHeight; // root position, blade height
+layout (location = 4) in vec4 aParams;         // facing angle, bend, width, shade
+
+out vec3 FragPos;
+out vec3 Normal;
+out float Height;
+out float Shade;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform float time;
+
+void main()
+{
+    float height = aPositionHeight.w;
+    float t = aBlade.y;
+    vec3 facing = vec3(cos(aParams.x), 0.0, sin(aParams.x));
+    vec3 side = vec3(-facing.z, 0.0, facing.x);
+
+    // the blade bends forward quadratically, the wind adds to the bend
+    float wind = sin(time * 1.7 + aPositionHeight.x * 0.35 + aPositionHeight.z * 0.27) * 0.25;
+    float bend = aParams.y + wind;
+    vec3 offset = side * aBlade.x * aParams.z * (1.0 - t) + vec3(0.0, t * height, 0.0) + facing * bend * t * t * height;
+
+    FragPos = aPositionHeight.xyz + offset;
+    vec3 tangent = vec3(0.0, height, 0.0) + facing * 2.0 * bend * t * height;
+    Normal = normalize(cross(side, tangent));
+    Height = t;
+    Shade = aParams.w;
+    gl_Position = projection * view * vec4(FragPos, 1.0);
+}
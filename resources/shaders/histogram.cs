@@ -0,0 +1,47 @@
+#version 430 core
+
+// Builds a 256-bin histogram of log2 luminance over the rendered region of the HDR scene.
+// Every group counts its 16x16 pixels in shared memory and adds the non-empty bins to the
+// global histogram once, so the global atomics are 256 per group instead of one per pixel.
+// Bin 0 holds the pixels darker than minLogLuminance, exposure.cs leaves it out.
+
+#define TILE 16
+#define BIN_COUNT 256
+
+layout (local_size_x = TILE, local_size_y = TILE) in;
+
+layout (binding = 0) uniform sampler2D sourceTexture;
+
+layout (std430, binding = 0) buffer Exposure {
+    uint histogram[BIN_COUNT];
+    float averageLuminance;
+    float adaptedExposure;
+};
+
+uniform ivec2 renderSize;
+uniform float minLogLuminance;
+uniform float inverseLogLuminanceRange;
+
+shared uint bins[BIN_COUNT];
+
+uint luminanceToBin(vec3 color) {
+    float luminance = dot(color, vec3(0.2126, 0.7152, 0.0722));
+    if (luminance < 0.0001)
+        return 0u;
+    float logLuminance = clamp((log2(luminance) - minLogLuminance) * inverseLogLuminanceRange, 0.0, 1.0);
+    return uint(logLuminance * 254.0 + 1.0);
+}
+
+void main() {
+    bins[gl_LocalInvocationIndex] = 0u;
+    barrier();
+
+    ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+    if (all(lessThan(pixel, renderSize)))
+        atomicAdd(bins[luminanceToBin(texelFetch(sourceTexture, pixel, 0).rgb)], 1u);
+    barrier();
+
+    uint count = bins[gl_LocalInvocationIndex];
+    if (count != 0u)
+        atomicAdd(histogram[gl_LocalInvocationIndex], count);
+}
@@ -0,0 +1,97 @@
+#version 330 core
+#include "debug_view.glsl"
+out vec4 FragColor;
+
+struct PointLight {
+    vec3 position;
+
+    vec3 specular;
+    vec3 diffuse;
+    vec3 ambient;
+
+    float constant;
+    float linear;
+    float quadratic;
+};
+
+in vec3 FragPlanePos;
+in vec2 FrameUV[4];
+flat in vec2 FrameCell[4];
+flat in vec4 FrameWeights;
+flat in vec3 DepthAxis;
+// the level of detail cross-fade of clock.fs
+flat in float LodFade;
+
+uniform sampler2D albedoAtlas;
+uniform sampler2D normalDepthAtlas;
+uniform int frames;
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform PointLight pointLight;
+uniform vec3 viewPosition;
+
+// the ambient and diffuse terms of clock.fs, the atlas has no specular map
+vec3 CalcPointLight(PointLight light, vec3 albedo, vec3 normal, vec3 fragPos)
+{
+    vec3 lightDir = normalize(light.position - fragPos);
+    float diff = max(dot(normal, lightDir), 0.0);
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
+    return (light.ambient + light.diffuse * diff) * albedo * attenuation;
+}
+
+float near = 0.001f;
+float far = 100.0f;
+
+float linearizeDepth(float depth) {
+    return (2.0 * near * far) / (far + near - (depth * 2.0 - 1.0) * (far - near));
+}
+
+float logisticDepth(float depth, float steepness, float offset) {
+    float zVal = linearizeDepth(depth);
+    return (1 / (1 + exp(-steepness * (zVal - offset))));
+}
+
+float bayer4(vec2 fragCoord) {
+    const float matrix[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0,
+                                       3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(fragCoord) & 3;
+    return (matrix[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
+void main() {
+    float threshold = bayer4(gl_FragCoord.xy);
+    if (LodFade >= 0.0 ? threshold >= LodFade : threshold < -LodFade)
+        discard;
+
+    // half a texel inside the cell, the neighbouring frame never bleeds in
+    vec2 margin = vec2(0.5 / float(textureSize(albedoAtlas, 0).x / frames));
+    vec4 albedo = vec4(0.0);
+    vec4 normalDepth = vec4(0.0);
+    for (int k = 0; k < 4; k++) {
+        vec2 uv = FrameUV[k];
+        float inside = step(0.0, min(uv.x, uv.y)) * step(max(uv.x, uv.y), 1.0);
+        vec2 atlasUV = (FrameCell[k] + clamp(uv, margin, 1.0 - margin)) / float(frames);
+        float weight = FrameWeights[k] * inside;
+        albedo += weight * texture(albedoAtlas, atlasUV);
+        normalDepth += weight * texture(normalDepthAtlas, atlasUV);
+    }
+    if (albedo.a < 0.5)
+        discard;
+    albedo.rgb /= albedo.a;
+    normalDepth /= albedo.a;
+
+    // the surface lies off the quad by the baked depth
+    vec3 fragPos = FragPlanePos + DepthAxis * (normalDepth.a - 0.5);
+    vec4 clipPos = projection * view * vec4(fragPos, 1.0);
+    float depth = clipPos.z / clipPos.w * 0.5 + 0.5;
+    gl_FragDepth = depth;
+
+    // model space normal, like the mesh shaders use
+    vec3 normal = normalize(normalDepth.xyz * 2.0 - 1.0);
+    vec3 result = CalcPointLight(pointLight, albedo.rgb, normal, fragPos);
+    float fog = logisticDepth(depth, 0.5, 5.0);
+    FragColor = vec4(result, 1.0) * (1.0f - fog) + vec4(fog * vec3(0.70, 0.70, 0.70), 1.0f);
+    FragColor = debugViewColor(FragColor);
+}
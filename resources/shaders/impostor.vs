@@ -0,0 +1,82 @@
+#version 330 core
+
+// One camera facing quad per rg::Impostor instance. The quad covers the bounding sphere, every
+// corner is the end of a camera ray that is intersected with the planes of the four atlas
+// frames around the view direction, so each frame is sampled where it would show that ray.
+layout (location = 0) in vec2 aCorner;  // -1 .. 1
+layout (location = 3) in mat4 aModel;   // 3 .. 6
+layout (location = 7) in float aFade;
+
+out vec3 FragPlanePos;
+out vec2 FrameUV[4];
+flat out vec2 FrameCell[4];
+flat out vec4 FrameWeights;
+// world space offset of a baked depth of 1 from the quad, the depth is 0.5 on the quad
+flat out vec3 DepthAxis;
+flat out float LodFade;
+
+uniform mat4 view;
+uniform mat4 projection;
+uniform vec3 cameraPosition;
+// model space bounding sphere the frames were baked around
+uniform vec4 sphere;
+uniform int frames;
+
+vec2 signNotZero(vec2 v)
+{
+    return vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// the octahedral mapping of rg::Impostor::FrameDirection, y up
+vec2 octahedralEncode(vec3 n)
+{
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 p = n.xz;
+    if (n.y < 0.0)
+        p = (1.0 - abs(p.yx)) * signNotZero(p);
+    return p;
+}
+
+vec3 octahedralDecode(vec2 p)
+{
+    vec3 n = vec3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y);
+    if (n.y < 0.0)
+        n.xz = (1.0 - abs(n.zx)) * signNotZero(n.xz);
+    return normalize(n);
+}
+
+void main()
+{
+    vec3 center = sphere.xyz;
+    float radius = sphere.w;
+    vec3 camera = vec3(inverse(aModel) * vec4(cameraPosition, 1.0));
+    vec3 toCamera = normalize(camera - center);
+    vec3 up = abs(toCamera.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+    vec3 right = normalize(cross(up, toCamera));
+    up = cross(toCamera, right);
+    vec3 corner = center + (aCorner.x * right + aCorner.y * up) * radius;
+
+    // bilinear weights of the four grid points around the view direction
+    vec2 grid = (octahedralEncode(toCamera) * 0.5 + 0.5) * float(frames - 1);
+    vec2 base = min(floor(grid), vec2(float(frames - 2)));
+    vec2 f = grid - base;
+    FrameWeights = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+
+    vec3 ray = corner - camera;
+    for (int k = 0; k < 4; k++) {
+        vec2 cell = base + vec2(k & 1, k >> 1);
+        vec3 direction = octahedralDecode(cell / float(frames - 1) * 2.0 - 1.0);
+        // the basis of the bake camera, glm::lookAt toward the center
+        vec3 frameUp = abs(direction.y) > 0.999 ? vec3(0.0, 0.0, 1.0) : vec3(0.0, 1.0, 0.0);
+        vec3 frameRight = normalize(cross(-direction, frameUp));
+        frameUp = cross(frameRight, -direction);
+        vec3 hit = camera + ray * dot(center - camera, direction) / dot(ray, direction);
+        FrameUV[k] = vec2(dot(hit - center, frameRight), dot(hit - center, frameUp)) / (2.0 * radius) + 0.5;
+        FrameCell[k] = cell;
+    }
+
+    FragPlanePos = vec3(aModel * vec4(corner, 1.0));
+    DepthAxis = mat3(aModel) * toCamera * 2.0 * radius;
+    LodFade = aFade;
+    gl_Position = projection * view * vec4(FragPlanePos, 1.0);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+out vec2 TexCoords;
+out vec3 Normal;
+out float Depth;
+
+uniform mat4 view;
+uniform mat4 projection;
+// bounding sphere radius, the camera is two radii from its center
+uniform float radius;
+
+void main()
+{
+    vec4 viewPos = view * vec4(aPos, 1.0);
+    // 0.5 on the plane through the sphere center, 1 a radius toward the camera
+    Depth = 0.5 + 0.5 * (viewPos.z + 2.0 * radius) / radius;
+    Normal = aNormal;
+    TexCoords = aTexCoords;
+    gl_Position = projection * viewPos;
+}
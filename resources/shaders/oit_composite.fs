@@ -0,0 +1,24 @@
+#version 330 core
+
+// Resolves the weighted blended OIT targets over the opaque scene. Drawn with
+// glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA): the average translucent color covers the
+// scene by one minus the product of the transmittances.
+
+out vec4 FragColor;
+
+// rgb = sum of color * alpha * weight, a = product of (1 - alpha)
+uniform sampler2D accumulationTexture;
+// r = sum of alpha * weight
+uniform sampler2D weightTexture;
+
+void main() {
+    ivec2 texel = ivec2(gl_FragCoord.xy);
+    vec4 accumulation = texelFetch(accumulationTexture, texel, 0);
+    float revealage = accumulation.a;
+    if (revealage >= 0.999)
+        discard;
+
+    float weight = texelFetch(weightTexture, texel, 0).r;
+    vec3 average = accumulation.rgb / max(weight, 1e-5);
+    FragColor = vec4(average, 1.0 - revealage);
+}
@@ -0,0 +1,113 @@
+#version 430 core
+
+// Post-processing chain as one compute dispatch. Each 16x16 group loads its tile plus an apron
+// into shared memory once, the kernel is applied as a sum of separable terms (horizontal pass
+// into shared memory, then vertical), then fog, bloom, tonemap and gamma run in registers.
+// Every effect can also be dispatched alone, which is how the per-effect timings are taken.
+
+#define TILE 16
+#define MAX_RADIUS 4
+#define MAX_TERMS 2
+#define TAPS (2 * MAX_RADIUS + 1)
+#define APRON_TILE (TILE + 2 * MAX_RADIUS)
+
+#define EFFECT_KERNEL 1
+#define EFFECT_FOG 2
+#define EFFECT_BLOOM 4
+#define EFFECT_TONEMAP 8
+#define EFFECT_GAMMA 16
+
+layout (local_size_x = TILE, local_size_y = TILE) in;
+
+layout (binding = 0) uniform sampler2D sourceTexture;
+layout (binding = 1) uniform sampler2D depthTexture;
+// top level of the bloom chain, covers the rendered region in [0, 1]
+layout (binding = 2) uniform sampler2D bloomTexture;
+layout (rgba16f, binding = 0) uniform writeonly image2D targetImage;
+
+// written by exposure.cs
+layout (std430, binding = 0) readonly buffer Exposure {
+    uint histogram[256];
+    float averageLuminance;
+    float adaptedExposure;
+};
+
+uniform ivec2 renderSize;
+uniform int effects;
+
+// kernel = sum over terms of vertical[t] * horizontal[t]^T
+uniform int kernelTerms;
+uniform float horizontalWeights[MAX_TERMS * TAPS];
+uniform float verticalWeights[MAX_TERMS * TAPS];
+
+uniform float exposure;
+uniform bool autoExposure;
+uniform float gamma;
+
+uniform vec3 fogColor;
+uniform float fogDensity;
+uniform float near;
+uniform float far;
+
+uniform float bloomStrength;
+
+shared vec3 tile[APRON_TILE][APRON_TILE];
+shared vec3 rows[MAX_TERMS][APRON_TILE][TILE];
+
+float linearizeDepth(float depth) {
+    return (2.0 * near * far) / (far + near - (depth * 2.0 - 1.0) * (far - near));
+}
+
+void main() {
+    ivec2 local = ivec2(gl_LocalInvocationID.xy);
+    ivec2 tileOrigin = ivec2(gl_WorkGroupID.xy) * TILE;
+    ivec2 pixel = tileOrigin + local;
+
+    // cooperative load of the tile and its apron, clamped to the rendered region
+    int threadIndex = local.y * TILE + local.x;
+    for (int i = threadIndex; i < APRON_TILE * APRON_TILE; i += TILE * TILE) {
+        ivec2 offset = ivec2(i % APRON_TILE, i / APRON_TILE);
+        ivec2 texel = clamp(tileOrigin + offset - MAX_RADIUS, ivec2(0), renderSize - 1);
+        tile[offset.y][offset.x] = texelFetch(sourceTexture, texel, 0).rgb;
+    }
+    barrier();
+
+    vec3 color = tile[local.y + MAX_RADIUS][local.x + MAX_RADIUS];
+
+    if ((effects & EFFECT_KERNEL) != 0) {
+        // horizontal pass over every row of the apron tile
+        for (int t = 0; t < kernelTerms; t++) {
+            for (int row = local.y; row < APRON_TILE; row += TILE) {
+                vec3 sum = vec3(0.0);
+                for (int k = 0; k < TAPS; k++)
+                    sum += tile[row][local.x + k] * horizontalWeights[t * TAPS + k];
+                rows[t][row][local.x] = sum;
+            }
+        }
+        barrier();
+
+        color = vec3(0.0);
+        for (int t = 0; t < kernelTerms; t++)
+            for (int k = 0; k < TAPS; k++)
+                color += rows[t][local.y + k][local.x] * verticalWeights[t * TAPS + k];
+    }
+
+    if (any(greaterThanEqual(pixel, renderSize)))
+        return;
+
+    if ((effects & EFFECT_FOG) != 0) {
+        float distance = linearizeDepth(texelFetch(depthTexture, pixel, 0).r);
+        float fog = 1.0 - exp(-fogDensity * distance);
+        color = mix(color, fogColor, fog);
+    }
+    if ((effects & EFFECT_BLOOM) != 0) {
+        vec2 uv = (vec2(pixel) + 0.5) / vec2(renderSize);
+        color = mix(color, textureLod(bloomTexture, uv, 0.0).rgb, bloomStrength);
+    }
+    if ((effects & EFFECT_TONEMAP) != 0)
+        color = vec3(1.0) - exp(-color * (autoExposure ? adaptedExposure : exposure));
+    if ((effects & EFFECT_GAMMA) != 0)
+        color = pow(max(color, vec3(0.0)), vec3(1.0 / gamma));
+
+    imageStore(targetImage, pixel, vec4(color, 1.0));
+}
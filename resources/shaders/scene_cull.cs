@@ -0,0 +1,125 @@
+#version 430 core
+
+// Culling of the rg::GpuScene objects, one meshlet each, against the frustum and, where the
+// model is drawn with face culling, against the meshlet's normal cone. Every visible object
+// appends one DrawElementsIndirectCommand to the range of its draw group, the append counters
+// are the draw counts of the groups. Commands past the count were cleared to zero by the CPU,
+// so the groups can be drawn with or without glMultiDrawElementsIndirectCount.
+
+layout (local_size_x = 64) in;
+
+struct Object {
+    vec4 sphere; // local bounding sphere, xyz center and w radius
+    vec4 cone;   // local cone axis and cutoff, a cutoff of 1 is never culled
+    uint meshlet;
+    uint transform;
+    uint group;
+    uint lod;    // level of detail the meshlet belongs to
+};
+
+struct Meshlet {
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint padding;
+};
+
+struct DrawElementsIndirectCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+
+layout (std430, binding = 0) readonly buffer Objects {
+    Object objects[];
+};
+
+layout (std430, binding = 1) readonly buffer Transforms {
+    mat4 transforms[];
+};
+
+layout (std430, binding = 2) readonly buffer Meshlets {
+    Meshlet meshlets[];
+};
+
+// first command of every group
+layout (std430, binding = 3) readonly buffer GroupOffsets {
+    uint groupOffsets[];
+};
+
+layout (std430, binding = 4) writeonly buffer Commands {
+    DrawElementsIndirectCommand commands[];
+};
+
+layout (std430, binding = 5) buffer DrawCounts {
+    uint drawCounts[];
+};
+
+// rg::GpuScene::CullStats
+layout (std430, binding = 6) buffer Stats {
+    uint visibleMeshlets;
+    uint visibleTriangles;
+    uint frustumRejectedTriangles;
+    uint coneRejectedTriangles;
+};
+
+// levels of detail of every transform, the previous one is drawn while fading out
+struct InstanceLod {
+    uint current;
+    uint previous;
+    float fade;
+    uint padding;
+};
+
+layout (std430, binding = 7) readonly buffer InstanceLods {
+    InstanceLod instanceLods[];
+};
+
+uniform uint objectCount;
+uniform vec4 frustumPlanes[6];
+uniform vec3 cameraPosition;
+uniform bool frustumCulling;
+uniform bool coneCulling;
+
+void main() {
+    uint index = gl_GlobalInvocationID.x;
+    if (index >= objectCount)
+        return;
+
+    Object object = objects[index];
+    InstanceLod lod = instanceLods[object.transform];
+    if (object.lod != lod.current && object.lod != lod.previous)
+        return;
+    Meshlet meshlet = meshlets[object.meshlet];
+    uint triangles = meshlet.indexCount / 3u;
+    mat4 model = transforms[object.transform];
+    vec3 center = vec3(model * vec4(object.sphere.xyz, 1.0));
+    float scale = max(length(model[0].xyz), max(length(model[1].xyz), length(model[2].xyz)));
+    float radius = object.sphere.w * scale;
+
+    if (frustumCulling) {
+        for (int i = 0; i < 6; i++) {
+            if (dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius) {
+                atomicAdd(frustumRejectedTriangles, triangles);
+                return;
+            }
+        }
+    }
+
+    // every triangle faces away when the camera lies inside the cone behind the meshlet
+    if (coneCulling && object.cone.w < 1.0) {
+        vec3 axis = normalize(mat3(model) * object.cone.xyz);
+        vec3 toCenter = center - cameraPosition;
+        if (dot(toCenter, axis) >= object.cone.w * length(toCenter) + radius) {
+            atomicAdd(coneRejectedTriangles, triangles);
+            return;
+        }
+    }
+
+    atomicAdd(visibleMeshlets, 1u);
+    atomicAdd(visibleTriangles, triangles);
+    uint slot = groupOffsets[object.group] + atomicAdd(drawCounts[object.group], 1u);
+    commands[slot] = DrawElementsIndirectCommand(meshlet.indexCount, 1u, meshlet.firstIndex, meshlet.baseVertex, index);
+}
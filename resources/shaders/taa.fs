@@ -0,0 +1,117 @@
+#version 330 core
+
+// Temporal anti-aliasing resolve, also a temporal upscaler: the current frame covers the
+// rendered region (renderScale) of its texture at a lower resolution than the history, which
+// is always at output resolution. Every output pixel takes the current sample closest to it,
+// weighted by how close it is, and blends it into the reprojected history. The history is
+// clipped to the YCoCg neighbourhood of the current sample so disoccluded and moving pixels
+// do not ghost.
+
+out vec4 FragColor;
+in vec2 texCoords;
+
+uniform sampler2D currentTexture;
+uniform sampler2D depthTexture;
+uniform sampler2D historyTexture;
+uniform vec2 renderScale;
+// sub-pixel offset of the current frame in rendered pixels
+uniform vec2 jitter;
+// unjittered matrices of this and the previous frame
+uniform mat4 inverseViewProjection;
+uniform mat4 previousViewProjection;
+// weight of a current sample that lies exactly on the output pixel
+uniform float blendFactor;
+uniform bool historyValid;
+
+// the blend runs on compressed colors so single bright samples cannot dominate the average
+vec3 compress(vec3 color) {
+    return color / (1.0 + max(color.r, max(color.g, color.b)));
+}
+
+vec3 decompress(vec3 color) {
+    return color / max(1.0 - max(color.r, max(color.g, color.b)), 0.0001);
+}
+
+vec3 RGBToYCoCg(vec3 color) {
+    return vec3(
+         0.25 * color.r + 0.5 * color.g + 0.25 * color.b,
+         0.5  * color.r                 - 0.5  * color.b,
+        -0.25 * color.r + 0.5 * color.g - 0.25 * color.b);
+}
+
+vec3 YCoCgToRGB(vec3 color) {
+    return vec3(
+        color.x + color.y - color.z,
+        color.x           + color.z,
+        color.x - color.y - color.z);
+}
+
+// moves the history towards the center of the box until it is inside
+vec3 clipToBox(vec3 boxMin, vec3 boxMax, vec3 history) {
+    vec3 center = 0.5 * (boxMax + boxMin);
+    vec3 extents = 0.5 * (boxMax - boxMin) + 0.0001;
+    vec3 offset = history - center;
+    vec3 units = abs(offset / extents);
+    float maxUnit = max(units.x, max(units.y, units.z));
+    return maxUnit > 1.0 ? center + offset / maxUnit : history;
+}
+
+void main() {
+    vec2 texSize = vec2(textureSize(currentTexture, 0));
+    ivec2 renderSize = ivec2(texSize * renderScale + 0.5);
+
+    // output pixel center in rendered pixels and the rendered texel whose sample lies closest to it
+    vec2 position = texCoords * vec2(renderSize);
+    ivec2 texel = clamp(ivec2(floor(position + jitter)), ivec2(0), renderSize - 1);
+
+    vec3 moment1 = vec3(0.0);
+    vec3 moment2 = vec3(0.0);
+    vec3 neighbourMin = vec3(1e9);
+    vec3 neighbourMax = vec3(-1e9);
+    vec3 current = vec3(0.0);
+    float closestDepth = 1.0;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            ivec2 neighbour = clamp(texel + ivec2(x, y), ivec2(0), renderSize - 1);
+            vec3 color = RGBToYCoCg(compress(texelFetch(currentTexture, neighbour, 0).rgb));
+            moment1 += color;
+            moment2 += color * color;
+            neighbourMin = min(neighbourMin, color);
+            neighbourMax = max(neighbourMax, color);
+            if (x == 0 && y == 0)
+                current = color;
+            // the nearest surface around the pixel decides its motion, so edges move with the object in front
+            closestDepth = min(closestDepth, texelFetch(depthTexture, neighbour, 0).r);
+        }
+    }
+
+    vec4 clip = vec4(texCoords * 2.0 - 1.0, closestDepth * 2.0 - 1.0, 1.0);
+    vec4 world = inverseViewProjection * clip;
+    vec4 previousClip = previousViewProjection * vec4(world.xyz / world.w, 1.0);
+    vec2 previousUV = previousClip.xy / previousClip.w * 0.5 + 0.5;
+
+    if (!historyValid || any(lessThan(previousUV, vec2(0.0))) || any(greaterThan(previousUV, vec2(1.0)))) {
+        // nothing to accumulate with, a bilinear upscale of the current frame without the jitter
+        vec2 uv = clamp((position + jitter) / texSize, vec2(0.5) / texSize, renderScale - vec2(0.5) / texSize);
+        FragColor = vec4(texture(currentTexture, uv).rgb, 1.0);
+        return;
+    }
+
+    // variance clipping box, tightened by the plain min/max box
+    vec3 mean = moment1 / 9.0;
+    vec3 sigma = sqrt(max(moment2 / 9.0 - mean * mean, vec3(0.0)));
+    vec3 boxMin = max(neighbourMin, mean - 1.25 * sigma);
+    vec3 boxMax = min(neighbourMax, mean + 1.25 * sigma);
+
+    vec3 history = RGBToYCoCg(compress(texture(historyTexture, previousUV).rgb));
+    history = clipToBox(boxMin, boxMax, history);
+
+    // distance between the output pixel and the sample in output pixels, samples further away
+    // than about a pixel barely count, that is what spreads the samples over several frames
+    vec2 distance = (position - (vec2(texel) + 0.5 - jitter)) / renderScale;
+    float confidence = exp(-2.29 * dot(distance, distance));
+    float alpha = blendFactor * confidence;
+
+    vec3 result = YCoCgToRGB(mix(history, current, alpha));
+    FragColor = vec4(decompress(max(result, vec3(0.0))), 1.0);
+}
@@ -13,8 +13,38 @@
 #include <learnopengl/shader.h>
 #include <learnopengl/camera.h>
 #include <learnopengl/model.h>
-
+#include <rg/GpuTimer.h>
+#include <rg/DynamicResolution.h>
+#include <rg/FrameGraph.h>
+#include <rg/GLExt.h>
+#include <rg/PostProcessing.h>
+#include <rg/Bloom.h>
+#include <rg/AutoExposure.h>
+#include <rg/TemporalAA.h>
+#include <rg/WeightedBlendedOIT.h>
+#include <rg/GrassField.h>
+#include <rg/GpuScene.h>
+#include <rg/LodSelector.h>
+#include <rg/Impostor.h>
+#include <rg/SceneGraph.h>
+#include <rg/Headless.h>
+#include <rg/DrawCounter.h>
+#include <rg/MemoryTracker.h>
+#include <rg/DebugOutput.h>
+#include <rg/Benchmark.h>
+#include <rg/CameraTrack.h>
+#include <rg/GpuProfiler.h>
+#include <rg/PipelineStatistics.h>
+#include <rg/DebugView.h>
+#include <rg/FrameStats.h>
+#include <rg/CpuProfiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
 #include <iostream>
+#include <map>
+#include <memory>
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);
 
@@ -29,6 +59,11 @@ void key_callback(GLFWwindow *window, int key, int scancode, int action, int mod
 const unsigned int SCR_WIDTH = 1920;
 const unsigned int SCR_HEIGHT = 1080;
 
+const int CLOCK_COUNT = 101;
+
+unsigned int windowWidth = SCR_WIDTH;
+unsigned int windowHeight = SCR_HEIGHT;
+
 float lastX = SCR_WIDTH / 2.0f;
 float lastY = SCR_HEIGHT / 2.0f;
 bool firstMouse = true;
@@ -71,7 +106,13 @@ struct ProgramState {
     bool CameraMouseMovementUpdateEnabled = true;
     glm::vec3 backpackPosition = glm::vec3(0.0f);
     float backpackScale = 1.0f;
+    // satovi se pomeraju u clock.vs, bez racunanja i slanja matrica sa CPU
+    bool ProceduralClocks = false;
+    int ProceduralClockCount = CLOCK_COUNT;
+    // proceduralni satovi iz Clock_fbx.fbx, sa animiranim kazaljkama
+    bool AnimatedClocks = false;
     PointLight pointLight;
+    rg::DynamicResolution dynamicResolution;
     ProgramState()
             : camera(glm::vec3(0.0f, 0.0f, 3.0f)) {}
 
@@ -112,7 +153,12 @@ void ProgramState::LoadFromFile(std::string filename) {
 
 ProgramState *programState;
 
-void DrawImGui(ProgramState *programState);
+void DrawImGui(ProgramState *programState, const rg::FrameGraph& frameGraph, rg::PostProcessing& postProcessing, rg::Bloom& bloom,
+               rg::AutoExposure& autoExposure, rg::TemporalAA& temporalAA, rg::WeightedBlendedOIT& weightedBlendedOIT,
+               rg::GrassField& grassField, rg::GpuScene& gpuScene, rg::LodSelector& clockLods,
+               rg::Impostor& clockImpostor, rg::NodeAnimator& clockAnimator,
+               const rg::SceneGraph& sceneGraph, rg::SceneGraphBenchmark& sceneGraphBenchmark, rg::CameraTrack& cameraTrack,
+               rg::GpuProfiler& gpuProfiler, rg::PipelineStatistics& pipelineStatistics, rg::FrameStats& frameStats);
 
 
 //////////////////////////////////////////////////
@@ -120,56 +166,154 @@ void DrawImGui(ProgramState *programState);
 //                     Main                     //
 //                                              //
 //////////////////////////////////////////////////
-int main() {
+int main(int argc, char **argv) {
+    // --benchmark [--frames N] [--output putanja] [--track snimak]: N frejmova po zadatoj putanji kamere
+    // (ili po snimljenoj putanji iz snimak) bez prozora, izvestaj u putanja.json i putanja.csv
+    bool isBenchmark = false;
+    int benchmarkFrames = 600;
+    std::string benchmarkOutput = "benchmark";
+    std::string benchmarkTrack;
+#ifdef RG_CPU_PROFILER
+    // --trace putanja: CPU zone pokretanja i prvih TRACE_FRAMES frejmova (ili celog benchmarka) kao Chrome trace
+    std::string tracePath;
+    const int TRACE_FRAMES = 300;
+#endif
+    // asinhroni izvestaji drajvera su ukljuceni gde god ih drajver ima, --no-gl-debug ih iskljucuje;
+    // --gl-debug: uz to i debug kontekst, --gl-debug-sync: sinhroni izvestaji (mesto GLCALL poziva uz RG_GL_CALL_SITES)
+    bool isGLDebug = false;
+    bool isGLDebugSync = false;
+    bool isGLDebugOutput = true;
+    // --budget brojac=vrednost, npr. --budget draw_calls=2000: frejm preko budzeta se prijavljuje,
+    // a benchmark sa takvim frejmom zavrsava sa kodom 1
+    // --baseline putanja: izvestaj ranijeg benchmarka; brojac koji naraste preko tolerancije je
+    // takodje kod 1, kao i kad osnove nema; --write-baseline: ovo pokretanje postaje osnova
+    std::string benchmarkBaseline = "resources/benchmark_baseline.json";
+    bool isWriteBaseline = false;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--benchmark")
+            isBenchmark = true;
+        else if (argument == "--frames" && i + 1 < argc)
+            benchmarkFrames = std::max(1, atoi(argv[++i]));
+        else if (argument == "--output" && i + 1 < argc)
+            benchmarkOutput = argv[++i];
+        else if (argument == "--track" && i + 1 < argc)
+            benchmarkTrack = argv[++i];
+#ifdef RG_CPU_PROFILER
+        else if (argument == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+#endif
+        else if (argument == "--gl-debug")
+            isGLDebug = true;
+        else if (argument == "--gl-debug-sync")
+            isGLDebug = isGLDebugSync = true;
+        else if (argument == "--no-gl-debug")
+            isGLDebugOutput = false;
+        else if (argument == "--baseline" && i + 1 < argc)
+            benchmarkBaseline = argv[++i];
+        else if (argument == "--write-baseline")
+            isWriteBaseline = true;
+        else if (argument == "--budget" && i + 1 < argc) {
+            std::string budget = argv[++i];
+            size_t separator = budget.find('=');
+            int counter = 0;
+            while (counter < rg::DrawCounter::COUNTER_COUNT && budget.substr(0, separator) != rg::DrawCounter::Name(counter))
+                counter++;
+            if (separator == std::string::npos || counter == rg::DrawCounter::COUNTER_COUNT)
+                std::cout << "ERROR::ARGUMENTS:: Unknown budget " << budget << std::endl;
+            else
+                rg::DrawCounter::Budget.Values[counter] = (unsigned int) std::max(0, atoi(budget.c_str() + separator + 1));
+        }
+    }
+
     float gamma = 2.2f;
-    glfwInit();
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    GLFWwindow *window = NULL;
+    std::unique_ptr<rg::HeadlessContext> headless;
+    if (isBenchmark) {
+        headless.reset(new rg::HeadlessContext(SCR_WIDTH, SCR_HEIGHT, isGLDebug));
+        if (!headless->IsAvailable())
+            headless.reset();
+    }
+
+    if (!headless) {
+        glfwInit();
+        // 4.3 enables the compute paths, everything else still runs on 3.3
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        // bez EGL benchmark crta u skriven prozor
+        if (isBenchmark)
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        if (isGLDebug)
+            glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
 
 #ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
 #endif
 
-    GLFWwindow *window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
-    if (window == NULL) {
-        std::cout << "Failed to create GLFW window" << std::endl;
-        glfwTerminate();
-        return -1;
-    }
-
-    glfwMakeContextCurrent(window);
-    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
-    glfwSetCursorPosCallback(window, mouse_callback);
-    glfwSetScrollCallback(window, scroll_callback);
-    glfwSetKeyCallback(window, key_callback);
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        if (window == NULL) {
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+        }
+        if (window == NULL) {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
 
-    if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
-        std::cout << "Failed to initialize GLAD" << std::endl;
-        return -1;
+        glfwMakeContextCurrent(window);
+        {
+            int width, height;
+            glfwGetFramebufferSize(window, &width, &height);
+            windowWidth = width;
+            windowHeight = height;
+        }
+        glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+        glfwSetCursorPosCallback(window, mouse_callback);
+        glfwSetScrollCallback(window, scroll_callback);
+        glfwSetKeyCallback(window, key_callback);
+        glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+
+        if (!gladLoadGLLoader((GLADloadproc) glfwGetProcAddress)) {
+            std::cout << "Failed to initialize GLAD" << std::endl;
+            return -1;
+        }
     }
+    rg::loadGLExtensions(headless ? rg::HeadlessContext::Loader() : (GLADloadproc) glfwGetProcAddress);
+    rg::DrawCounter::Install();
+    rg::MemoryTracker::Install();
+    if (isGLDebug || (isGLDebugOutput && rg::DebugOutput::IsAvailable()))
+        rg::DebugOutput::Enable(isGLDebugSync);
+    if (!rg::DebugOutput::IsEnabled())
+        rg::DebugOutput::WarnUnchecked();
 
     programState = new ProgramState;
-    programState->LoadFromFile("resources/program_state.txt");
+    // benchmark uvek krece iz istog stanja
+    if (!isBenchmark)
+        programState->LoadFromFile("resources/program_state.txt");
     if (programState->ImGuiEnabled) {
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
     }
 
-    IMGUI_CHECKVERSION();
-    ImGui::CreateContext();
-    ImGuiIO &io = ImGui::GetIO();
-    (void) io;
+    if (!isBenchmark) {
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGuiIO &io = ImGui::GetIO();
+        (void) io;
 
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 330 core");
+        ImGui_ImplGlfw_InitForOpenGL(window, true);
+        ImGui_ImplOpenGL3_Init("#version 330 core");
+    }
 
     //////////////////////////////////////////////////
     //                                              //
     //            Inicijalizacija stanja            //
     //                                              //
     //////////////////////////////////////////////////
-    glfwSwapInterval(0);
+    if (window)
+        glfwSwapInterval(0);
     glEnable(GL_DEPTH_TEST);
     glEnable(GL_STENCIL_TEST);
     glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
@@ -187,20 +331,79 @@ int main() {
     Shader villaShader("resources/shaders/villa.vs", "resources/shaders/villa.fs");
     Shader clockShader("resources/shaders/clock.vs", "resources/shaders/clock.fs");
     Shader floorShader("resources/shaders/default.vs", "resources/shaders/default.fs");
+    // sve sto podsistemi zauzmu u konstruktoru vodi se pod njihovim imenom
+    rg::MemoryTracker::Tag = "post processing";
+    rg::PostProcessing postProcessing;
+    rg::MemoryTracker::Tag = "bloom";
+    rg::Bloom bloom;
+    rg::MemoryTracker::Tag = "auto exposure";
+    rg::AutoExposure autoExposure;
+    rg::MemoryTracker::Tag = "temporal aa";
+    rg::TemporalAA temporalAA;
+    rg::MemoryTracker::Tag = "weighted blended oit";
+    rg::WeightedBlendedOIT weightedBlendedOIT;
+    rg::MemoryTracker::Tag = "grass field";
+    rg::GrassField grassField;
+    rg::MemoryTracker::Tag = "gpu scene";
+    rg::GpuScene gpuScene;
+    rg::MemoryTracker::Tag = "untagged";
 
     Model villaModel("resources/objects/futuristic_app/Futuristic\ Apartment.obj");
     Model carModel("resources/objects/car/car.obj");
-    Model clockModel("resources/objects/clockwork/clock.obj");
+    // satovi se crtaju u stotinama primeraka, samo njima se prave uproscene verzije
+    Model clockModel("resources/objects/clockwork/clock.obj", false, 3);
+    Model animatedClockModel("resources/objects/clockwork/Clock_fbx.fbx");
     Model floorModel("resources/objects/floor/scene.gltf");
     Model grassModel("resources/objects/grass/scene.gltf");
 
 	framebufferShader.use();
     framebufferShader.setInt("screenTexture", 0);
+    framebufferShader.setInt("bloomTexture", 1);
     glUniform1f(glGetUniformLocation(framebufferShader.ID, "gamma"), gamma);
     
     villaModel.SetShaderTextureNamePrefix("material.");
     carModel.SetShaderTextureNamePrefix("material.");
     clockModel.SetShaderTextureNamePrefix("material.");
+    animatedClockModel.SetShaderTextureNamePrefix("material.");
+    rg::MemoryTracker::Tag = "clock animator";
+    rg::NodeAnimator clockAnimator(animatedClockModel.nodes, animatedClockModel.animations);
+    // samplerBuffer ne sme deliti jedinicu sa sampler2D teksturama modela
+    clockShader.use();
+    clockShader.setInt("nodeMatrices", 8);
+    rg::LodSelector clockLods(clockModel);
+    // daleki satovi su samo cetvorougao sa slikom sata iz najblizih pravaca
+    rg::MemoryTracker::Tag = "clock impostor";
+    rg::Impostor clockImpostor(clockModel);
+    rg::MemoryTracker::Tag = "untagged";
+    clockLods.ImpostorPixels = 64.0f;
+
+    // koren scene je na poziciji vile, pod, vila i satovi su njegova deca
+    rg::SceneGraph sceneGraph;
+    int sceneRoot = sceneGraph.Create();
+    int floorNode = sceneGraph.Create(sceneRoot);
+    int villaNode = sceneGraph.Create(sceneRoot);
+    std::vector<int> clockNodes;
+    for (int i = 1; i <= CLOCK_COUNT; i++)
+        clockNodes.push_back(sceneGraph.Create(sceneRoot));
+    rg::SceneGraphBenchmark sceneGraphBenchmark;
+
+    // satovi, pod i vila na GPU putanji, gpu_scene.vs uz postojece fragment sejdere
+    std::unique_ptr<Shader> gpuClockShader, gpuFloorShader, gpuVillaShader;
+    int firstClockInstance = -1, floorInstance = -1, villaInstance = -1;
+    if (gpuScene.IsAvailable()) {
+        rg::MemoryTracker::Scope memoryScope("gpu scene");
+        gpuClockShader.reset(new Shader("resources/shaders/gpu_scene.vs", "resources/shaders/clock.fs"));
+        gpuFloorShader.reset(new Shader("resources/shaders/gpu_scene.vs", "resources/shaders/default.fs"));
+        gpuVillaShader.reset(new Shader("resources/shaders/gpu_scene.vs", "resources/shaders/villa.fs"));
+        int clock = gpuScene.AddModel(clockModel, *gpuClockShader, GL_FRONT);
+        int floor = gpuScene.AddModel(floorModel, *gpuFloorShader);
+        int villa = gpuScene.AddModel(villaModel, *gpuVillaShader);
+        firstClockInstance = gpuScene.AddInstance(clock);
+        for (int i = 1; i < CLOCK_COUNT; i++)
+            gpuScene.AddInstance(clock);
+        floorInstance = gpuScene.AddInstance(floor);
+        villaInstance = gpuScene.AddInstance(villa);
+    }
 
     PointLight& pointLight = programState->pointLight;
     pointLight.position = glm::vec3(4.0f, 59.0, 0.0);
@@ -212,6 +415,7 @@ int main() {
     pointLight.quadratic = 0.00038f;
 
     // FRAMEBUFFER
+    rg::MemoryTracker::Tag = "framebuffer";
     unsigned int rectVAO, rectVBO;
 	glGenVertexArrays(1, &rectVAO);
 	glGenBuffers(1, &rectVBO);
@@ -224,265 +428,605 @@ int main() {
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
 
 
-	unsigned int FBO;
-	glGenFramebuffers(1, &FBO);
-	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
-
-	unsigned int framebufferTexture;
-	glGenTextures(1, &framebufferTexture);
-	glBindTexture(GL_TEXTURE_2D, framebufferTexture);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGB, GL_UNSIGNED_BYTE, NULL);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, framebufferTexture, 0);
-
-	unsigned int RBO;
-	glGenRenderbuffers(1, &RBO);
-	glBindRenderbuffer(GL_RENDERBUFFER, RBO);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, SCR_WIDTH, SCR_HEIGHT);
-	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, RBO);
-
-	auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
-	if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
-		std::cout << "Framebuffer error: " << fboStatus << std::endl;
-
+    rg::MemoryTracker::Tag = "untagged";
+    rg::FrameGraph frameGraph;
+    // svaki prolaz grafa je zona profajlera, "outline" je ugnjezdena u "car"
+    rg::GpuProfiler gpuProfiler;
+    frameGraph.SetProfiler(&gpuProfiler);
+    // broj pokretanja sejdera po prolazu, uz vremena u prozoru profajlera
+    rg::PipelineStatistics pipelineStatistics;
+    frameGraph.SetPipelineStatistics(&pipelineStatistics);
+    rg::GpuTimer frameTimer;
+    // percentili vremena frejma i zastoji, deltaTime je samo za kretanje kamere
+    rg::FrameStats frameStats;
+    rg::DynamicResolution& dynamicResolution = programState->dynamicResolution;
 
     //////////////////////////////////////////////////
     //                                              //
     //             Petlja renderovanja              //
     //                                              //
     //////////////////////////////////////////////////
-    while (!glfwWindowShouldClose(window)) {
+    // benchmark ide fiksnim korakom vremena, bez dinamicke rezolucije, da bi svako pokretanje crtalo iste slike
+    std::unique_ptr<rg::Benchmark> benchmark;
+    rg::CameraTrack cameraTrack;
+    if (isBenchmark) {
+        benchmark.reset(new rg::Benchmark(benchmarkFrames, benchmarkOutput));
+        if (!benchmarkTrack.empty() && cameraTrack.Load(benchmarkTrack))
+            benchmark->SetTrack(&cameraTrack);
+        dynamicResolution.Enabled = false;
+        dynamicResolution.LogInterval = 0.0f;
+    }
+#ifdef RG_CPU_PROFILER
+    rg::CpuProfiler::EndStartup();
+    int frameIndex = 0;
+#endif
+    std::chrono::steady_clock::time_point frameEnd = std::chrono::steady_clock::now();
+    while (benchmark ? !benchmark->Done() : !glfwWindowShouldClose(window)) {
+        RG_ZONE("frame");
+        std::chrono::steady_clock::time_point frameStart = std::chrono::steady_clock::now();
+#ifdef RG_CPU_PROFILER
+        if (!benchmark && !tracePath.empty() && frameIndex++ == TRACE_FRAMES)
+            rg::CpuProfiler::WriteChromeTrace(tracePath);
+#endif
 
-        float currFrame = glfwGetTime();
+        float currFrame = benchmark ? benchmark->Time() : glfwGetTime();
         deltaTime = currFrame - lastFrame;
         lastFrame = currFrame;
-        processInput(window);
+        bool isTrackPlaying = !benchmark && cameraTrack.IsPlaying();
+        if (benchmark) {
+            benchmark->BeginFrame();
+            benchmark->ApplyCamera(programState->camera);
+        } else if (isTrackPlaying) {
+            // reprodukcija ide fiksnim korakom, svetlo i satovi su isti kao pri svakom pustanju
+            currFrame = cameraTrack.PlaybackTime();
+            deltaTime = cameraTrack.TimeStep;
+            cameraTrack.Apply(programState->camera);
+            cameraTrack.Advance();
+            if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS)
+                cameraTrack.StopPlayback();
+            // posle reprodukcije vreme ide dalje od sada, ne od poslednjeg frejma putanje
+            if (!cameraTrack.IsPlaying())
+                lastFrame = glfwGetTime();
+        } else {
+            processInput(window);
+            cameraTrack.Record(currFrame, programState->camera);
+        }
+        rg::DrawCounter::Reset();
+
+        // ni rezolucija ne sme zavisiti od izmerenog vremena dok se putanja reprodukuje
+        bool isDynamicResolutionEnabled = dynamicResolution.Enabled;
+        dynamicResolution.Enabled = isDynamicResolutionEnabled && !isTrackPlaying;
+        dynamicResolution.Update(frameTimer.LastMs(), deltaTime);
+        dynamicResolution.Enabled = isDynamicResolutionEnabled;
+        grassField.UpdateBenchmark(deltaTime);
+        dynamicResolution.Log(SCR_WIDTH, SCR_HEIGHT);
+        frameTimer.Begin();
+        gpuProfiler.BeginFrame();
+        pipelineStatistics.BeginFrame(gpuProfiler.FrameNumber());
+
+        // pozicija svetla
+        pointLight.position = glm::vec3(150.0 * cos(currFrame), 120 + 100.0f * abs(cos(currFrame)), 150* sin(currFrame/10));
+
+        // transformacije modela, iste za oba nacina crtanja; clock.vs racuna isto kretanje satova.
+        // Menjaju se samo cvorovi cija se lokalna transformacija promenila, ostali ne kostaju nista.
+        sceneGraph.SetTranslation(sceneRoot, programState->backpackPosition);
+        sceneGraph.SetTranslation(floorNode, glm::vec3(0.0f, -2.0f, 0.0f));
+        sceneGraph.SetScale(floorNode, glm::vec3(programState->backpackScale * 5));
+        sceneGraph.SetScale(villaNode, glm::vec3(programState->backpackScale));
+        for (int i = 1; i <= CLOCK_COUNT && !programState->ProceduralClocks; i++) {
+            double currentFrame = currFrame / 1000;
+            sceneGraph.SetTranslation(clockNodes[i - 1],
+                glm::vec3(cos(i * currentFrame) * ((i+1) * currentFrame), 10 + sin(currentFrame * 20) * 2 * cos(currentFrame * 20), 35 * sin(currentFrame * i + 5)));
+            sceneGraph.SetScale(clockNodes[i - 1], glm::vec3(programState->backpackScale));
+        }
+        {
+            RG_ZONE("scene graph");
+            sceneGraph.Update();
+        }
+        auto clockTransform = [&](int i) {
+            return sceneGraph.World(clockNodes[i - 1]);
+        };
+        auto floorTransform = [&]() {
+            return sceneGraph.World(floorNode);
+        };
+        auto villaTransform = [&]() {
+            return sceneGraph.World(villaNode);
+        };
 
         //////////////////////////////////////////////////
         //                                              //
         //                   Ciscenje                   //
         //                                              //
         //////////////////////////////////////////////////
-        if (isPostProcessingEnabled) {
-            if (isHDREnabled) {
-                framebufferShader.use();
-                framebufferShader.setBool("HDR", true);
-            } else {
-                framebufferShader.use();
-                framebufferShader.setBool("HDR", false);
-            }
-            glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+        // the scene goes through an offscreen target for post-processing, dynamic resolution and TAA,
+        // otherwise the scene passes draw straight into the backbuffer
+        // debug views replace the scene colours, every effect working on them is off while one is shown
+        bool isDebugView = rg::DebugView::IsActive();
+        bool isPostEnabled = isPostProcessingEnabled && !isDebugView;
+        bool isTemporalAAEnabled = temporalAA.Enabled && !isDebugView;
+        bool isOffscreenEnabled = isPostEnabled || dynamicResolution.Enabled || isTemporalAAEnabled || isDebugView;
+        unsigned int renderWidth = dynamicResolution.ScaledSize(SCR_WIDTH);
+        unsigned int renderHeight = dynamicResolution.ScaledSize(SCR_HEIGHT);
+        if (isTemporalAAEnabled && temporalAA.Upscale && !dynamicResolution.Enabled) {
+            renderWidth = (unsigned int) (SCR_WIDTH * temporalAA.InternalScale);
+            renderHeight = (unsigned int) (SCR_HEIGHT * temporalAA.InternalScale);
         }
-        glClearColor(pow(programState->clearColor.r,gamma), pow(programState->clearColor.g,gamma), pow(programState->clearColor.b,gamma), 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
-        // pozicija svetla
-        pointLight.position = glm::vec3(150.0 * cos(currFrame), 120 + 100.0f * abs(cos(currFrame)), 150* sin(currFrame/10));
 
+        // one projection for every scene pass, with the sub-pixel jitter when TAA is on
+        glm::mat4 projection = glm::perspective(glm::radians(programState->camera.Zoom),
+                                                (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
+        if (!isDebugView)
+            projection = temporalAA.BeginFrame(projection, programState->camera.GetViewMatrix(), renderWidth, renderHeight);
+
+        frameGraph.Reset();
+        rg::FrameGraphResource backbuffer = frameGraph.ImportBackbuffer(windowWidth, windowHeight, headless ? headless->Framebuffer() : 0);
+        rg::FrameGraphResource sceneColor = backbuffer;
+        rg::FrameGraphResource sceneDepth = -1;
+        auto sceneTargets = [&](rg::FrameGraph::Builder& builder) {
+            builder.Write(sceneColor);
+            if (sceneDepth >= 0) {
+                builder.WriteDepth(sceneDepth);
+                builder.SetViewport(renderWidth, renderHeight);
+            }
+        };
+
+        frameGraph.AddPass("clear",
+            [&](rg::FrameGraph::Builder& builder) {
+                if (isOffscreenEnabled) {
+                    sceneColor = builder.Create("sceneColor", rg::FrameGraphTextureDesc(SCR_WIDTH, SCR_HEIGHT, GL_RGB16F));
+                    sceneDepth = builder.Create("sceneDepth", rg::FrameGraphTextureDesc(SCR_WIDTH, SCR_HEIGHT, GL_DEPTH24_STENCIL8, GL_NEAREST));
+                }
+                sceneTargets(builder);
+            },
+            [&](const rg::FrameGraph&) {
+                if (isDebugView)
+                    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+                else
+                    glClearColor(pow(programState->clearColor.r,gamma), pow(programState->clearColor.g,gamma), pow(programState->clearColor.b,gamma), 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+                // every scene pass adds its fragments up until the present pass
+                if (rg::DebugView::IsAdditive()) {
+                    glEnable(GL_BLEND);
+                    glBlendFunc(GL_ONE, GL_ONE);
+                }
+            });
 
         ////////////////////////////////////////////////////
         //                                                //
         //              Crtanje modela auta               //
         //                                                //
         ////////////////////////////////////////////////////
-
-        carShader.use();
-        carShader.setVec3("pointLight.position", pointLight.position);
-        carShader.setVec3("pointLight.ambient", pointLight.ambient);
-        carShader.setVec3("pointLight.diffuse", pointLight.diffuse);
-        carShader.setVec3("pointLight.specular", pointLight.specular);
-        carShader.setFloat("pointLight.constant", pointLight.constant);
-        carShader.setFloat("pointLight.linear", pointLight.linear);
-        carShader.setFloat("pointLight.quadratic", pointLight.quadratic);
-        carShader.setVec3("viewPosition", programState->camera.Position);
-        carShader.setFloat("material.shininess", 32.0f);
-        glm::mat4 car_projection = glm::perspective(glm::radians(programState->camera.Zoom),
-                                                (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 car_view = programState->camera.GetViewMatrix();
-        carShader.setMat4("projection", car_projection);
-        carShader.setMat4("view", car_view);
-        glm::mat4 car_model = glm::mat4(1.0f);
-        car_model = glm::translate(car_model, programState->backpackPosition + glm::vec3(0, 0, 45));
-        car_model = glm::scale(car_model, glm::vec3(programState->backpackScale));
-        carShader.setMat4("model", car_model);
-
-        glStencilFunc(GL_ALWAYS, 1, 0xFF);
-        glStencilMask(0xFF);
-
-        carModel.Draw(carShader);
-
-        glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
-        glStencilMask(0x00);
-        glDisable(GL_DEPTH_TEST);
-        carLineShader.use();
-        carLineShader.setFloat("outlining", 0.029f);
-        carLineShader.setMat4("projection", car_projection);
-        carLineShader.setMat4("view", car_view);
-        carLineShader.setMat4("model", car_model);
-        carModel.Draw(carLineShader);
-        glStencilMask(0xFF);
-        glStencilFunc(GL_ALWAYS, 0, 0xFF);
-        glEnable(GL_DEPTH_TEST);
+        frameGraph.AddPass("car", sceneTargets, [&](const rg::FrameGraph&) {
+            carShader.use();
+            carShader.setVec3("pointLight.position", pointLight.position);
+            carShader.setVec3("pointLight.ambient", pointLight.ambient);
+            carShader.setVec3("pointLight.diffuse", pointLight.diffuse);
+            carShader.setVec3("pointLight.specular", pointLight.specular);
+            carShader.setFloat("pointLight.constant", pointLight.constant);
+            carShader.setFloat("pointLight.linear", pointLight.linear);
+            carShader.setFloat("pointLight.quadratic", pointLight.quadratic);
+            carShader.setVec3("viewPosition", programState->camera.Position);
+            carShader.setFloat("material.shininess", 32.0f);
+            glm::mat4 car_projection = projection;
+            glm::mat4 car_view = programState->camera.GetViewMatrix();
+            carShader.setMat4("projection", car_projection);
+            carShader.setMat4("view", car_view);
+            glm::mat4 car_model = glm::mat4(1.0f);
+            car_model = glm::translate(car_model, programState->backpackPosition + glm::vec3(0, 0, 45));
+            car_model = glm::scale(car_model, glm::vec3(programState->backpackScale));
+            carShader.setMat4("model", car_model);
+
+            glStencilFunc(GL_ALWAYS, 1, 0xFF);
+            glStencilMask(0xFF);
+
+            carModel.Draw(carShader);
+
+            rg::GpuProfiler::Scope outlineScope(gpuProfiler, "outline");
+            glStencilFunc(GL_NOTEQUAL, 1, 0xFF);
+            glStencilMask(0x00);
+            glDisable(GL_DEPTH_TEST);
+            carLineShader.use();
+            carLineShader.setFloat("outlining", 0.029f);
+            carLineShader.setMat4("projection", car_projection);
+            carLineShader.setMat4("view", car_view);
+            carLineShader.setMat4("model", car_model);
+            carModel.Draw(carLineShader);
+            glStencilMask(0xFF);
+            glStencilFunc(GL_ALWAYS, 0, 0xFF);
+            glEnable(GL_DEPTH_TEST);
+        });
 
         ////////////////////////////////////////////////////
         //                                                //
-        //              Crtanje modela sata               //
+        //          Crtanje scene na GPU (4.3+)           //
         //                                                //
         ////////////////////////////////////////////////////
-        clockShader.use();
-        clockShader.setVec3("pointLight.position", pointLight.position);
-        clockShader.setVec3("pointLight.ambient", pointLight.ambient);
-        clockShader.setVec3("pointLight.diffuse", pointLight.diffuse);
-        clockShader.setVec3("pointLight.specular", pointLight.specular);
-        clockShader.setFloat("pointLight.constant", pointLight.constant);
-        clockShader.setFloat("pointLight.linear", pointLight.linear);
-        clockShader.setFloat("pointLight.quadratic", pointLight.quadratic);
-        clockShader.setVec3("viewPosition", programState->camera.Position);
-        clockShader.setFloat("material.shininess", 32.0f);
-
-
-        glEnable(GL_CULL_FACE);
-        glCullFace(GL_FRONT);
-        glFrontFace(GL_CCW);
-        
-        double currentFrame = currFrame / 1000;
-        for (int i = 1; i < 102; i++) {
-            glm::mat4 clock_projection = glm::perspective(glm::radians(programState->camera.Zoom),
-                                                    (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
-            glm::mat4 clock_view = programState->camera.GetViewMatrix();
-            clockShader.setMat4("projection", clock_projection);
-            clockShader.setMat4("view", clock_view);
-            glm::mat4 clock_model = glm::mat4(1.0f);
-            clock_model = glm::translate(clock_model, 
-                programState->backpackPosition + glm::vec3(cos(i * currentFrame) * ((i+1) * currentFrame), 10 + sin(currentFrame * 20) * 2 * cos(currentFrame * 20), 35 * sin(currentFrame * i + 5)));
-            clock_model = glm::scale(clock_model, glm::vec3(programState->backpackScale));
-            clockShader.setMat4("model", clock_model);
-            clockModel.Draw(clockShader);
-        }
-        glDisable(GL_CULL_FACE);
+        // satovi, pod i vila u jednom prolazu: GPU odseca objekte i sam pravi komande za crtanje
+        // multi-draws have no per mesh uniform, the mesh index view draws mesh by mesh
+        bool isGpuSceneEnabled = gpuScene.IsAvailable() && gpuScene.Enabled && rg::DebugView::Current != rg::DebugView::MESH_INDEX;
+        bool isProceduralClocks = programState->ProceduralClocks;
+        bool isAnimatedClocks = isProceduralClocks && programState->AnimatedClocks;
+        if (isAnimatedClocks) {
+            RG_ZONE("clock animation");
+            clockAnimator.Update(currFrame);
+        }
+        // nivo detalja svakog sata po gresci projektovanoj na ekran
+        clockLods.BeginFrame(programState->camera.Position, glm::radians(programState->camera.Zoom), (float) renderHeight,
+                             deltaTime, CLOCK_COUNT);
+        int clockImpostorLevel = clockLods.ImpostorLevel();
+        clockImpostor.Clear();
+        for (int i = 1; i <= CLOCK_COUNT && !isProceduralClocks; i++) {
+            const rg::LodSelector::State& lod = clockLods.Update(i - 1, clockTransform(i));
+            if (lod.Current == clockImpostorLevel)
+                clockImpostor.AddInstance(clockTransform(i), lod.Previous != lod.Current ? lod.Fade : 1.0f);
+            else if (lod.Previous == clockImpostorLevel)
+                clockImpostor.AddInstance(clockTransform(i), -lod.Fade);
+        }
+        if (isGpuSceneEnabled) {
+            for (int i = 1; i <= CLOCK_COUNT; i++) {
+                if (isProceduralClocks) {
+                    gpuScene.Hide(firstClockInstance + i - 1);
+                    continue;
+                }
+                const rg::LodSelector::State& lod = clockLods.GetState(i - 1);
+                gpuScene.SetTransform(firstClockInstance + i - 1, clockTransform(i));
+                gpuScene.SetLod(firstClockInstance + i - 1, lod.Current, lod.Previous, lod.Fade);
+            }
+            gpuScene.SetTransform(floorInstance, floorTransform());
+            gpuScene.SetTransform(villaInstance, villaTransform());
+
+            frameGraph.AddPass("gpu scene", sceneTargets, [&](const rg::FrameGraph&) {
+                for (Shader* shader : {gpuClockShader.get(), gpuFloorShader.get(), gpuVillaShader.get()}) {
+                    shader->use();
+                    shader->setVec3("pointLight.position", pointLight.position);
+                    shader->setVec3("pointLight.ambient", pointLight.ambient);
+                    shader->setVec3("pointLight.diffuse", pointLight.diffuse);
+                    shader->setVec3("pointLight.specular", pointLight.specular);
+                    shader->setFloat("pointLight.constant", pointLight.constant);
+                    shader->setFloat("pointLight.linear", pointLight.linear);
+                    shader->setFloat("pointLight.quadratic", pointLight.quadratic);
+                    shader->setVec3("viewPosition", programState->camera.Position);
+                    shader->setFloat("material.shininess", 32.0f);
+                }
+                glFrontFace(GL_CCW);
+                gpuScene.Draw(projection, programState->camera.GetViewMatrix(), programState->camera.Position);
+            });
+        } else {
+            ////////////////////////////////////////////////////
+            //                                                //
+            //              Crtanje modela sata               //
+            //                                                //
+            ////////////////////////////////////////////////////
+            frameGraph.AddPass("clocks", sceneTargets, [&](const rg::FrameGraph&) {
+                clockShader.use();
+                clockShader.setVec3("pointLight.position", pointLight.position);
+                clockShader.setVec3("pointLight.ambient", pointLight.ambient);
+                clockShader.setVec3("pointLight.diffuse", pointLight.diffuse);
+                clockShader.setVec3("pointLight.specular", pointLight.specular);
+                clockShader.setFloat("pointLight.constant", pointLight.constant);
+                clockShader.setFloat("pointLight.linear", pointLight.linear);
+                clockShader.setFloat("pointLight.quadratic", pointLight.quadratic);
+                clockShader.setVec3("viewPosition", programState->camera.Position);
+                clockShader.setFloat("material.shininess", 32.0f);
+
+
+                glEnable(GL_CULL_FACE);
+                glCullFace(GL_FRONT);
+                glFrontFace(GL_CCW);
+
+                // proceduralni satovi se crtaju u svom prolazu
+                for (int i = 1; i <= CLOCK_COUNT && !isProceduralClocks; i++) {
+                    glm::mat4 clock_projection = projection;
+                    glm::mat4 clock_view = programState->camera.GetViewMatrix();
+                    clockShader.setMat4("projection", clock_projection);
+                    clockShader.setMat4("view", clock_view);
+                    clockShader.setMat4("model", clockTransform(i));
+                    // tokom prelaza se crtaju oba nivoa, svaki sa svojim delom piksela
+                    const rg::LodSelector::State& lod = clockLods.GetState(i - 1);
+                    if (lod.Previous != lod.Current && lod.Previous != clockImpostorLevel) {
+                        clockShader.setFloat("lodFade", -lod.Fade);
+                        clockModel.Draw(clockShader, lod.Previous);
+                    }
+                    if (lod.Current != clockImpostorLevel) {
+                        clockShader.setFloat("lodFade", lod.Previous != lod.Current ? lod.Fade : 1.0f);
+                        clockModel.Draw(clockShader, lod.Current);
+                    }
+                }
+                glDisable(GL_CULL_FACE);
+            });
+
+            ////////////////////////////////////////////////////
+            //                                                //
+            //              Crtanje modela poda               //
+            //                                                //
+            ////////////////////////////////////////////////////
+            frameGraph.AddPass("floor", sceneTargets, [&](const rg::FrameGraph&) {
+                floorShader.use();
+                floorShader.setVec3("pointLight.position", pointLight.position);
+                floorShader.setVec3("pointLight.ambient", pointLight.ambient);
+                floorShader.setVec3("pointLight.diffuse", pointLight.diffuse);
+                floorShader.setVec3("pointLight.specular", pointLight.specular);
+                floorShader.setFloat("pointLight.constant", pointLight.constant);
+                floorShader.setFloat("pointLight.linear", pointLight.linear);
+                floorShader.setFloat("pointLight.quadratic", pointLight.quadratic);
+                floorShader.setVec3("viewPosition", programState->camera.Position);
+                floorShader.setFloat("material.shininess", 32.0f);
+
+                // glEnable(GL_CULL_FACE);
+                // glCullFace(GL_FRONT);
+                // glFrontFace(GL_CCW);
+
+
+                glm::mat4 floor_projection = projection;
+                glm::mat4 floor_view = programState->camera.GetViewMatrix();
+                floorShader.setMat4("projection", floor_projection);
+                floorShader.setMat4("view", floor_view);
+                floorShader.setMat4("model", floorTransform());
+                floorModel.Draw(floorShader);
+
+                // glDisable(GL_CULL_FACE);
+            });
+
+            ////////////////////////////////////////////////////
+            //                                                //
+            //              Crtanje modela vile               //
+            //                                                //
+            ////////////////////////////////////////////////////
+            frameGraph.AddPass("villa", sceneTargets, [&](const rg::FrameGraph&) {
+                villaShader.use();
+                villaShader.setVec3("pointLight.position", pointLight.position);
+                villaShader.setVec3("pointLight.ambient", pointLight.ambient);
+                villaShader.setVec3("pointLight.diffuse", pointLight.diffuse);
+                villaShader.setVec3("pointLight.specular", pointLight.specular);
+                villaShader.setFloat("pointLight.constant", pointLight.constant);
+                villaShader.setFloat("pointLight.linear", pointLight.linear);
+                villaShader.setFloat("pointLight.quadratic", pointLight.quadratic);
+                villaShader.setVec3("viewPosition", programState->camera.Position);
+                villaShader.setFloat("material.shininess", 32.0f);
+                glm::mat4 villa_projection = projection;
+                glm::mat4 villa_view = programState->camera.GetViewMatrix();
+                villaShader.setMat4("projection", villa_projection);
+                villaShader.setMat4("view", villa_view);
+                villaShader.setMat4("model", villaTransform());
+                villaModel.Draw(villaShader);
+            });
+        }
+
 
         ////////////////////////////////////////////////////
         //                                                //
-        //              Crtanje modela poda               //
+        //         Proceduralno kretanje satova           //
         //                                                //
         ////////////////////////////////////////////////////
-        floorShader.use();
-        floorShader.setVec3("pointLight.position", pointLight.position);
-        floorShader.setVec3("pointLight.ambient", pointLight.ambient);
-        floorShader.setVec3("pointLight.diffuse", pointLight.diffuse);
-        floorShader.setVec3("pointLight.specular", pointLight.specular);
-        floorShader.setFloat("pointLight.constant", pointLight.constant);
-        floorShader.setFloat("pointLight.linear", pointLight.linear);
-        floorShader.setFloat("pointLight.quadratic", pointLight.quadratic);
-        floorShader.setVec3("viewPosition", programState->camera.Position);
-        floorShader.setFloat("material.shininess", 32.0f);
-
-        // glEnable(GL_CULL_FACE);
-        // glCullFace(GL_FRONT);
-        // glFrontFace(GL_CCW);
-        
-
-        glm::mat4 floor_projection = glm::perspective(glm::radians(programState->camera.Zoom),
-                                                (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 floor_view = programState->camera.GetViewMatrix();
-        floorShader.setMat4("projection", floor_projection);
-        floorShader.setMat4("view", floor_view);
-        glm::mat4 floor_model = glm::mat4(1.0f);
-        floor_model = glm::translate(floor_model, 
-            programState->backpackPosition + glm::vec3(0.0f, -2.0f, 0.0f));
-        floor_model = glm::scale(floor_model, glm::vec3(programState->backpackScale * 5));
-        floorShader.setMat4("model", floor_model);
-        floorModel.Draw(floorShader);
-
-        // glDisable(GL_CULL_FACE);
-
-
-
+        // jedan instancirani poziv, clock.vs racuna polozaj sata iz vremena i gl_InstanceID
+        if (isProceduralClocks) {
+            frameGraph.AddPass("procedural clocks", sceneTargets, [&](const rg::FrameGraph&) {
+                clockShader.use();
+                clockShader.setVec3("pointLight.position", pointLight.position);
+                clockShader.setVec3("pointLight.ambient", pointLight.ambient);
+                clockShader.setVec3("pointLight.diffuse", pointLight.diffuse);
+                clockShader.setVec3("pointLight.specular", pointLight.specular);
+                clockShader.setFloat("pointLight.constant", pointLight.constant);
+                clockShader.setFloat("pointLight.linear", pointLight.linear);
+                clockShader.setFloat("pointLight.quadratic", pointLight.quadratic);
+                clockShader.setVec3("viewPosition", programState->camera.Position);
+                clockShader.setFloat("material.shininess", 32.0f);
+                clockShader.setMat4("projection", projection);
+                clockShader.setMat4("view", programState->camera.GetViewMatrix());
+                clockShader.setBool("proceduralMotion", true);
+                clockShader.setFloat("time", currFrame);
+                clockShader.setVec3("swarmOrigin", programState->backpackPosition);
+                clockShader.setFloat("swarmScale", programState->backpackScale);
+                clockShader.setFloat("lodFade", 1.0f);
+
+                if (isAnimatedClocks) {
+                    // matrice cvorova svih faza animacije, svaki primerak cita svoju fazu
+                    clockShader.setBool("nodeAnimation", true);
+                    clockShader.setInt("nodeCount", clockAnimator.NodeCount());
+                    clockShader.setInt("phases", clockAnimator.Phases());
+                    glActiveTexture(GL_TEXTURE8);
+                    glBindTexture(GL_TEXTURE_BUFFER, clockAnimator.NodeMatrices());
+                    glActiveTexture(GL_TEXTURE0);
+                    for (Mesh& mesh : animatedClockModel.meshes) {
+                        clockShader.setInt("node", mesh.node);
+                        mesh.Draw(clockShader, 0, programState->ProceduralClockCount);
+                    }
+                    clockShader.setBool("nodeAnimation", false);
+                } else {
+                    glEnable(GL_CULL_FACE);
+                    glCullFace(GL_FRONT);
+                    glFrontFace(GL_CCW);
+                    clockModel.Draw(clockShader, 0, programState->ProceduralClockCount);
+                    glDisable(GL_CULL_FACE);
+                }
+                clockShader.setBool("proceduralMotion", false);
+            });
+        }
 
         ////////////////////////////////////////////////////
         //                                                //
-        //              Crtanje modela trave              //
+        //            Crtanje dalekih satova              //
         //                                                //
         ////////////////////////////////////////////////////
-        grassShader.use();
-        grassShader.setVec3("pointLight.position", pointLight.position);
-        grassShader.setVec3("pointLight.ambient", pointLight.ambient);
-        grassShader.setVec3("pointLight.diffuse", pointLight.diffuse);
-        grassShader.setVec3("pointLight.specular", pointLight.specular);
-        grassShader.setFloat("pointLight.constant", pointLight.constant);
-        grassShader.setFloat("pointLight.linear", pointLight.linear);
-        grassShader.setFloat("pointLight.quadratic", pointLight.quadratic);
-        grassShader.setVec3("viewPosition", programState->camera.Position);
-        grassShader.setFloat("material.shininess", 32.0f);
-
-        // glEnable(GL_CULL_FACE);
-        // glCullFace(GL_FRONT);
-        // glFrontFace(GL_CCW);
-        
-
-        glm::mat4 grass_projection = glm::perspective(glm::radians(programState->camera.Zoom),
-                                                (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 grass_view = programState->camera.GetViewMatrix();
-        grassShader.setMat4("projection", grass_projection);
-        grassShader.setMat4("view", grass_view);
-        glm::mat4 grass_model = glm::mat4(1.0f);
-        grass_model = glm::translate(grass_model, 
-            programState->backpackPosition + glm::vec3(0.0f, -2.0f, 0.0f));
-        grass_model = glm::scale(grass_model, glm::vec3(programState->backpackScale * 5));
-        grassShader.setMat4("model", grass_model);
-        
-        glEnable(GL_CULL_FACE);
-        glEnable(GL_BLEND);
-        grassModel.Draw(grassShader);
-        glDisable(GL_BLEND);
-        glDisable(GL_CULL_FACE);
-
-
-
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        if (clockImpostor.InstanceCount() > 0) {
+            frameGraph.AddPass("clock impostors", sceneTargets, [&](const rg::FrameGraph&) {
+                Shader& impostorShader = clockImpostor.GetShader();
+                impostorShader.use();
+                impostorShader.setVec3("pointLight.position", pointLight.position);
+                impostorShader.setVec3("pointLight.ambient", pointLight.ambient);
+                impostorShader.setVec3("pointLight.diffuse", pointLight.diffuse);
+                impostorShader.setVec3("pointLight.specular", pointLight.specular);
+                impostorShader.setFloat("pointLight.constant", pointLight.constant);
+                impostorShader.setFloat("pointLight.linear", pointLight.linear);
+                impostorShader.setFloat("pointLight.quadratic", pointLight.quadratic);
+                impostorShader.setVec3("viewPosition", programState->camera.Position);
+                clockImpostor.Draw(projection, programState->camera.GetViewMatrix(), programState->camera.Position);
+            });
+        }
 
+        ////////////////////////////////////////////////////
+        //                                                //
+        //              Crtanje polja trave               //
+        //                                                //
+        ////////////////////////////////////////////////////
+        if (grassField.Enabled) {
+            frameGraph.AddPass("grass field", sceneTargets, [&](const rg::FrameGraph&) {
+                Shader& grassFieldShader = grassField.GetShader();
+                grassFieldShader.use();
+                grassFieldShader.setVec3("pointLight.position", pointLight.position);
+                grassFieldShader.setVec3("pointLight.ambient", pointLight.ambient);
+                grassFieldShader.setVec3("pointLight.diffuse", pointLight.diffuse);
+                grassFieldShader.setVec3("pointLight.specular", pointLight.specular);
+                grassFieldShader.setFloat("pointLight.constant", pointLight.constant);
+                grassFieldShader.setFloat("pointLight.linear", pointLight.linear);
+                grassFieldShader.setFloat("pointLight.quadratic", pointLight.quadratic);
+                grassFieldShader.setVec3("viewPosition", programState->camera.Position);
+                grassField.Center = programState->backpackPosition + glm::vec3(0.0f, -2.0f, 0.0f);
+                grassField.Draw(projection, programState->camera.GetViewMatrix(), programState->camera.Position, currFrame);
+            });
+        }
 
         ////////////////////////////////////////////////////
         //                                                //
-        //              Crtanje modela vile               //
+        //              Crtanje modela trave              //
         //                                                //
         ////////////////////////////////////////////////////
-        villaShader.use();
-        villaShader.setVec3("pointLight.position", pointLight.position);
-        villaShader.setVec3("pointLight.ambient", pointLight.ambient);
-        villaShader.setVec3("pointLight.diffuse", pointLight.diffuse);
-        villaShader.setVec3("pointLight.specular", pointLight.specular);
-        villaShader.setFloat("pointLight.constant", pointLight.constant);
-        villaShader.setFloat("pointLight.linear", pointLight.linear);
-        villaShader.setFloat("pointLight.quadratic", pointLight.quadratic);
-        villaShader.setVec3("viewPosition", programState->camera.Position);
-        villaShader.setFloat("material.shininess", 32.0f);
-        glm::mat4 villa_projection = glm::perspective(glm::radians(programState->camera.Zoom),
-                                                (float) SCR_WIDTH / (float) SCR_HEIGHT, 0.1f, 100.0f);
-        glm::mat4 villa_view = programState->camera.GetViewMatrix();
-        villaShader.setMat4("projection", villa_projection);
-        villaShader.setMat4("view", villa_view);
-        glm::mat4 villa_model = glm::mat4(1.0f);
-        villa_model = glm::translate(villa_model, programState->backpackPosition + glm::vec3(0, 0, 0));
-        villa_model = glm::scale(villa_model, glm::vec3(programState->backpackScale));
-        villaShader.setMat4("model", villa_model);
-        villaModel.Draw(villaShader);
+        // blended after every opaque pass: as weighted blended OIT into its own targets when the
+        // scene has a depth texture to test against, otherwise straight into the scene in draw order
+        bool isGrassWeightedBlended = sceneDepth >= 0 && weightedBlendedOIT.Enabled && !isDebugView;
+        auto drawGrass = [&]() {
+            grassShader.use();
+            grassShader.setBool("weightedBlended", isGrassWeightedBlended);
+            grassShader.setFloat("alphaCutoff", isGrassWeightedBlended ? 0.01f : 0.1f);
+            grassShader.setVec3("pointLight.position", pointLight.position);
+            grassShader.setVec3("pointLight.ambient", pointLight.ambient);
+            grassShader.setVec3("pointLight.diffuse", pointLight.diffuse);
+            grassShader.setVec3("pointLight.specular", pointLight.specular);
+            grassShader.setFloat("pointLight.constant", pointLight.constant);
+            grassShader.setFloat("pointLight.linear", pointLight.linear);
+            grassShader.setFloat("pointLight.quadratic", pointLight.quadratic);
+            grassShader.setVec3("viewPosition", programState->camera.Position);
+            grassShader.setFloat("material.shininess", 32.0f);
+
+            // glEnable(GL_CULL_FACE);
+            // glCullFace(GL_FRONT);
+            // glFrontFace(GL_CCW);
+
+
+            glm::mat4 grass_projection = projection;
+            glm::mat4 grass_view = programState->camera.GetViewMatrix();
+            grassShader.setMat4("projection", grass_projection);
+            grassShader.setMat4("view", grass_view);
+            glm::mat4 grass_model = glm::mat4(1.0f);
+            grass_model = glm::translate(grass_model, 
+                programState->backpackPosition + glm::vec3(0.0f, -2.0f, 0.0f));
+            grass_model = glm::scale(grass_model, glm::vec3(programState->backpackScale * 5));
+            grassShader.setMat4("model", grass_model);
+
+            glEnable(GL_CULL_FACE);
+            grassModel.Draw(grassShader);
+            glDisable(GL_CULL_FACE);
+        };
+        if (isGrassWeightedBlended) {
+            weightedBlendedOIT.AddPasses(frameGraph, sceneColor, sceneDepth, renderWidth, renderHeight, drawGrass);
+        } else {
+            frameGraph.AddPass("grass", sceneTargets, [&](const rg::FrameGraph&) {
+                if (rg::DebugView::IsAdditive()) {
+                    drawGrass();
+                    return;
+                }
+                glEnable(GL_BLEND);
+                drawGrass();
+                glDisable(GL_BLEND);
+            });
+        }
+
 
         ////////////////////////////////////////////////////
         //                                                //
         //               Post - Processing                //
         //                                                //
         ////////////////////////////////////////////////////
+        // TAA resolves the scene to full resolution, everything after it works on the resolved frame
+        rg::FrameGraphResource resolvedColor = sceneColor;
+        rg::FrameGraphResource resolvedDepth = sceneDepth;
+        unsigned int resolvedWidth = renderWidth;
+        unsigned int resolvedHeight = renderHeight;
+        if (isTemporalAAEnabled) {
+            resolvedColor = temporalAA.AddPass(frameGraph, sceneColor, sceneDepth, renderWidth, renderHeight);
+            resolvedDepth = -1;
+            resolvedWidth = SCR_WIDTH;
+            resolvedHeight = SCR_HEIGHT;
+        }
 
-        if (isPostProcessingEnabled) {
-            framebufferShader.use();
-            glBindVertexArray(rectVAO);
-            glDisable(GL_DEPTH_TEST);
-            glBindTexture(GL_TEXTURE_2D, framebufferTexture);
-            glDrawArrays(GL_TRIANGLES, 0, 6);
+        // on 4.3 the effects run as compute dispatches and the last pass only upscales the result,
+        // on 3.3 framebuffer.fs does both in one fragment pass
+        rg::FrameGraphResource postColor = resolvedColor;
+        // bloom goes with the tonemap, the kernel view shows the scene without it
+        rg::FrameGraphResource bloomColor = -1;
+        bool isBloomEnabled = isPostEnabled && !isHDREnabled && bloom.Enabled;
+        if (isBloomEnabled)
+            bloomColor = bloom.AddPasses(frameGraph, resolvedColor, resolvedWidth, resolvedHeight);
+        bool isComputePostEnabled = isPostEnabled && postProcessing.IsAvailable() && postProcessing.Enabled;
+        if (isComputePostEnabled) {
+            postProcessing.Gamma = gamma;
+            postProcessing.BloomStrength = bloom.Strength;
+            int effects = isHDREnabled ? rg::PostProcessing::EFFECT_KERNEL
+                                       : rg::PostProcessing::EFFECT_TONEMAP | rg::PostProcessing::EFFECT_GAMMA;
+            if (isBloomEnabled)
+                effects |= rg::PostProcessing::EFFECT_BLOOM;
+            rg::FrameGraphResource exposure = -1;
+            if (!isHDREnabled && autoExposure.IsAvailable() && autoExposure.Enabled)
+                exposure = autoExposure.AddPasses(frameGraph, resolvedColor, resolvedWidth, resolvedHeight, deltaTime);
+            postColor = postProcessing.AddPasses(frameGraph, resolvedColor, resolvedDepth, bloomColor, exposure,
+                                                 resolvedWidth, resolvedHeight, effects);
+        }
+        if (isOffscreenEnabled) {
+            frameGraph.AddPass("present",
+                [&](rg::FrameGraph::Builder& builder) {
+                    builder.Read(postColor);
+                    if (isBloomEnabled && !isComputePostEnabled)
+                        builder.Read(bloomColor);
+                    builder.Write(backbuffer);
+                },
+                [&](const rg::FrameGraph& graph) {
+                    if (rg::DebugView::IsAdditive()) {
+                        glDisable(GL_BLEND);
+                        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                    }
+                    // use() sets debugView, framebuffer.fs shows the view instead of the scene
+                    framebufferShader.use();
+                    framebufferShader.setFloat("debugViewScale", rg::DebugView::Scale());
+                    framebufferShader.setBool("postProcessing", isPostEnabled && !isComputePostEnabled);
+                    framebufferShader.setBool("HDR", isHDREnabled);
+                    framebufferShader.setBool("bloom", isBloomEnabled && !isComputePostEnabled);
+                    framebufferShader.setFloat("bloomStrength", bloom.Strength);
+                    framebufferShader.setVec2("renderScale", (float) resolvedWidth / SCR_WIDTH, (float) resolvedHeight / SCR_HEIGHT);
+                    glBindVertexArray(rectVAO);
+                    glDisable(GL_DEPTH_TEST);
+                    glActiveTexture(GL_TEXTURE0);
+                    glBindTexture(GL_TEXTURE_2D, graph.GetTexture(postColor));
+                    if (isBloomEnabled && !isComputePostEnabled) {
+                        glActiveTexture(GL_TEXTURE1);
+                        glBindTexture(GL_TEXTURE_2D, graph.GetTexture(bloomColor));
+                        glActiveTexture(GL_TEXTURE0);
+                    }
+                    glDrawArrays(GL_TRIANGLES, 0, 6);
+                    glEnable(GL_DEPTH_TEST);
+                });
+        }
+
+        {
+            RG_ZONE("frame graph compile");
+            frameGraph.Compile();
         }
+        {
+            RG_ZONE("frame graph execute");
+            frameGraph.Execute();
+        }
+        pipelineStatistics.EndFrame();
+        gpuProfiler.EndFrame();
+        frameTimer.End();
 
 
         ////////////////////////////////////////////////////
@@ -490,14 +1034,35 @@ int main() {
         //                      GUI                       //
         //                                                //
         ////////////////////////////////////////////////////
-        if (programState->ImGuiEnabled)
-            DrawImGui(programState);
+        if (benchmark) {
+            // bez swap-a nista ne koci CPU, frejm se zavrsava kad ga GPU zavrsi
+            benchmark->EndSubmit();
+            RG_ZONE("gpu wait");
+            glFinish();
+            // GPU vreme ovog frejma, ne nekog od prethodnih
+            frameTimer.Collect(true);
+            benchmark->EndFrame(frameTimer.LastMs());
+            if (window)
+                glfwPollEvents();
+            continue;
+        }
+        if (programState->ImGuiEnabled) {
+            RG_ZONE("imgui");
+            DrawImGui(programState, frameGraph, postProcessing, bloom, autoExposure, temporalAA, weightedBlendedOIT, grassField, gpuScene, clockLods, clockImpostor, clockAnimator, sceneGraph, sceneGraphBenchmark, cameraTrack, gpuProfiler, pipelineStatistics, frameStats);
+        }
+
+        // pre swap-a, brojaci crtanja su jos od ovog frejma
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        frameStats.Record(std::chrono::duration<float, std::milli>(now - frameEnd).count(),
+                          std::chrono::duration<float, std::milli>(now - frameStart).count(), frameTimer.LastMs());
+        frameEnd = now;
 
         ////////////////////////////////////////////////////
         //                                                //
         //                Duplo Baferovanje               //
         //                                                //
         ////////////////////////////////////////////////////
+        RG_ZONE("swap");
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
@@ -509,13 +1074,34 @@ int main() {
     //             Oslobadjanje resursa             //
     //                                              //
     //////////////////////////////////////////////////
-    programState->SaveToFile("resources/program_state.txt");
+    int exitCode = 0;
+    if (benchmark) {
+#ifdef RG_CPU_PROFILER
+        if (!tracePath.empty())
+            rg::CpuProfiler::WriteChromeTrace(tracePath);
+#endif
+        benchmark->Finish();
+        benchmark->WriteReport((const char*) glGetString(GL_RENDERER), (const char*) glGetString(GL_VERSION), windowWidth, windowHeight);
+        if (benchmark->OverBudgetFrames() > 0) {
+            std::cout << "ERROR::BENCHMARK:: " << benchmark->OverBudgetFrames() << " frames over the draw budget" << std::endl;
+            exitCode = 1;
+        }
+        if (isWriteBaseline) {
+            if (!benchmark->WriteBaseline(benchmarkBaseline))
+                exitCode = 1;
+        } else if (benchmark->CompareBaseline(benchmarkBaseline, windowWidth, windowHeight) != 0) {
+            exitCode = 1;
+        }
+    } else {
+        programState->SaveToFile("resources/program_state.txt");
+        ImGui_ImplOpenGL3_Shutdown();
+        ImGui_ImplGlfw_Shutdown();
+        ImGui::DestroyContext();
+    }
     delete programState;
-    ImGui_ImplOpenGL3_Shutdown();
-    ImGui_ImplGlfw_Shutdown();
-    ImGui::DestroyContext();
-    glfwTerminate();
-    return 0;
+    if (window)
+        glfwTerminate();
+    return exitCode;
 }
 
 void processInput(GLFWwindow *window) {
@@ -545,6 +1131,8 @@ void processInput(GLFWwindow *window) {
 }
 
 void framebuffer_size_callback(GLFWwindow *window, int width, int height) {
+    windowWidth = width;
+    windowHeight = height;
     glViewport(0, 0, width, height);
 }
 
@@ -569,7 +1157,12 @@ void scroll_callback(GLFWwindow *window, double xoffset, double yoffset) {
     programState->camera.ProcessMouseScroll(yoffset);
 }
 
-void DrawImGui(ProgramState *programState) {
+void DrawImGui(ProgramState *programState, const rg::FrameGraph& frameGraph, rg::PostProcessing& postProcessing, rg::Bloom& bloom,
+               rg::AutoExposure& autoExposure, rg::TemporalAA& temporalAA, rg::WeightedBlendedOIT& weightedBlendedOIT,
+               rg::GrassField& grassField, rg::GpuScene& gpuScene, rg::LodSelector& clockLods,
+               rg::Impostor& clockImpostor, rg::NodeAnimator& clockAnimator,
+               const rg::SceneGraph& sceneGraph, rg::SceneGraphBenchmark& sceneGraphBenchmark, rg::CameraTrack& cameraTrack,
+               rg::GpuProfiler& gpuProfiler, rg::PipelineStatistics& pipelineStatistics, rg::FrameStats& frameStats) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
     ImGui::NewFrame();
@@ -600,6 +1193,529 @@ void DrawImGui(ProgramState *programState) {
         ImGui::End();
     }
 
+    {
+        static char trackPath[256] = "resources/camera_track.bin";
+        ImGui::Begin("Camera track");
+        ImGui::InputText("File", trackPath, sizeof(trackPath));
+        if (cameraTrack.IsRecording()) {
+            if (ImGui::Button("Stop recording"))
+                cameraTrack.StopRecording();
+        } else if (cameraTrack.IsPlaying()) {
+            if (ImGui::Button("Stop playback")) {
+                cameraTrack.StopPlayback();
+                lastFrame = glfwGetTime();
+            }
+        } else {
+            if (ImGui::Button("Record"))
+                cameraTrack.StartRecording();
+            ImGui::SameLine();
+            if (ImGui::Button("Play"))
+                cameraTrack.StartPlayback();
+            ImGui::SameLine();
+            if (ImGui::Button("Save"))
+                cameraTrack.Save(trackPath);
+            ImGui::SameLine();
+            if (ImGui::Button("Load"))
+                cameraTrack.Load(trackPath);
+        }
+        ImGui::Text("%d samples, %.2f s from t = %.2f s", cameraTrack.SampleCount(), cameraTrack.Duration(), cameraTrack.StartTime());
+        if (cameraTrack.IsPlaying())
+            ImGui::Text("Playing frame %d of %d at %.4f s per frame", cameraTrack.PlaybackFrame(), cameraTrack.FrameCount(), cameraTrack.TimeStep);
+        ImGui::Text("Capture with --benchmark --track %s", trackPath);
+        ImGui::End();
+    }
+
+    {
+        static std::string graphZone = "frame";
+        ImGui::Begin("GPU profiler");
+        ImGui::Checkbox("Enabled", &gpuProfiler.Enabled);
+        const std::vector<rg::GpuProfiler::Zone>& zones = gpuProfiler.LastFrame();
+        if (!zones.empty()) {
+            // vremenska linija poslednjeg zavrsenog frejma, jedan red po dubini
+            float frameMs = std::max(zones[0].Ms, 0.001f);
+            ImGui::Text("GPU frame: %.3f ms", frameMs);
+            int depth = 0;
+            for (const rg::GpuProfiler::Zone& zone : zones)
+                depth = std::max(depth, zone.Depth);
+            const float rowHeight = 18.0f;
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            float width = std::max(ImGui::GetContentRegionAvail().x, 100.0f);
+            ImDrawList* drawList = ImGui::GetWindowDrawList();
+            ImGui::InvisibleButton("timeline", ImVec2(width, rowHeight * (depth + 1)));
+            ImVec2 mouse = ImGui::GetIO().MousePos;
+            for (const rg::GpuProfiler::Zone& zone : zones) {
+                ImVec2 low(origin.x + zone.StartMs / frameMs * width, origin.y + zone.Depth * rowHeight);
+                ImVec2 high(low.x + std::max(zone.Ms / frameMs * width, 1.0f), low.y + rowHeight - 1.0f);
+                unsigned int hash = (unsigned int) std::hash<std::string>()(zone.Name);
+                drawList->AddRectFilled(low, high, IM_COL32(80 + hash % 150, 80 + (hash >> 8) % 150, 80 + (hash >> 16) % 150, 255));
+                drawList->PushClipRect(low, high, true);
+                drawList->AddText(ImVec2(low.x + 2.0f, low.y + 2.0f), IM_COL32(255, 255, 255, 255), zone.Name.c_str());
+                drawList->PopClipRect();
+                if (ImGui::IsItemHovered() && mouse.x >= low.x && mouse.x < high.x && mouse.y >= low.y && mouse.y < high.y) {
+                    ImGui::SetTooltip("%s: %.3f ms", zone.Name.c_str(), zone.Ms);
+                    if (ImGui::IsMouseClicked(0))
+                        graphZone = zone.Name;
+                }
+            }
+            ImGui::Separator();
+            // uz vreme prolaza i statistike istog frejma, puno temena po fragmentu je prolaz ogranicen temenima
+            bool statistics = rg::PipelineStatistics::IsAvailable() && pipelineStatistics.Enabled;
+            if (ImGui::BeginTable("zones", statistics ? 2 + rg::PipelineStatistics::STATISTIC_COUNT : 2,
+                                  ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("zone");
+                ImGui::TableSetupColumn("ms");
+                for (int statistic = 0; statistics && statistic < rg::PipelineStatistics::STATISTIC_COUNT; statistic++)
+                    ImGui::TableSetupColumn(rg::PipelineStatistics::Name(statistic));
+                ImGui::TableHeadersRow();
+                for (size_t i = 0; i < zones.size(); i++) {
+                    const rg::GpuProfiler::Zone& zone = zones[i];
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%*s%s", 2 * zone.Depth, "", zone.Name.c_str());
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%7.3f", zone.Ms);
+                    const rg::PipelineStatistics::Pass* pass = statistics ? pipelineStatistics.ForZone(gpuProfiler.LastFrameNumber(), (int) i) : nullptr;
+                    for (int statistic = 0; pass && statistic < rg::PipelineStatistics::STATISTIC_COUNT; statistic++) {
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%llu", (unsigned long long) pass->Values[statistic]);
+                    }
+                }
+                ImGui::EndTable();
+            }
+        }
+        if (rg::PipelineStatistics::IsAvailable())
+            ImGui::Checkbox("Pipeline statistics", &pipelineStatistics.Enabled);
+        else
+            ImGui::Text("No pipeline statistics, needs OpenGL 4.6 or GL_ARB_pipeline_statistics_query");
+        ImGui::Separator();
+        // pokretni grafik jedne zone, bira se klikom na vremenskoj liniji
+        std::vector<float> history = gpuProfiler.History(graphZone);
+        float peak = *std::max_element(history.begin(), history.end());
+        std::string label = graphZone + ", peak " + std::to_string(peak).substr(0, 5) + " ms";
+        ImGui::PlotLines("##history", history.data(), (int) history.size(), 0, label.c_str(), 0.0f, std::max(peak, 0.1f) * 1.1f,
+                         ImVec2(0.0f, 80.0f));
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Frame stats");
+        // pokretni prozori u frejmovima, poslednji je ceo prsten
+        static const int windows[] = {120, 1000, (int) rg::FrameStats::RING_SIZE};
+        static int statsWindow = 0;
+        ImGui::Combo("Window", &statsWindow, "120 frames\0" "1000 frames\0" "4096 frames\0");
+        int frames = windows[statsWindow];
+        struct Row {
+            const char* Name;
+            float rg::FrameStats::Sample::*Field;
+        };
+        const Row rows[] = {{"frame", &rg::FrameStats::Sample::FrameMs}, {"CPU", &rg::FrameStats::Sample::CpuMs},
+                            {"GPU", &rg::FrameStats::Sample::GpuMs}};
+        if (ImGui::BeginTable("frame percentiles", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            for (const char* header : {"ms", "p50", "p95", "p99", "max"})
+                ImGui::TableSetupColumn(header);
+            ImGui::TableHeadersRow();
+            for (const Row& row : rows) {
+                rg::FrameStats::Summary summary = frameStats.Summarize(frames, row.Field);
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", row.Name);
+                for (float value : {summary.P50, summary.P95, summary.P99, summary.Max}) {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", value);
+                }
+            }
+            ImGui::EndTable();
+        }
+        // raspodela, do 1.5 x p99 da repovi ne stisnu ostatak; duzi frejmovi su u poslednjoj koloni
+        const int BINS = 48;
+        static int histogramRow = 0;
+        ImGui::Combo("Histogram", &histogramRow, "frame\0CPU\0GPU\0");
+        rg::FrameStats::Summary summary = frameStats.Summarize(frames, rows[histogramRow].Field);
+        float maxMs = std::max(summary.P99 * 1.5f, 1.0f);
+        std::vector<float> histogram = frameStats.Histogram(frames, rows[histogramRow].Field, BINS, maxMs);
+        float peak = *std::max_element(histogram.begin(), histogram.end());
+        std::string label = "0 - " + std::to_string(maxMs).substr(0, 5) + " ms";
+        ImGui::PlotHistogram("##frame histogram", histogram.data(), BINS, 0, label.c_str(), 0.0f, std::max(peak, 1.0f),
+                             ImVec2(0.0f, 80.0f));
+        ImGui::Separator();
+        ImGui::DragFloat("Hitch x median", &frameStats.HitchFactor, 0.05f, 1.1f, 10.0f);
+        ImGui::DragInt("Median of frames", &frameStats.HitchWindow, 1.0f, 10, (int) rg::FrameStats::RING_SIZE);
+        ImGui::Checkbox("Log hitches", &frameStats.LogHitches);
+        ImGui::Text("Hitches: %d", frameStats.HitchCount());
+        const std::vector<rg::FrameStats::Hitch>& hitches = frameStats.Hitches();
+        if (!hitches.empty() && ImGui::BeginTable("hitches", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            for (const char* header : {"frame", "ms", "x median", "GPU ms", rg::DrawCounter::Name(rg::DrawCounter::DRAW_CALLS)})
+                ImGui::TableSetupColumn(header);
+            ImGui::TableHeadersRow();
+            // najnoviji prvi
+            for (auto hitch = hitches.rbegin(); hitch != hitches.rend(); ++hitch) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%llu", (unsigned long long) hitch->Frame);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", hitch->Times.FrameMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f", hitch->Times.FrameMs / hitch->MedianMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", hitch->Times.GpuMs);
+                ImGui::TableNextColumn();
+                ImGui::Text("%u", hitch->Counters.Values[rg::DrawCounter::DRAW_CALLS]);
+            }
+            ImGui::EndTable();
+        }
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("CPU profiler");
+#ifdef RG_CPU_PROFILER
+        ImGui::Checkbox("Record zones", &rg::CpuProfiler::Enabled);
+        if (ImGui::Button("Write Chrome trace"))
+            rg::CpuProfiler::WriteChromeTrace("cpu_trace.json");
+        ImGui::Text("Startup and the last %d zones per thread, open in ui.perfetto.dev", (int) rg::CpuProfiler::RING_SIZE);
+#else
+        ImGui::Text("Built without RG_CPU_PROFILER");
+#endif
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Draw counters");
+        const rg::DrawCounter::Counters& frame = rg::DrawCounter::LastFrame();
+        unsigned int over = rg::DrawCounter::OverBudget(frame);
+        ImGui::Text("Budget, 0 is none");
+        for (int counter = 0; counter < rg::DrawCounter::COUNTER_COUNT; counter++) {
+            int budget = (int) rg::DrawCounter::Budget.Values[counter];
+            if (ImGui::DragInt(rg::DrawCounter::Name(counter), &budget, 10.0f, 0, INT_MAX))
+                rg::DrawCounter::Budget.Values[counter] = (unsigned int) std::max(0, budget);
+        }
+        ImGui::Text("Frames over budget: %d", rg::DrawCounter::OverBudgetFrames());
+        auto table = [&](const char* id, const char* label, const std::map<std::string, rg::DrawCounter::Counters>& rows) {
+            if (!ImGui::BeginTable(id, rg::DrawCounter::COUNTER_COUNT + 1, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+                return;
+            ImGui::TableSetupColumn(label);
+            for (int counter = 0; counter < rg::DrawCounter::COUNTER_COUNT; counter++)
+                ImGui::TableSetupColumn(rg::DrawCounter::Name(counter));
+            ImGui::TableHeadersRow();
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Text("frame");
+            for (int counter = 0; counter < rg::DrawCounter::COUNTER_COUNT; counter++) {
+                ImGui::TableNextColumn();
+                if (over & (1u << counter))
+                    ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%u", frame.Values[counter]);
+                else
+                    ImGui::Text("%u", frame.Values[counter]);
+            }
+            for (const auto& row : rows) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", row.first.c_str());
+                for (unsigned int value : row.second.Values) {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%u", value);
+                }
+            }
+            ImGui::EndTable();
+        };
+        table("draw counter passes", "pass", rg::DrawCounter::LastPasses());
+        table("draw counter models", "model", rg::DrawCounter::LastModels());
+        ImGui::End();
+    }
+
+    {
+        static int largestCount = 10;
+        ImGui::Begin("Memory");
+        const float MB = 1024.0f * 1024.0f;
+        rg::MemoryTracker::Usage total = rg::MemoryTracker::Total();
+        ImGui::Text("GPU: %.1f MB (peak %.1f MB)", total.GpuBytes() / MB, rg::MemoryTracker::PeakGpuBytes() / MB);
+        ImGui::Text("  buffers %.1f MB, textures %.1f MB, renderbuffers %.1f MB", total.Bytes[rg::MemoryTracker::BUFFER] / MB,
+                    total.Bytes[rg::MemoryTracker::TEXTURE] / MB, total.Bytes[rg::MemoryTracker::RENDERBUFFER] / MB);
+        ImGui::Text("CPU copies: %.1f MB", total.CpuBytes / MB);
+        if (ImGui::CollapsingHeader("By owner", ImGuiTreeNodeFlags_DefaultOpen)
+            && ImGui::BeginTable("memory owners", 5, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+            ImGui::TableSetupColumn("owner");
+            ImGui::TableSetupColumn("buffers MB");
+            ImGui::TableSetupColumn("textures MB");
+            ImGui::TableSetupColumn("renderbuffers MB");
+            ImGui::TableSetupColumn("CPU MB");
+            ImGui::TableHeadersRow();
+            std::map<std::string, rg::MemoryTracker::Usage> tags = rg::MemoryTracker::ByTag();
+            std::vector<std::pair<std::string, rg::MemoryTracker::Usage>> owners(tags.begin(), tags.end());
+            std::sort(owners.begin(), owners.end(), [](const std::pair<std::string, rg::MemoryTracker::Usage>& a,
+                                                       const std::pair<std::string, rg::MemoryTracker::Usage>& b) {
+                return a.second.GpuBytes() + a.second.CpuBytes > b.second.GpuBytes() + b.second.CpuBytes;
+            });
+            for (const auto& owner : owners) {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", owner.first.c_str());
+                for (size_t bytes : owner.second.Bytes) {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", bytes / MB);
+                }
+                ImGui::TableNextColumn();
+                ImGui::Text("%.2f", owner.second.CpuBytes / MB);
+            }
+            ImGui::EndTable();
+        }
+        if (ImGui::CollapsingHeader("Largest resources")) {
+            ImGui::SliderInt("Count", &largestCount, 1, 50);
+            for (const rg::MemoryTracker::Resource& resource : rg::MemoryTracker::Largest(largestCount)) {
+                if (resource.Type == rg::MemoryTracker::BUFFER)
+                    ImGui::Text("%8.2f MB  %s %u (%s)", resource.Bytes / MB, rg::MemoryTracker::Name(resource.Type), resource.Id, resource.Tag.c_str());
+                else
+                    ImGui::Text("%8.2f MB  %s %u %dx%d (%s)", resource.Bytes / MB, rg::MemoryTracker::Name(resource.Type), resource.Id,
+                                resource.Width, resource.Height, resource.Tag.c_str());
+            }
+        }
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("GL debug output");
+        if (!rg::DebugOutput::IsAvailable()) {
+            ImGui::Text("Needs OpenGL 4.3, GL_KHR_debug or GL_ARB_debug_output");
+        } else {
+            bool enabled = rg::DebugOutput::IsEnabled();
+            if (ImGui::Checkbox("Enabled", &enabled)) {
+                if (enabled)
+                    rg::DebugOutput::Enable(false);
+                else
+                    rg::DebugOutput::Disable();
+            }
+            bool synchronous = rg::DebugOutput::IsSynchronous();
+            if (ImGui::Checkbox("Synchronous", &synchronous))
+                rg::DebugOutput::SetSynchronous(synchronous);
+            ImGui::SameLine();
+            ImGui::Checkbox("Break on error", &rg::DebugOutput::BreakOnError);
+            ImGui::Text("%s context, %s", rg::DebugOutput::IsDebugContext() ? "Debug" : "Not a debug", RG_GLCALL_MODE);
+            const GLenum severities[] = {GL_DEBUG_SEVERITY_HIGH, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_LOW, GL_DEBUG_SEVERITY_NOTIFICATION};
+            int severity = 0;
+            while (severity < 3 && severities[severity] != rg::DebugOutput::MinSeverity)
+                severity++;
+            if (ImGui::Combo("Minimum severity", &severity, "High\0Medium\0Low\0Notification\0"))
+                rg::DebugOutput::SetMinSeverity(severities[severity]);
+            std::vector<rg::DebugOutput::Message> messages = rg::DebugOutput::Messages();
+            ImGui::Text("%d messages, %d distinct", rg::DebugOutput::TotalCount(), (int) messages.size());
+            ImGui::SameLine();
+            if (ImGui::Button("Clear"))
+                rg::DebugOutput::Clear();
+            // newest first, ignoring an id drops it from now on
+            for (int i = (int) messages.size() - 1; i >= 0; i--) {
+                const rg::DebugOutput::Message& message = messages[i];
+                ImGui::PushID(i);
+                if (ImGui::SmallButton("Ignore"))
+                    rg::DebugOutput::Ignore(message.Id);
+                ImGui::SameLine();
+                ImVec4 color = message.Type == GL_DEBUG_TYPE_ERROR ? ImVec4(1.0f, 0.3f, 0.3f, 1.0f)
+                               : message.Severity == GL_DEBUG_SEVERITY_HIGH || message.Severity == GL_DEBUG_SEVERITY_MEDIUM
+                               ? ImVec4(1.0f, 0.8f, 0.3f, 1.0f) : ImVec4(0.8f, 0.8f, 0.8f, 1.0f);
+                ImGui::TextColored(color, "x%d %s %s %u: %s", message.Count, rg::DebugOutput::SeverityName(message.Severity),
+                                   rg::DebugOutput::TypeName(message.Type), message.Id, message.Text.c_str());
+                if (!message.CallSite.empty())
+                    ImGui::TextDisabled("    at %s", message.CallSite.c_str());
+                ImGui::PopID();
+            }
+            std::set<GLuint> ignored = rg::DebugOutput::IgnoredIds();
+            if (!ignored.empty() && ImGui::CollapsingHeader("Ignored ids")) {
+                for (GLuint id : ignored) {
+                    ImGui::PushID((int) id);
+                    ImGui::Text("%u", id);
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("Restore"))
+                        rg::DebugOutput::Ignore(id, false);
+                    ImGui::PopID();
+                }
+            }
+        }
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Dynamic resolution");
+        rg::DynamicResolution& dr = programState->dynamicResolution;
+        ImGui::Checkbox("Enabled", &dr.Enabled);
+        ImGui::Text("Scale: %.2f (%ux%u)", dr.Scale, dr.ScaledSize(SCR_WIDTH), dr.ScaledSize(SCR_HEIGHT));
+        ImGui::Text("GPU frame time: %.2f ms", dr.FilteredMs());
+        ImGui::DragFloat("Budget (ms)", &dr.TargetMs, 0.1, 1.0, 100.0);
+        ImGui::DragFloat("Min scale", &dr.MinScale, 0.01, 0.25, dr.MaxScale);
+        ImGui::DragFloat("Max scale", &dr.MaxScale, 0.01, dr.MinScale, 1.0);
+        ImGui::DragFloat("Kp", &dr.Kp, 0.01, 0.0, 2.0);
+        ImGui::DragFloat("Ki", &dr.Ki, 0.01, 0.0, 2.0);
+        ImGui::DragFloat("Kd", &dr.Kd, 0.0005, 0.0, 0.1);
+        ImGui::DragFloat("Log interval (s)", &dr.LogInterval, 0.1, 0.0, 10.0);
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Frame graph");
+        ImGui::Checkbox("Weighted blended OIT for grass", &weightedBlendedOIT.Enabled);
+        const rg::FrameGraph::Stats& stats = frameGraph.GetStats();
+        ImGui::Text("Transient textures: %d (%.1f MB without aliasing)", stats.TransientTextures, stats.TransientBytes / (1024.0 * 1024.0));
+        ImGui::Text("Pooled textures: %d (%.1f MB)", stats.PooledTextures, stats.PooledBytes / (1024.0 * 1024.0));
+        ImGui::Separator();
+        for (const std::string& pass : stats.ExecutedPasses)
+            ImGui::BulletText("%s", pass.c_str());
+        for (const std::string& pass : stats.CulledPasses)
+            ImGui::BulletText("%s (culled)", pass.c_str());
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Debug view");
+        int mode = rg::DebugView::Current;
+        ImGui::Combo("View", &mode, "Scene\0Overdraw\0Shader cost\0Mesh index\0");
+        rg::DebugView::Current = (rg::DebugView::Mode) mode;
+        if (rg::DebugView::Current == rg::DebugView::OVERDRAW)
+            ImGui::DragFloat("Layers at red", &rg::DebugView::OverdrawScale, 0.1f, 1.0f, 64.0f);
+        else if (rg::DebugView::Current == rg::DebugView::SHADER_COST)
+            ImGui::DragFloat("Instructions at red", &rg::DebugView::ShaderCostScale, 5.0f, 10.0f, 10000.0f);
+        if (rg::DebugView::IsActive())
+            ImGui::Text("Post-processing, TAA and OIT are off while a view is shown");
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Post-processing");
+        if (!postProcessing.IsAvailable()) {
+            ImGui::Text("Compute shaders need GL 4.3, using framebuffer.fs");
+        } else {
+            ImGui::Checkbox("Compute path", &postProcessing.Enabled);
+            ImGui::Checkbox("Fuse effects", &postProcessing.Fused);
+            ImGui::Checkbox("Fog", &postProcessing.FogEnabled);
+            int kernel = postProcessing.KernelType;
+            ImGui::Combo("Kernel (H)", &kernel, "Edge\0Gaussian\0");
+            postProcessing.KernelType = (rg::PostProcessing::Kernel) kernel;
+            ImGui::Checkbox("Auto exposure", &autoExposure.Enabled);
+            if (autoExposure.Enabled) {
+                ImGui::DragFloat("Key value", &autoExposure.KeyValue, 0.01, 0.01, 1.0);
+                ImGui::DragFloat("Adaptation speed", &autoExposure.AdaptationSpeed, 0.05, 0.0, 10.0);
+                ImGui::DragFloatRange2("Log2 luminance", &autoExposure.MinLogLuminance, &autoExposure.MaxLogLuminance, 0.1, -16.0, 16.0);
+                ImGui::DragFloatRange2("Exposure range", &autoExposure.MinExposure, &autoExposure.MaxExposure, 0.01, 0.001, 100.0);
+                ImGui::Text("histogram + adaptation: %.3f ms", autoExposure.LastMs());
+            } else {
+                ImGui::DragFloat("Exposure", &postProcessing.Exposure, 0.01, 0.01, 10.0);
+            }
+            ImGui::DragFloat("Fog density", &postProcessing.FogDensity, 0.001, 0.0, 1.0);
+            ImGui::ColorEdit3("Fog color", (float*) &postProcessing.FogColor);
+            ImGui::Separator();
+            // timings of the effects the last frame used (hold K, add H for the kernel)
+            int effects = postProcessing.ActiveEffects();
+            if (postProcessing.Fused) {
+                ImGui::Text("fused: %.3f ms", postProcessing.StageMs(effects));
+            } else {
+                for (int effect = rg::PostProcessing::EFFECT_KERNEL; effect <= rg::PostProcessing::EFFECT_GAMMA; effect <<= 1)
+                    if (effects & effect)
+                        ImGui::Text("%s: %.3f ms", rg::PostProcessing::EffectName(effect), postProcessing.StageMs(effect));
+            }
+        }
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Temporal AA");
+        ImGui::Checkbox("Enabled", &temporalAA.Enabled);
+        ImGui::Checkbox("Upscale", &temporalAA.Upscale);
+        ImGui::DragFloat("Internal scale", &temporalAA.InternalScale, 0.01, 0.25, 1.0);
+        ImGui::DragFloat("Blend factor", &temporalAA.BlendFactor, 0.005, 0.01, 1.0);
+        ImGui::Text("Jitter: (%.2f, %.2f)", temporalAA.Jitter().x, temporalAA.Jitter().y);
+        ImGui::Text("Resolve: %.3f ms", temporalAA.LastMs());
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Bloom");
+        ImGui::Checkbox("Enabled", &bloom.Enabled);
+        ImGui::DragFloat("Strength", &bloom.Strength, 0.005, 0.0, 1.0);
+        ImGui::DragFloat("Filter radius", &bloom.FilterRadius, 0.0005, 0.0, 0.05);
+        ImGui::SliderInt("Levels", &bloom.Levels, 1, rg::Bloom::MAX_LEVELS);
+        ImGui::Text("GPU time: %.3f ms", bloom.LastMs());
+        ImGui::Text("Pixels: %.1f%% of a full-screen pass", 100.0f * bloom.PixelFraction(SCR_WIDTH, SCR_HEIGHT));
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Grass field");
+        ImGui::Checkbox("Enabled", &grassField.Enabled);
+        if (grassField.IsGpuCullingAvailable())
+            ImGui::Checkbox("GPU culling", &grassField.GpuCulling);
+        else
+            ImGui::Text("GPU culling needs OpenGL 4.3, culling on the CPU");
+        ImGui::DragInt("Instances", &grassField.InstanceCount, 1000, 0, 1000000);
+        ImGui::DragFloat("Field size", &grassField.Size, 1.0, 1.0, 1000.0);
+        ImGui::DragFloat("Blade height", &grassField.BladeHeight, 0.05, 0.05, 10.0);
+        ImGui::DragFloat("LOD distance", &grassField.LodDistance, 0.5, 0.0, 500.0);
+        ImGui::DragFloat("Max distance", &grassField.MaxDistance, 0.5, 0.0, 1000.0);
+        ImGui::Text("GPU time: %.3f ms", grassField.LastMs());
+        if (grassField.VisibleCount(0) >= 0) {
+            ImGui::Text("Visible: %d near, %d far", grassField.VisibleCount(0), grassField.VisibleCount(1));
+            ImGui::Text("CPU culling: %.3f ms", grassField.CpuCullMs());
+        }
+        if (grassField.IsBenchmarkRunning())
+            ImGui::Text("Benchmark %s", grassField.BenchmarkStatus().c_str());
+        else if (ImGui::Button("Run benchmark"))
+            grassField.StartBenchmark("grass_benchmark.csv");
+        else if (!grassField.BenchmarkStatus().empty())
+            ImGui::Text("Benchmark %s", grassField.BenchmarkStatus().c_str());
+        ImGui::End();
+    }
+
+    if (gpuScene.IsAvailable()) {
+        ImGui::Begin("GPU scene");
+        ImGui::Checkbox("Enabled", &gpuScene.Enabled);
+        ImGui::Checkbox("Frustum culling", &gpuScene.FrustumCulling);
+        ImGui::Checkbox("Cone culling", &gpuScene.ConeCulling);
+        ImGui::Checkbox("Cull on the CPU", &gpuScene.CullOnCpu);
+        ImGui::Text("Meshlets: %d in %d multi-draws", gpuScene.ObjectCount(), gpuScene.GroupCount());
+        const rg::GpuScene::CullStats& stats = gpuScene.Stats();
+        float triangles = (float) std::max(1u, gpuScene.TriangleCount());
+        ImGui::Text("Visible: %u meshlets, %u of %u triangles", stats.VisibleMeshlets, stats.VisibleTriangles, gpuScene.TriangleCount());
+        ImGui::Text("Rejected: %.1f%% frustum, %.1f%% cone", 100.0f * stats.FrustumRejectedTriangles / triangles,
+                    100.0f * stats.ConeRejectedTriangles / triangles);
+        ImGui::Text("Draw counts from the GPU: %s", rg::GLExt::IndirectCount ? "yes" : "no");
+        ImGui::Text("CPU submit: %.3f ms", gpuScene.SubmitMs());
+        ImGui::Text("GPU time: %.3f ms", gpuScene.LastMs());
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Clocks");
+        ImGui::Checkbox("Procedural motion in clock.vs", &programState->ProceduralClocks);
+        ImGui::DragInt("Procedural clocks", &programState->ProceduralClockCount, 10, 1, 1000000);
+        if (programState->ProceduralClocks) {
+            ImGui::Text("Every clock at LOD 0, levels and impostors are off");
+            ImGui::Checkbox("Animated hands (Clock_fbx.fbx)", &programState->AnimatedClocks);
+            if (!clockAnimator.HasAnimation())
+                ImGui::Text("Clock_fbx.fbx has no animation, showing the rest pose");
+            else if (programState->AnimatedClocks)
+                ImGui::Text("%d nodes x %d phases, CPU %.3f ms", clockAnimator.NodeCount(), clockAnimator.Phases(), clockAnimator.UpdateMs());
+        }
+        ImGui::Checkbox("LOD enabled", &clockLods.Enabled);
+        ImGui::DragFloat("Max pixel error", &clockLods.MaxPixelError, 0.05, 0.1, 20.0);
+        ImGui::DragFloat("Fade seconds", &clockLods.FadeSeconds, 0.01, 0.0, 2.0);
+        ImGui::DragFloat("Impostor below pixels", &clockLods.ImpostorPixels, 1.0, 0.0, 512.0);
+        std::vector<int> histogram = clockLods.Histogram();
+        for (int lod = 0; lod < clockLods.LodCount(); lod++)
+            ImGui::Text("LOD %d: %d clocks", lod, histogram[lod]);
+        ImGui::Text("Impostors: %d clocks, %.3f ms", histogram[clockLods.ImpostorLevel()], clockImpostor.LastMs());
+        float saved = clockLods.FullTriangles() > 0 ? 1.0f - (float) clockLods.DrawnTriangles() / clockLods.FullTriangles() : 0.0f;
+        ImGui::Text("Triangles: %u of %u, %.1f%% saved", clockLods.DrawnTriangles(), clockLods.FullTriangles(), 100.0f * saved);
+        ImGui::End();
+    }
+
+    {
+        ImGui::Begin("Scene graph");
+        ImGui::Text("Nodes: %d, updated last frame: %d", sceneGraph.NodeCount(), sceneGraph.LastUpdatedCount());
+        ImGui::Text("Transform update: %.4f ms", sceneGraph.LastUpdateMs());
+        if (ImGui::Button("Benchmark 100k nodes"))
+            sceneGraphBenchmark = rg::benchmarkSceneGraph(100000);
+        if (sceneGraphBenchmark.Nodes > 0)
+            ImGui::Text("%d nodes: all moved %.3f ms, 1%% of leaves %.3f ms, static %.4f ms", sceneGraphBenchmark.Nodes,
+                        sceneGraphBenchmark.FullMs, sceneGraphBenchmark.PartialMs, sceneGraphBenchmark.StaticMs);
+        ImGui::End();
+    }
+
     ImGui::Render();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 }